@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <limits>
 #include <cmath>
+#include <chrono>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -116,6 +117,7 @@ namespace
     int  insitu_on_restart;
     int  checkpoint_on_restart;
     bool checkpoint_files_output;
+    bool checkpoint_async;
     int  compute_new_dt_on_regrid;
     bool precreateDirectories;
     bool prereadFAHeaders;
@@ -151,6 +153,7 @@ Amr::Initialize ()
     insitu_on_restart        = 0;
     checkpoint_on_restart    = 0;
     checkpoint_files_output  = true;
+    checkpoint_async         = false;
     compute_new_dt_on_regrid = 0;
     precreateDirectories     = true;
     prereadFAHeaders         = true;
@@ -518,6 +521,12 @@ Amr::InitAmr ()
 
     loadbalance_max_fac = 1.5;
     pp.query("loadbalance_max_fac", loadbalance_max_fac);
+
+    loadbalance_incremental = 0;
+    pp.query("loadbalance_incremental", loadbalance_incremental);
+
+    loadbalance_imbalance_tol = 0.1;
+    pp.query("loadbalance_imbalance_tol", loadbalance_imbalance_tol);
 }
 
 int
@@ -759,6 +768,9 @@ Amr::deleteDeriveSmallPlotVar (const std::string& name)
 
 Amr::~Amr ()
 {
+    // ---- the explicit fence is waitForAsyncCheckPoint; this one does not abort
+    finishAsyncCheckPoint(false);
+
     levelbld->variableCleanUp();
 
     Amr::Finalize();
@@ -1765,6 +1777,10 @@ Amr::checkPoint ()
     BL_PROFILE_REGION_START("Amr::checkPoint()");
     BL_PROFILE("Amr::checkPoint()");
 
+    waitForAsyncCheckPoint();
+
+    StateData::SetAsyncCheckPoint(checkpoint_async);
+
     VisMF::SetNOutFiles(checkpoint_nfiles);
     //
     // In checkpoint files always write out FABs in NATIVE format.
@@ -1796,6 +1812,15 @@ Amr::checkPoint ()
 
   while(sretry.TryFileOutput()) {
 
+    //
+    //  the writes of a failed asynchronous try must finish before
+    //  its directory is cleaned out.
+    //
+    if ( ! async_ckfile.empty()) {
+        drainAsyncCheckPointWrites();
+        async_ckfile.clear();
+    }
+
     StateData::ClearFabArrayHeaderNames();
 
     //
@@ -1915,15 +1940,26 @@ Amr::checkPoint ()
 
 	amrex::Print() << "checkPoint() time = " << dCheckPointTime << " secs." << '\n';
     }
-    ParallelDescriptor::Barrier("Amr::checkPoint::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(ckfileTemp.c_str(), ckfile.c_str());
+    if (checkpoint_async) {
+      //
+      // The data are still being written.  The directory is renamed
+      // in waitForAsyncCheckPoint.
+      //
+      async_ckfile = ckfile;
+    } else {
+      ParallelDescriptor::Barrier("Amr::checkPoint::end");
+
+      if(ParallelDescriptor::IOProcessor()) {
+        std::rename(ckfileTemp.c_str(), ckfile.c_str());
+      }
+      ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
 
   }  // end while
 
+  StateData::SetAsyncCheckPoint(false);
+
   //
   // Restore the previous FAB format.
   //
@@ -1934,6 +1970,90 @@ Amr::checkPoint ()
   BL_PROFILE_REGION_STOP("Amr::checkPoint()");
 }
 
+void
+Amr::waitForAsyncCheckPoint ()
+{
+    finishAsyncCheckPoint(abort_on_stream_retry_failure);
+}
+
+bool
+Amr::drainAsyncCheckPointWrites (long* nbytes)
+{
+    bool success = true;
+    auto& writes = StateData::AsyncCheckPointWrites();
+    for (auto& w : writes) {
+        const WriteAsyncStatus status = w.get();
+        if (nbytes) *nbytes += status.nbytes;
+        success = success && status.success;
+    }
+    writes.clear();
+    return success;
+}
+
+void
+Amr::finishAsyncCheckPoint (bool abort_on_failure)
+{
+    if (async_ckfile.empty()) {
+        return;
+    }
+
+    BL_PROFILE("Amr::waitForAsyncCheckPoint()");
+
+    Real dWaitTime0 = amrex::second();
+
+    long nbytes = 0;
+    bool success = drainAsyncCheckPointWrites(&nbytes);
+
+    // ---- this also waits for the writes on all processes
+    ParallelDescriptor::ReduceBoolAnd(success);
+
+    const std::string ckfileTemp(async_ckfile + ".temp");
+    if (!success) {
+        // ---- leave the .temp directory so it is not mistaken for a complete checkpoint
+        if (abort_on_failure) {
+            amrex::Abort("Amr::waitForAsyncCheckPoint: writing " + ckfileTemp + " failed");
+        }
+        amrex::Print() << "WARNING: CHECKPOINT: writing " << ckfileTemp
+                       << " failed, it is not renamed to " << async_ckfile << '\n';
+        async_ckfile.clear();
+        return;
+    }
+
+    if(ParallelDescriptor::IOProcessor()) {
+        std::rename(ckfileTemp.c_str(), async_ckfile.c_str());
+    }
+    ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
+
+    if (verbose > 0)
+    {
+        Real dWaitTime = amrex::second() - dWaitTime0;
+
+        ParallelDescriptor::ReduceRealMax(dWaitTime, ParallelDescriptor::IOProcessorNumber());
+        ParallelDescriptor::ReduceLongSum(nbytes, ParallelDescriptor::IOProcessorNumber());
+
+        amrex::Print() << "CHECKPOINT: file = " << async_ckfile << " completed, "
+                       << nbytes << " bytes, wait time = " << dWaitTime << " secs." << '\n';
+    }
+
+    async_ckfile.clear();
+}
+
+Real
+Amr::asyncCheckPointProgress () const
+{
+    const auto& writes = StateData::AsyncCheckPointWrites();
+    if (writes.empty()) {
+        return 1.0;
+    }
+    int ndone = 0;
+    for (const auto& w : writes) {
+        if (w.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            ++ndone;
+        }
+    }
+    return static_cast<Real>(ndone) / static_cast<Real>(writes.size());
+}
+
 void
 Amr::RegridOnly (Real time, bool do_io)
 {
@@ -3061,10 +3181,32 @@ Amr::makeLoadBalanceDistributionMap (int lev, Real time, const BoxArray& ba) con
         MultiFab workest(ba, dmtmp, 1, 0, MFInfo(), FArrayBoxFactory());
         AmrLevel::FillPatch(*amr_level[lev], workest, 0, time, work_est_type, 0, 1, 0);
 
-        Real navg = static_cast<Real>(ba.size()) / static_cast<Real>(ParallelDescriptor::NProcs());
-        int nmax = std::max(std::round(loadbalance_max_fac*navg), std::ceil(navg));
+        if (loadbalance_incremental && ba == boxArray(lev))
+        {
+            // Only move the boxes needed to get within the tolerance,
+            // counting the bytes of the new state data that move with them.
+            long bytes_per_cell = 0;
+            const DescriptorList& desc_lst = amr_level[lev]->get_desc_lst();
+            for (int k = 0; k < desc_lst.size(); ++k) {
+                bytes_per_cell += desc_lst[k].nComp() * sizeof(Real);
+            }
+
+            DistributionMapping::RebalanceInfo info;
+            newdm = DistributionMapping::makeIncremental(dmtmp, workest, loadbalance_imbalance_tol,
+                                                         bytes_per_cell, &info);
+            if (verbose) {
+                amrex::Print() << "  Incremental load balance moves " << info.nmoved
+                               << " boxes, " << info.bytes_moved << " bytes, imbalance "
+                               << info.imbalance_before << " -> " << info.imbalance_after << "\n";
+            }
+        }
+        else
+        {
+            Real navg = static_cast<Real>(ba.size()) / static_cast<Real>(ParallelDescriptor::NProcs());
+            int nmax = std::max(std::round(loadbalance_max_fac*navg), std::ceil(navg));
 
-        newdm = DistributionMapping::makeKnapSack(workest, nmax);
+            newdm = DistributionMapping::makeKnapSack(workest, nmax);
+        }
     }
     else
     {
@@ -3079,6 +3221,9 @@ Amr::LoadBalanceLevel0 (Real time)
 {
     BL_PROFILE("LoadBalanceLevel0()");
     const auto& dm = makeLoadBalanceDistributionMap(0, time, boxArray(0));
+    if (DistributionMapping::SameRefs(dm, DistributionMap(0))) {
+        return;  // the incremental load balance found nothing to move
+    }
     InstallNewDistributionMap(0, dm);
     amr_level[0]->post_regrid(0,0,time);
 }
@@ -3492,6 +3637,7 @@ Amr::initPltAndChk ()
     ParmParse pp("amr");
 
     pp.query("checkpoint_files_output", checkpoint_files_output);
+    pp.query("checkpoint_async", checkpoint_async);
     pp.query("plot_files_output", plot_files_output);
 
     pp.query("plot_nfiles", plot_nfiles);
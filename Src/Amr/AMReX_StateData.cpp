@@ -23,6 +23,8 @@ static constexpr int MFOLDDATA = 1;
 
 Vector<std::string> StateData::fabArrayHeaderNames;
 std::map<std::string, Vector<char> > *StateData::faHeaderMap;
+bool StateData::asyncCheckPoint = false;
+Vector<std::future<WriteAsyncStatus> > StateData::asyncCheckPointWrites;
 
 
 StateData::StateData () 
@@ -829,13 +831,21 @@ StateData::checkPoint (const std::string& name,
     {
        BL_ASSERT(new_data);
        std::string mf_fullpath_new(fullpathname + NewSuffix);
-       VisMF::Write(*new_data,mf_fullpath_new,how);
+       if (asyncCheckPoint) {
+           asyncCheckPointWrites.push_back(VisMF::WriteAsync(*new_data,mf_fullpath_new));
+       } else {
+           VisMF::Write(*new_data,mf_fullpath_new,how);
+       }
 
        if (dump_old)
        {
            BL_ASSERT(old_data);
            std::string mf_fullpath_old(fullpathname + OldSuffix);
-           VisMF::Write(*old_data,mf_fullpath_old,how);
+           if (asyncCheckPoint) {
+               asyncCheckPointWrites.push_back(VisMF::WriteAsync(*old_data,mf_fullpath_old));
+           } else {
+               VisMF::Write(*old_data,mf_fullpath_old,how);
+           }
        }
     }
 }
@@ -76,6 +76,7 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     use_new_chop         = false;
     iterate_on_new_grids = true;
+    use_distributed_clustering = false;
 
     ParmParse pp("amr");
 
@@ -113,6 +114,7 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     pp.query("n_proper",n_proper);
     pp.query("grid_eff",grid_eff);
+    pp.query("use_distributed_clustering",use_distributed_clustering);
     int cnt = pp.countval("n_error_buf");
     if (cnt > 0) {
         Vector<int> neb;
@@ -695,41 +697,92 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
         // Remove cells outside proper nesting domain for this level.
         //
         tags.setVal(p_n_comp[levc],TagBox::CLEAR);
-        //
-        // Create initial cluster containing all tagged points.
-        //
-	Vector<IntVect> tagvec;
-	tags.collate(tagvec);
-        tags.clear();
-
-        if (tagvec.size() > 0)
+        BoxList new_bx;
+        bool has_tags;
+        if (use_distributed_clustering)
         {
             //
-            // Created new level, now generate efficient grids.
+            // Each process clusters only its own tags.  The resulting
+            // boxes, rather than the tags, are then gathered and merged.
+            // Because every local cluster satisfies grid_eff with respect
+            // to the local tags, so does their union.
             //
-            if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
-                new_finest = std::max(new_finest,levf);
-	    }
+            Vector<IntVect> tagvec;
+            tags.local_collate(tagvec);
+            tags.clear();
+
+            Vector<Box> local_bx;
+            if (tagvec.size() > 0)
+            {
+                ClusterList clist(&tagvec[0], tagvec.size());
+                if (use_new_chop)
+                {
+                    clist.new_chop(grid_eff);
+                } else {
+                    clist.chop(grid_eff);
+                }
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+
+                BoxList bl;
+                clist.boxList(bl);
+                local_bx = std::move(bl.data());
+            }
+
+            amrex::AllGatherBoxes(local_bx);
+
+            has_tags = !local_bx.empty();
+            if (has_tags)
+            {
+                new_bx = amrex::removeOverlap(BoxList(std::move(local_bx)));
+                new_bx.simplify();
+            }
+        }
+        else
+        {
             //
-            // Construct initial cluster.
+            // Create initial cluster containing all tagged points.
             //
-            ClusterList clist(&tagvec[0], tagvec.size());
-            if (use_new_chop)
+            Vector<IntVect> tagvec;
+            tags.collate(tagvec);
+            tags.clear();
+
+            has_tags = tagvec.size() > 0;
+            if (has_tags)
             {
-               clist.new_chop(grid_eff);
-            } else {
-               clist.chop(grid_eff);
+                //
+                // Construct initial cluster.
+                //
+                ClusterList clist(&tagvec[0], tagvec.size());
+                if (use_new_chop)
+                {
+                   clist.new_chop(grid_eff);
+                } else {
+                   clist.chop(grid_eff);
+                }
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                //
+                // Efficient properly nested Clusters have been constructed
+                // now generate list of grids at level levf.
+                //
+                clist.boxList(new_bx);
             }
-            BoxDomain bd;
-            bd.add(p_n[levc]);
-            clist.intersect(bd);
-            bd.clear();
+        }
+
+        if (has_tags)
+        {
             //
-            // Efficient properly nested Clusters have been constructed
-            // now generate list of grids at level levf.
+            // Created new level, now generate efficient grids.
             //
-            BoxList new_bx;
-            clist.boxList(new_bx);
+            if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
+                new_finest = std::max(new_finest,levf);
+	    }
+
             new_bx.refine(bf_lev[levc]);
             new_bx.simplify();
             BL_ASSERT(new_bx.isDisjoint());
@@ -513,9 +513,9 @@ TagBoxArray::numTags () const
 }
 
 void
-TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
+TagBoxArray::local_collate (Vector<IntVect>& TheLocalCollateSpace) const
 {
-    BL_PROFILE("TagBoxArray::collate()");
+    BL_PROFILE("TagBoxArray::local_collate()");
 
     long count = 0;
 
@@ -527,10 +527,7 @@ TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
         count += get(fai).numTags();
     }
 
-    //
-    // Local space for holding just those tags we want to gather to the root cpu.
-    //
-    Vector<IntVect> TheLocalCollateSpace(count);
+    TheLocalCollateSpace.resize(count);
 
     count = 0;
 
@@ -543,8 +540,22 @@ TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
     if (count > 0)
     {
         amrex::RemoveDuplicates(TheLocalCollateSpace);
-	count = TheLocalCollateSpace.size();
     }
+}
+
+void
+TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
+{
+    BL_PROFILE("TagBoxArray::collate()");
+
+    //
+    // Local space for holding just those tags we want to gather to the root cpu.
+    //
+    Vector<IntVect> TheLocalCollateSpace;
+    local_collate(TheLocalCollateSpace);
+
+    long count = TheLocalCollateSpace.size();
+
     //
     // The total number of tags system wide that must be collated.
     // This is really just an estimate of the upper bound due to duplicates.
@@ -200,10 +200,9 @@ namespace amrex{
 			continue;
 		}
 
-		if(m_level_afpi[iteration-1]->destGraph->worker[tg]->computedRegionQueue->queueSize() != 0)
+		f = m_level_afpi[iteration-1]->destGraph->worker[tg]->computedRegionQueue->removeRegion();
+		if(f != -1)
 		{
-		    f = m_level_afpi[iteration-1]->destGraph->worker[tg]->computedRegionQueue->removeRegion();
-
 		    if(push & level == m_level_afpi[iteration-1]->m_amrlevel.parent->finestLevel() && iteration < m_level_afpi[iteration-1]->m_amrlevel.parent->nCycle(level))
 			m_level_afpi[iteration]->SendIntraLevel(*(this),boxGrow,time+dt,index,scomp,ncomp,iteration,f,true);
 
@@ -298,10 +297,9 @@ namespace amrex{
                         continue;
                 }
 
-                if(m_level_afpi[iteration-1]->destGraph->worker[tg]->computedRegionQueue->queueSize() != 0)
+                f = m_level_afpi[iteration-1]->destGraph->worker[tg]->computedRegionQueue->removeRegion();
+                if(f != -1)
                 {
-                    f = m_level_afpi[iteration-1]->destGraph->worker[tg]->computedRegionQueue->removeRegion();
-
                     if(push & level == m_level_afpi[iteration-1]->m_amrlevel.parent->finestLevel() && iteration < m_level_afpi[iteration-1]->m_amrlevel.parent->nCycle(level))
                         m_level_afpi[iteration]->SendIntraLevel(*(this),boxGrow,time+dt,index,scomp,ncomp,iteration,f,true);
 
@@ -371,7 +369,8 @@ namespace amrex{
 		else
 		    currentRegion = itrGraph->getAnyFireableRegion();
 
-		if(tiling)
+		// -1 if the team's last regions were completed by other teams
+		if(tiling && currentRegion >= 0)
 		    totalItr = std::ceil( (1.0*itrGraph->fabTiles[currentRegion]->numTiles) / (perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS) );
 		else
 		    totalItr = 1;
@@ -379,7 +378,7 @@ namespace amrex{
 		currentItr = 1;
 
 		currentTile = 0;
-		if(tiling)
+		if(tiling && currentRegion >= 0)
 		    for(currentTile = 0; currentTile < itrGraph->fabTiles[currentRegion]->numTiles; currentTile++)
 			if(currentTile % (perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS) == ntid)
 			    break;
@@ -391,7 +390,7 @@ namespace amrex{
     void RGIter::operator++ ()
     {
 	currentItr++;
-	if(tiling)
+	if(tiling && currentRegion >= 0)
 	    for( (currentTile == itrGraph->fabTiles[currentRegion]->numTiles ? currentTile : ++currentTile); currentTile < itrGraph->fabTiles[currentRegion]->numTiles; currentTile++)
 	    {
 		if(implicit)
@@ -407,7 +406,7 @@ namespace amrex{
 	if(currentItr > totalItr)
 	{
 	    if(implicit) itrGraph->regionComputed(currentRegion);
-	    else itrGraph->finalizeRegion(currentRegion);
+	    else if(currentRegion >= 0) itrGraph->finalizeRegion(currentRegion);
 	    if(implicit)
 	    {
 		if(!itrGraph->isGraphEmptyV2())
@@ -435,14 +434,14 @@ namespace amrex{
 			currentRegion = itrGraph->getAnyFireableRegion(*depGraph);
 		    else
 			currentRegion = itrGraph->getAnyFireableRegion();
-		    if(tiling)
+		    if(tiling && currentRegion >= 0)
 			totalItr = std::ceil( (1.0*itrGraph->fabTiles[currentRegion]->numTiles) / (perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS) );
 		    else
 			totalItr = 1;
 
 		    currentItr = 1;
 		    currentTile = 0;
-		    if(tiling)
+		    if(tiling && currentRegion >= 0)
 			for(currentTile = 0; currentTile < itrGraph->fabTiles[currentRegion]->numTiles; currentTile++)
 			    if(currentTile % (perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS) == ntid/*-perilla::NUM_COMM_THREADS*/)
 				break;	      
@@ -52,6 +52,7 @@ void RegionGraph::Initialize()
 	    worker[tg]->computedRegionQueue = new RegionQueue(numfabs);
 	    worker[tg]->completedRegionQueue = new RegionQueue(numfabs);
 	}
+	worker[tg]->readyRegionDeque = new RegionDeque(numfabs <= perilla::TASK_QUEUE_DEFAULT_SIZE ? perilla::TASK_QUEUE_DEFAULT_SIZE : numfabs);
 	worker[tg]->totalTasks = 0;
 	worker[tg]->computedTasks = 0;
 	for(int f=0; f < numfabs; f++)
@@ -82,10 +83,12 @@ void RegionGraph::Reset()
 
     if(okToReset[tg])
     {
+	worker[tg]->epoch.fetch_add(1, std::memory_order_release);
 	worker[tg]->totalTasks = 0;
 	worker[tg]->computedTasks = 0;
 	while(worker[tg]->completedRegionQueue->queueSize(true) > 0)
 	{
+	    // removeRegion returns -1 if the queue is empty, which isMyRegion rejects
 	    int r = worker[tg]->completedRegionQueue->removeRegion(true);
 	    if(WorkerThread::isMyRegion(tg, r))
 	    {
@@ -143,6 +146,7 @@ void RegionGraph::regionGraphReset(int numfabs)
 	    totalFinishes=0;	
 	if(perilla::isMasterWorkerThread())
 	{
+	    worker[tg]->epoch.fetch_add(1, std::memory_order_release);
 	    worker[tg]->totalTasks = 0;
 	    worker[tg]->computedTasks = 0;
 	    while(worker[tg]->completedRegionQueue->queueSize(true) > 0)
@@ -203,6 +207,7 @@ void RegionGraph::enableAllRegions()
 	    if(WorkerThread::isMyRegion(tg, f))
 	    {
 		r = worker[tg]->unfireableRegionQueue->removeRegion(true);
+		if(r < 0) break;
 		worker[tg]->fireableRegionQueue->addRegion(r,true);
 	    }    
     worker[tg]->barr->sync(perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS); // Barrier to synchronize team threads        
@@ -211,12 +216,13 @@ void RegionGraph::enableAllRegions()
 void RegionGraph::disableRegion(int r)
 {
     int tg = WorkerThread::perilla_wid();
+    // the region may have been stolen from another team; it goes back to its owner
     if(perilla::isMasterWorkerThread())
-	if(WorkerThread::isMyRegion(tg, r))
-	{
-	    int rID = worker[tg]->fireableRegionQueue->removeRegion(true);
-	    worker[tg]->unfireableRegionQueue->addRegion(rID,true);
-	}
+    {
+	int rID = worker[tg]->fireableRegionQueue->removeRegion(true);
+	if(rID >= 0)
+	    worker[WorkerThread::regionOwner(rID)]->unfireableRegionQueue->addRegion(rID,true);
+    }
 }
 
 void RegionGraph::regionComputed(int r)
@@ -243,17 +249,17 @@ void RegionGraph::finalizeRegion(int r)
     int tg= perilla::wid();
     int ntid=perilla::wtid();
     worker[tg]->barr->sync(perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS); // Barrier to synchronize team threads
+    // the region may have been stolen from another team; it is completed for its owner
     if(perilla::isMasterWorkerThread())
-	if(WorkerThread::isMyRegion(tg, r))
+    {
+	int rr = worker[tg]->fireableRegionQueue->removeRegion(true);
+	if(r != rr)
 	{
-	    int rr = worker[tg]->fireableRegionQueue->removeRegion(true);
-	    if(r != rr)
-	    {
-		std::cout << "ERROR: In completeRegion" << std::endl;
-		exit(EXIT_FAILURE);
-	    }
-	    worker[tg]->completedRegionQueue->addRegion(rr,true);
+	    std::cout << "ERROR: In completeRegion" << std::endl;
+	    exit(EXIT_FAILURE);
 	}
+	worker[WorkerThread::regionOwner(rr)]->completedRegionQueue->addRegion(rr,true);
+    }
     worker[tg]->barr->sync(perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS); // Barrier to synchronize team threads
 }
 
@@ -327,7 +333,7 @@ int RegionGraph::getFireableRegion(bool isSingleThread)
     {
 	fireable = false;
 	r = worker[tg]->unfireableRegionQueue->removeRegion(true);
-	while(!fireable)
+	while(r >= 0 && !fireable)
 	{
 	    fireable = isFireableRegion(r);
 	    if(!fireable)
@@ -343,6 +349,8 @@ int RegionGraph::getFireableRegion(bool isSingleThread)
 	for(int i = 0; i < unfQsize; i++)
 	{
 	    int tr = worker[tg]->unfireableRegionQueue->removeRegion(true);
+	    if(tr < 0)
+		break;
 	    if(isFireableRegion(tr))
 	    {
 		r = tr;
@@ -367,22 +375,9 @@ int RegionGraph::getAnyFireableRegion()
     int nt = perilla::wtid();
     worker[tg]->l_barr->sync(perilla::NUM_THREADS_PER_TEAM-1);
     if(nt == 0 && worker[tg]->fireableRegionQueue->queueSize()==0)      
-    {
-	bool fireable = false;
-	int r = worker[tg]->unfireableRegionQueue->removeRegion(true);
-	while(!fireable)
-	{
-	    fireable = isFireableRegion(r);
-	    if(!fireable)
-	    {
-		worker[tg]->unfireableRegionQueue->addRegion(r,true);
-		r = worker[tg]->unfireableRegionQueue->removeRegion(true);
-	    }
-	    else
-		worker[tg]->fireableRegionQueue->addRegion(r,true);
-	}
-    }
+	findFireableRegion(0);
     worker[tg]->l_barr->sync(perilla::NUM_THREADS_PER_TEAM-1);
+    // -1 once every region of the team has been completed
     return worker[tg]->fireableRegionQueue->getFrontRegion(true);
 }
 
@@ -398,25 +393,102 @@ int RegionGraph::getAnyFireableRegion(RegionGraph& depGraph)
     tg = perilla::wid();
     nt = perilla::wtid();
     if(nt == 0 && worker[tg]->fireableRegionQueue->queueSize()==0) 
+	findFireableRegion(&depGraph);
+    worker[tg]->l_barr->sync(perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS); // Barrier to synchronize team threads
+    r = worker[tg]->fireableRegionQueue->getFrontRegion(true);
+    return r;
+}
+
+//
+// Called by the master thread of team tg when the team has no region to work
+// on.  Every fireable region of the team is moved to its ready deque, and the
+// team takes the one pushed last.  If it has none, it steals the oldest one of
+// another team.  The region taken is put in the fireable queue of the team.
+// Returns without a region only once all regions of the team are completed,
+// some of them possibly by other teams.
+//
+void RegionGraph::findFireableRegion(RegionGraph* depGraph)
+{
+    int tg = perilla::wid();
+    Worker* w = worker[tg];
+    for(;;)
     {
-	fireable = false;
-	r = worker[tg]->unfireableRegionQueue->removeRegion(true);
-	while(!fireable)
+	int r = w->readyRegionDeque->popRegion();
+	if(r < 0)
 	{
-	    fireable = isFireableRegion(r);
-	    fireable &= depGraph.isFireableRegion(r);
-	    if(!fireable)
+	    int unfQsize = w->unfireableRegionQueue->queueSize(true);
+	    for(int i = 0; i < unfQsize; i++)
 	    {
-		worker[tg]->unfireableRegionQueue->addRegion(r,true);
-		r = worker[tg]->unfireableRegionQueue->removeRegion(true);
+		int tr = w->unfireableRegionQueue->removeRegion(true);
+		if(tr < 0)
+		    break;
+		if(isFireableRegion(tr) && (depGraph == 0 || depGraph->isFireableRegion(tr)))
+		    w->readyRegionDeque->pushRegion(tr);
+		else
+		    w->unfireableRegionQueue->addRegion(tr,true);
 	    }
-	    else
-		worker[tg]->fireableRegionQueue->addRegion(r,true);
+	    r = w->readyRegionDeque->popRegion();
+	}
+	if(r < 0 && perilla::WORK_STEALING)
+	    r = stealRegion(tg);
+	if(r >= 0)
+	{
+	    w->fireableRegionQueue->addRegion(r,true);
+	    return;
 	}
+	if(w->completedRegionQueue->queueSize(true) == w->totalTasks)
+	    return;
+    }
+}
+
+int RegionGraph::stealRegion(int tg)
+{
+    for(int i = 1; i < perilla::NUM_THREAD_TEAMS; i++)
+    {
+	int v = (tg+i) % perilla::NUM_THREAD_TEAMS;
+	int r = worker[v]->readyRegionDeque->stealRegion();
+	if(r < 0)
+	{
+	    worker[tg]->numFailedSteals++;
+	    continue;
+	}
+	// Team v only pushes regions of its current traversal, so r belongs
+	// to it.  If that is not ours, give r back for team v to find again.
+	if(worker[v]->epoch.load(std::memory_order_acquire) != worker[tg]->epoch.load(std::memory_order_relaxed))
+	{
+	    worker[v]->unfireableRegionQueue->addRegion(r,true);
+	    worker[tg]->numFailedSteals++;
+	    continue;
+	}
+	worker[tg]->numSteals++;
+	return r;
+    }
+    return -1;
+}
+
+long RegionGraph::numSteals()
+{
+    long n = 0;
+    for(int tg=0; tg<perilla::NUM_THREAD_TEAMS; tg++)
+	n += worker[tg]->numSteals;
+    return n;
+}
+
+long RegionGraph::numFailedSteals()
+{
+    long n = 0;
+    for(int tg=0; tg<perilla::NUM_THREAD_TEAMS; tg++)
+	n += worker[tg]->numFailedSteals;
+    return n;
+}
+
+void RegionGraph::resetStealCounters()
+{
+    for(int tg=0; tg<perilla::NUM_THREAD_TEAMS; tg++)
+    {
+	worker[tg]->numSteals = 0;
+	worker[tg]->numFailedSteals = 0;
     }
-    worker[tg]->l_barr->sync(perilla::NUM_THREADS_PER_TEAM-perilla::NUM_COMM_THREADS); // Barrier to synchronize team threads
-    r = worker[tg]->fireableRegionQueue->getFrontRegion(true);
-    return r;
 }
 
 
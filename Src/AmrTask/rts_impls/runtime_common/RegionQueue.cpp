@@ -1,4 +1,5 @@
 #include <RegionQueue.H>
+#include <AMReX.H>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -6,22 +7,28 @@
 //////////////////////// class RegionQueue Definition Start /////////////////////////////////////  
 RegionQueue::RegionQueue(void)
 {
-    max_size= perilla::TASK_QUEUE_DEFAULT_SIZE;
-    buffer = new int[max_size];
-    n = 0;
-    front = 0;
-    rear = 0;
-    queueLock=PTHREAD_MUTEX_INITIALIZER;
+    init(perilla::TASK_QUEUE_DEFAULT_SIZE);
 }
 
 RegionQueue::RegionQueue(int numTasks)
 {
-    buffer = new int[numTasks];
-    n = 0;
-    max_size = numTasks;
-    front = 0;
-    rear = 0;
-    queueLock=PTHREAD_MUTEX_INITIALIZER;
+    init(numTasks);
+}
+
+void RegionQueue::init(int numTasks)
+{
+    // capacity must be a power of two so that positions can be masked
+    max_size = 1;
+    while(max_size < numTasks) max_size *= 2;
+    mask = max_size - 1;
+    buffer = new Cell[max_size];
+    for(long i=0; i<max_size; i++)
+    {
+	buffer[i].seq.store(i, std::memory_order_relaxed);
+	buffer[i].region.store(-1, std::memory_order_relaxed);
+    }
+    rear.store(0, std::memory_order_relaxed);
+    front.store(0, std::memory_order_relaxed);
 }
 
 RegionQueue::~RegionQueue()
@@ -29,74 +36,182 @@ RegionQueue::~RegionQueue()
     delete[] buffer;
 }
 
-
 void RegionQueue::addRegion(int r)
 {
-    pthread_mutex_lock(&queueLock);
-    buffer[rear] = r;
-    rear = (rear+1)%max_size;
-    n++;
-    pthread_mutex_unlock(&queueLock);
+    long pos = rear.load(std::memory_order_relaxed);
+    for(;;)
+    {
+	Cell& cell = buffer[pos & mask];
+	long seq = cell.seq.load(std::memory_order_acquire);
+	long dif = seq - pos;
+	if(dif == 0)
+	{
+	    if(rear.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+	    {
+		cell.region.store(r, std::memory_order_relaxed);
+		cell.seq.store(pos+1, std::memory_order_release);
+		return;
+	    }
+	}
+	else if(dif < 0)
+	{
+	    amrex::Abort("RegionQueue::addRegion: queue is full");
+	}
+	else
+	{
+	    pos = rear.load(std::memory_order_relaxed);
+	}
+    }
 }
 
 void RegionQueue::addRegion(int r, bool canAvoidLockd)
 {
-    if(!canAvoidLockd)pthread_mutex_lock(&queueLock);
-    buffer[rear] = r;
-    rear = (rear+1)%max_size;
-    n++;
-    if(!canAvoidLockd)pthread_mutex_unlock(&queueLock);
+    addRegion(r);
+}
+
+bool RegionQueue::tryRemoveRegion(int& r)
+{
+    long pos = front.load(std::memory_order_relaxed);
+    for(;;)
+    {
+	Cell& cell = buffer[pos & mask];
+	long seq = cell.seq.load(std::memory_order_acquire);
+	long dif = seq - (pos+1);
+	if(dif == 0)
+	{
+	    if(front.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+	    {
+		r = cell.region.load(std::memory_order_relaxed);
+		cell.seq.store(pos+mask+1, std::memory_order_release);
+		return true;
+	    }
+	}
+	else if(dif < 0)
+	{
+	    return false;
+	}
+	else
+	{
+	    pos = front.load(std::memory_order_relaxed);
+	}
+    }
 }
 
 int RegionQueue::removeRegion()
 {
     int r;
-    pthread_mutex_lock(&queueLock);
-    r = buffer[front];
-    front = (front+1)%max_size;
-    n--;
-    pthread_mutex_unlock(&queueLock);
+    // an add may have claimed a slot and not published it yet; wait for it
+    // only while such an add is in flight
+    while(!tryRemoveRegion(r))
+    {
+	if(queueSize() == 0) return -1;
+    }
     return r;
 }
 
 int RegionQueue::removeRegion(bool canAvoidLockd)
 {
-    int r;
-    if(!canAvoidLockd)pthread_mutex_lock(&queueLock);
-    r = buffer[front];
-    front = (front+1)%max_size;
-    n--;
-    if(!canAvoidLockd)pthread_mutex_unlock(&queueLock);
-    return r;
+    return removeRegion();
 }
 
 int RegionQueue::getFrontRegion()
 {
-    return buffer[front];
+    long pos = front.load(std::memory_order_acquire);
+    Cell& cell = buffer[pos & mask];
+    // the slot holds the front region only once its add has been published
+    if(cell.seq.load(std::memory_order_acquire) != pos+1) return -1;
+    return cell.region.load(std::memory_order_relaxed);
 }
 
 int RegionQueue::getFrontRegion(bool canAvoidLockd)
 {
-    if(!canAvoidLockd)pthread_mutex_lock(&queueLock);
-    return buffer[front];
-    if(!canAvoidLockd)pthread_mutex_unlock(&queueLock);
+    return getFrontRegion();
 }
 
 int RegionQueue::queueSize()
 {
-    int size;
-    pthread_mutex_lock(&queueLock);
-    size = n;
-    pthread_mutex_unlock(&queueLock);
-    return size;
+    long r = rear.load(std::memory_order_acquire);
+    long f = front.load(std::memory_order_acquire);
+    return (r > f) ? static_cast<int>(r-f) : 0;
 }
 
 int RegionQueue::queueSize(bool canAvoidLockd)
 {
-    int size;
-    if(!canAvoidLockd)pthread_mutex_lock(&queueLock);
-    size = n;
-    if(!canAvoidLockd)pthread_mutex_unlock(&queueLock);
-    return size;
+    return queueSize();
+}
+
+//////////////////////// class RegionQueue Definition End /////////////////////////////////////
+
+//////////////////////// class RegionDeque Definition Start /////////////////////////////////////
+RegionDeque::RegionDeque(int numTasks)
+{
+    long size = 1;
+    while(size < numTasks) size *= 2;
+    mask = size - 1;
+    buffer = new std::atomic<int>[size];
+    for(long i=0; i<size; i++)
+	buffer[i].store(-1, std::memory_order_relaxed);
+    top.store(0, std::memory_order_relaxed);
+    bottom.store(0, std::memory_order_relaxed);
+}
+
+RegionDeque::~RegionDeque()
+{
+    delete[] buffer;
+}
+
+void RegionDeque::pushRegion(int r)
+{
+    long b = bottom.load(std::memory_order_relaxed);
+    long t = top.load(std::memory_order_acquire);
+    if(b - t > mask)
+	amrex::Abort("RegionDeque::pushRegion: deque is full");
+    buffer[b & mask].store(r, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b+1, std::memory_order_relaxed);
+}
+
+int RegionDeque::popRegion()
+{
+    long b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long t = top.load(std::memory_order_relaxed);
+    int r = -1;
+    if(t <= b)
+    {
+	r = buffer[b & mask].load(std::memory_order_relaxed);
+	if(t == b)
+	{
+	    // last region: a thief may be taking it too
+	    if(!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		r = -1;
+	    bottom.store(b+1, std::memory_order_relaxed);
+	}
+    }
+    else
+    {
+	bottom.store(b+1, std::memory_order_relaxed);
+    }
+    return r;
+}
+
+int RegionDeque::stealRegion()
+{
+    long t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long b = bottom.load(std::memory_order_acquire);
+    if(t >= b) return -1;
+    int r = buffer[t & mask].load(std::memory_order_relaxed);
+    if(!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	return -1;
+    return r;
+}
+
+int RegionDeque::queueSize()
+{
+    long b = bottom.load(std::memory_order_acquire);
+    long t = top.load(std::memory_order_acquire);
+    return (b > t) ? static_cast<int>(b-t) : 0;
 }
-//////////////////////// class RegionQueue Definition End /////////////////////////////////////  
+//////////////////////// class RegionDeque Definition End /////////////////////////////////////
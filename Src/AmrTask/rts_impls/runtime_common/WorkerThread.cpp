@@ -122,6 +122,11 @@ using namespace perilla;
 	return ((regionID) % perilla::NUM_THREAD_TEAMS)==workerID;
     }
 
+    int WorkerThread::regionOwner(int regionID)
+    {
+	return regionID % perilla::NUM_THREAD_TEAMS;
+    }
+
 #if 0
     void WorkerThread::setTeamSharedMemory(void* dummy, int tid, int tg)
     {
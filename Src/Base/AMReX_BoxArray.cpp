@@ -208,12 +208,8 @@ BARef::updateMemoryUsage_box (int s)
 void
 BARef::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
-	long b = sizeof(hash);
-	for (const auto& x: hash) {
-	    b += amrex::gcc_map_node_extra_bytes
-		+ sizeof(IntVect) + amrex::bytesOf(x.second);
-	}
+    if (!hash.empty()) {
+	long b = hash.bytes();
 	if (s > 0) {
 	    total_hash_bytes += b;
 	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -224,6 +220,40 @@ BARef::updateMemoryUsage_hash (int s)
 }
 #endif
 
+void
+BARef::HashType::clear ()
+{
+    m_dense = true;
+    Vector<long>().swap(m_bins);
+    Vector<int>().swap(m_offset);
+    Vector<int>().swap(m_boxes);
+}
+
+long
+BARef::HashType::bytes () const noexcept
+{
+    return sizeof(*this) + amrex::bytesOf(m_bins) + amrex::bytesOf(m_offset)
+        + amrex::bytesOf(m_boxes);
+}
+
+std::pair<const int*,const int*>
+BARef::HashType::find (long k, long& hint) const noexcept
+{
+    long ibin;
+    if (m_dense) {
+        ibin = k;
+    } else {
+        auto it = std::lower_bound(m_bins.cbegin()+hint, m_bins.cend(), k);
+        hint = it - m_bins.cbegin();
+        if (it == m_bins.cend() || *it != k) {
+            return std::make_pair(nullptr, nullptr);
+        }
+        ibin = hint;
+    }
+    const int* p = m_boxes.data();
+    return std::make_pair(p+m_offset[ibin], p+m_offset[ibin+1]);
+}
+
 void
 BARef::Initialize ()
 {
@@ -1130,27 +1160,24 @@ BoxArray::intersections (const Box&                         bx,
 
 	if (!cbx.intersects(m_ref->bbox)) return;
 
-	auto TheEnd = BoxHashMap.cend();
-
         bool super_simple = m_simple && m_crse_ratio==1 && m_typ.cellCentered();
         auto& abox = m_ref->m_abox;
 
+        long hint = 0;
         for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
         {
-            auto it = BoxHashMap.find(iv);
+            auto bin = BoxHashMap.find(m_ref->bbox.index(iv), hint);
 
-            if (it != TheEnd)
+            for (const int* it = bin.first; it != bin.second; ++it)
             {
-                for (const int index : it->second)
-                {
-                    const Box& ibox = super_simple ? abox[index] : (*this)[index];
-                    const Box& isect = bx & amrex::grow(ibox,ng);
+                const int index = *it;
+                const Box& ibox = super_simple ? abox[index] : (*this)[index];
+                const Box& isect = bx & amrex::grow(ibox,ng);
 
-                    if (isect.ok())
-                    {
-                        isects.push_back(std::pair<int,Box>(index,isect));
-			if (first_only) return;
-                    }
+                if (isect.ok())
+                {
+                    isects.push_back(std::pair<int,Box>(index,isect));
+                    if (first_only) return;
                 }
             }
         }
@@ -1196,8 +1223,6 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
 
 	if (!cbx.intersects(m_ref->bbox)) return;
 
-	auto TheEnd = BoxHashMap.cend();
-
         BoxList newbl(bl.ixType());
         newbl.reserve(bl.capacity());
         BoxList newdiff(bl.ixType());
@@ -1205,29 +1230,28 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
         bool super_simple = m_simple && m_crse_ratio==1 && m_typ.cellCentered();
         auto& abox = m_ref->m_abox;
 
+        long hint = 0;
 	for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); 
 	     iv <= End && bl.isNotEmpty(); 
 	     cbx.next(iv))
         {
-            auto it = BoxHashMap.find(iv);
+            auto bin = BoxHashMap.find(m_ref->bbox.index(iv), hint);
 
-            if (it != TheEnd)
+            for (const int* it = bin.first; it != bin.second; ++it)
             {
-                for (const int index : it->second)
+                const int index = *it;
+                const Box& isect = (super_simple)
+                    ? (bx & abox[index])
+                    : (bx & (*this)[index]);
+
+                if (isect.ok())
                 {
-                    const Box& isect = (super_simple)
-                        ? (bx & abox[index])
-                        : (bx & (*this)[index]);
-
-                    if (isect.ok())
-                    {
-                        newbl.clear();
-                        for (const Box& b : bl) {
-                            amrex::boxDiff(newdiff, b, isect);
-                            newbl.join(newdiff);
-                        }
-                        bl.swap(newbl);
+                    newbl.clear();
+                    for (const Box& b : bl) {
+                        amrex::boxDiff(newdiff, b, isect);
+                        newbl.join(newdiff);
                     }
+                    bl.swap(newbl);
                 }
             }
         }
@@ -1263,7 +1287,29 @@ BoxArray::removeOverlap (bool simplify)
 
     uniqify();
 
-    BARef::HashType& BoxHashMap = m_ref->hash;
+    //
+    // The pieces added below have to be found by later searches, so this
+    // bins the boxes in a hash map of its own rather than in the compact
+    // BARef::HashType, which cannot grow.
+    //
+    typedef std::unordered_map< IntVect, std::vector<int>, IntVect::shift_hasher > BoxMap;
+    BoxMap BoxHashMap;
+
+    auto& abox = m_ref->m_abox;
+
+    IntVect crsn = IntVect::TheUnitVector();
+    Box bbox;
+    if (!abox.empty()) {
+        bbox = abox[0];
+        for (const auto& b : abox) {
+            crsn = amrex::max(crsn, b.size());
+            bbox.minBox(b);
+        }
+        for (int i = 0, N = abox.size(); i < N; ++i) {
+            BoxHashMap[amrex::coarsen(abox[i].smallEnd(),crsn)].push_back(i);
+        }
+        bbox.coarsen(crsn);
+    }
 
     const Box EmptyBox;
 
@@ -1273,32 +1319,46 @@ BoxArray::removeOverlap (bool simplify)
     //
 #ifdef AMREX_MEM_PROFILING
     m_ref->updateMemoryUsage_box(-1);
-    m_ref->updateMemoryUsage_hash(-1);
-    long total_hash_bytes_save = m_ref->total_hash_bytes;
 #endif
 
     BoxList bl_diff;
 
     for (int i = 0; i < size(); i++)
     {
-        if (m_ref->m_abox[i].ok())
+        if (abox[i].ok())
         {
-            intersections(m_ref->m_abox[i],isects);
+            const Box bx = abox[i];
+
+            isects.clear();
+            const Box cbx(amrex::max(amrex::coarsen(bx.smallEnd(),crsn)-1, bbox.smallEnd()),
+                          amrex::min(amrex::coarsen(bx.bigEnd(),crsn), bbox.bigEnd()));
+            for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+            {
+                auto it = BoxHashMap.find(iv);
+                if (it != BoxHashMap.end()) {
+                    for (const int index : it->second) {
+                        const Box& isect = bx & abox[index];
+                        if (isect.ok()) {
+                            isects.push_back(std::pair<int,Box>(index,isect));
+                        }
+                    }
+                }
+            }
 
             for (int j = 0, N = isects.size(); j < N; j++)
             {
                 if (isects[j].first == i) continue;
 
-                Box& bx = m_ref->m_abox[isects[j].first];
+                Box& jbx = abox[isects[j].first];
 
-                amrex::boxDiff(bl_diff, bx, isects[j].second);
+                amrex::boxDiff(bl_diff, jbx, isects[j].second);
 
-                bx = EmptyBox;
+                jbx = EmptyBox;
 
                 for (const Box& b : bl_diff)
                 {
-                    m_ref->m_abox.push_back(b);
-                    BoxHashMap[amrex::coarsen(b.smallEnd(),m_ref->crsn)].push_back(size()-1);
+                    abox.push_back(b);
+                    BoxHashMap[amrex::coarsen(b.smallEnd(),crsn)].push_back(size()-1);
                 }
             }
         }
@@ -1324,10 +1384,6 @@ BoxArray::removeOverlap (bool simplify)
 
     *this = nba;
 
-#ifdef AMREX_MEM_PROFILING
-    m_ref->total_hash_bytes = total_hash_bytes_save;
-#endif
-
     BL_ASSERT(isDisjoint());
 }
 
@@ -1386,16 +1442,53 @@ BoxArray::getHashMap () const
                 boundingbox.minBox(bx);
             }
 
+            m_ref->crsn = maxext;
+            m_ref->bbox =boundingbox.coarsen(maxext);
+            m_ref->bbox.normalize();
+
+            const Box& binbox = m_ref->bbox;
+            Vector<long> bin(N);
+            Vector<int> order(N);
             for (int i = 0; i < N; i++)
             {
-                const IntVect& crsnsmlend 
-		    = amrex::coarsen(m_ref->m_abox[i].smallEnd(),maxext);
-                BoxHashMap[crsnsmlend].push_back(i);
+                bin[i] = binbox.index(amrex::coarsen(m_ref->m_abox[i].smallEnd(),maxext));
+                order[i] = i;
             }
+            std::sort(order.begin(), order.end(), [&bin] (int a, int b) -> bool
+                      { return bin[a] < bin[b] || (bin[a] == bin[b] && a < b); });
 
-            m_ref->crsn = maxext;
-            m_ref->bbox =boundingbox.coarsen(maxext);
-            m_ref->bbox.normalize();
+            long nbins = 0;
+            for (int i = 0; i < N; i++) {
+                if (i == 0 || bin[order[i]] != bin[order[i-1]]) ++nbins;
+            }
+
+            // A dense offset array costs one int per bin of bbox, a sparse
+            // one a long and an int per occupied bin.
+            BoxHashMap.m_dense = binbox.numPts() <= 3*nbins;
+            BoxHashMap.m_boxes = std::move(order);
+            const auto& boxes = BoxHashMap.m_boxes;
+            if (BoxHashMap.m_dense)
+            {
+                BoxHashMap.m_offset.assign(binbox.numPts()+1, 0);
+                for (int i = 0; i < N; i++) {
+                    ++BoxHashMap.m_offset[bin[i]+1];
+                }
+                for (long k = 0, M = binbox.numPts(); k < M; ++k) {
+                    BoxHashMap.m_offset[k+1] += BoxHashMap.m_offset[k];
+                }
+            }
+            else
+            {
+                BoxHashMap.m_bins.reserve(nbins);
+                BoxHashMap.m_offset.reserve(nbins+1);
+                for (int i = 0; i < N; i++) {
+                    if (i == 0 || bin[boxes[i]] != bin[boxes[i-1]]) {
+                        BoxHashMap.m_bins.push_back(bin[boxes[i]]);
+                        BoxHashMap.m_offset.push_back(i);
+                    }
+                }
+                BoxHashMap.m_offset.push_back(N);
+            }
 
 #ifdef AMREX_MEM_PROFILING
 	    m_ref->updateMemoryUsage_hash(1);
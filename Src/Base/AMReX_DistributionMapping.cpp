@@ -10,6 +10,7 @@
 #endif
 #include <AMReX_VisMF.H>
 #include <AMReX_Utility.H>
+#include <AMReX_Machine.H>
 
 #include <iostream>
 #include <fstream>
@@ -22,6 +23,7 @@
 #include <numeric>
 #include <string>
 #include <cstring>
+#include <cstdint>
 #include <iomanip>
 
 namespace {
@@ -38,6 +40,8 @@ namespace amrex {
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    int    graph_nghost;
+    Real   graph_imbalance;
 
 // We default to SFC.
 DistributionMapping::Strategy DistributionMapping::m_Strategy = DistributionMapping::SFC;
@@ -75,6 +79,15 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case HILBERT:
+        m_BuildMap = &DistributionMapping::HilbertProcessorMap;
+        break;
+    case GRAPH:
+        m_BuildMap = &DistributionMapping::GraphProcessorMap;
+        break;
+    case TOPOLOGY:
+        m_BuildMap = &DistributionMapping::TopologyProcessorMap;
+        break;
     default:
         amrex::Error("Bad DistributionMapping::Strategy");
     }
@@ -115,6 +128,8 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9;
     node_size        = 0;
+    graph_nghost     = 1;
+    graph_imbalance  = 0.1;
     flag_verbose_mapper = 0;
 
     ParmParse pp("DistributionMapping");
@@ -125,6 +140,8 @@ DistributionMapping::Initialize ()
     pp.query("sfc_threshold",       sfc_threshold);
     pp.query("node_size",           node_size);
     pp.query("verbose_mapper",      flag_verbose_mapper);
+    pp.query("graph_nghost",        graph_nghost);
+    pp.query("graph_imbalance",     graph_imbalance);
 
     std::string theStrategy;
 
@@ -146,6 +163,18 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "HILBERT")
+        {
+            strategy(HILBERT);
+        }
+        else if (theStrategy == "GRAPH")
+        {
+            strategy(GRAPH);
+        }
+        else if (theStrategy == "TOPOLOGY")
+        {
+            strategy(TOPOLOGY);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -912,6 +941,326 @@ SFCToken::Compare::operator () (const SFCToken& lhs,
     return false;
 }
 
+namespace
+{
+    //
+    // Hilbert index of iv, whose components must be in [0,2^nbits), using
+    // Skilling's transpose algorithm (AIP Conf. Proc. 707, 381 (2004)).
+    //
+    std::uint64_t
+    HilbertKey (const IntVect& iv, int nbits)
+    {
+        std::uint32_t X[AMREX_SPACEDIM];
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            X[d] = static_cast<std::uint32_t>(iv[d]);
+        }
+
+        if (nbits > 0)
+        {
+            const std::uint32_t M = std::uint32_t(1) << (nbits-1);
+            //
+            // Inverse undo.
+            //
+            for (std::uint32_t Q = M; Q > 1; Q >>= 1)
+            {
+                const std::uint32_t P = Q - 1;
+                for (int d = 0; d < AMREX_SPACEDIM; ++d)
+                {
+                    if (X[d] & Q) {
+                        X[0] ^= P;
+                    } else {
+                        const std::uint32_t t = (X[0] ^ X[d]) & P;
+                        X[0] ^= t;
+                        X[d] ^= t;
+                    }
+                }
+            }
+            //
+            // Gray encode.
+            //
+            for (int d = 1; d < AMREX_SPACEDIM; ++d) {
+                X[d] ^= X[d-1];
+            }
+            std::uint32_t t = 0;
+            for (std::uint32_t Q = M; Q > 1; Q >>= 1) {
+                if (X[AMREX_SPACEDIM-1] & Q) t ^= Q - 1;
+            }
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                X[d] ^= t;
+            }
+        }
+        //
+        // Interleave the transposed bits, most significant first.
+        //
+        std::uint64_t key = 0;
+        for (int b = nbits-1; b >= 0; --b) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                key = (key << 1) | ((X[d] >> b) & 1u);
+            }
+        }
+        return key;
+    }
+
+    //
+    // Put the tokens in Hilbert space filling curve order.  Unlike the
+    // Morton order, two consecutive points on the curve are always
+    // neighbors, so the pieces cut out of it are compact even for
+    // elongated domains.
+    //
+    void
+    HilbertSort (std::vector<SFCToken>& tokens)
+    {
+        if (tokens.empty()) return;
+
+        IntVect lo = tokens[0].m_idx;
+        for (const SFCToken& tok : tokens) {
+            lo.min(tok.m_idx);
+        }
+
+        long maxijk = 0;
+        for (const SFCToken& tok : tokens) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                maxijk = std::max(maxijk, static_cast<long>(tok.m_idx[d]) - lo[d]);
+            }
+        }
+
+        int nbits = 0;
+        for ( ; (1L << nbits) <= maxijk; ++nbits) {
+            ;  // do nothing
+        }
+        //
+        // The key has 64 bits.  Drop the least significant bits if needed.
+        //
+        const int maxbits = std::min(31, 64/AMREX_SPACEDIM);
+        const int shift = std::max(0, nbits - maxbits);
+        nbits -= shift;
+
+        std::vector<std::pair<std::uint64_t,int> > keys;
+        keys.reserve(tokens.size());
+        for (int i = 0, N = tokens.size(); i < N; ++i)
+        {
+            IntVect iv = tokens[i].m_idx - lo;
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                iv[d] >>= shift;
+            }
+            keys.push_back(std::make_pair(HilbertKey(iv,nbits), i));
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<SFCToken> sorted;
+        sorted.reserve(tokens.size());
+        for (const auto& k : keys) {
+            sorted.push_back(tokens[k.second]);
+        }
+        tokens.swap(sorted);
+    }
+
+    //
+    // The graph of the boxes in compressed sparse row format.  The weight of
+    // the edge between boxes i and j is the number of ghost cells they fill
+    // from each other.  Each edge is stored twice, once for each box.
+    //
+    struct CommGraph
+    {
+        std::vector<int>  xadj;
+        std::vector<int>  adjncy;
+        std::vector<long> adjwgt;
+    };
+
+    void
+    BuildCommGraph (const BoxArray& boxes, const IntVect& nghost, const Periodicity& period,
+                    CommGraph& g)
+    {
+        BL_PROFILE("DistributionMapping::BuildCommGraph()");
+
+        const int N = boxes.size();
+
+        g.xadj.clear();
+        g.adjncy.clear();
+        g.adjwgt.clear();
+        g.xadj.reserve(N+1);
+        g.xadj.push_back(0);
+
+        const std::vector<IntVect>& pshifts = period.shiftIntVect();
+        std::vector< std::pair<int,Box> > isects;
+        std::map<int,int> edge; // neighbor -> position in adjncy
+
+        for (int i = 0; i < N; ++i)
+        {
+            const Box& bxi = boxes[i];
+            edge.clear();
+            for (const auto& iv : pshifts)
+            {
+                boxes.intersections(amrex::grow(bxi,nghost)+iv, isects);
+                for (const auto& is : isects)
+                {
+                    const int j = is.first;
+                    if (j == i) continue;
+                    // the ghost cells of i filled from j and those of j filled
+                    // from i, through the same periodic image
+                    const Box& bxj = boxes[j];
+                    const long w = is.second.numPts() + (amrex::grow(bxj,nghost) & (bxi+iv)).numPts();
+                    auto it = edge.find(j);
+                    if (it == edge.end()) {
+                        edge[j] = static_cast<int>(g.adjncy.size());
+                        g.adjncy.push_back(j);
+                        g.adjwgt.push_back(w);
+                    } else {
+                        g.adjwgt[it->second] += w;
+                    }
+                }
+            }
+            g.xadj.push_back(g.adjncy.size());
+        }
+    }
+
+    //
+    // owner[i] is the process of box i in [0,nprocs).  If node is not
+    // empty, node[p] is the machine node of process p.
+    //
+    DistributionMapping::CommMetric
+    ComputeCommMetric (const CommGraph&         g,
+                       const std::vector<int>&  owner,
+                       const std::vector<long>& wgts,
+                       int                      nprocs,
+                       const std::vector<int>&  node = std::vector<int>())
+    {
+        DistributionMapping::CommMetric r;
+
+        long cut = 0, tot = 0, offnode = 0;
+        for (int i = 0, N = owner.size(); i < N; ++i)
+        {
+            for (int k = g.xadj[i]; k < g.xadj[i+1]; ++k)
+            {
+                const int j = g.adjncy[k];
+                tot += g.adjwgt[k];
+                if (owner[j] != owner[i]) {
+                    cut += g.adjwgt[k];
+                    if (!node.empty() && node[owner[j]] != node[owner[i]]) {
+                        offnode += g.adjwgt[k];
+                    }
+                }
+            }
+        }
+        // Each edge has been counted twice.
+        r.edge_cut    = cut/2;
+        r.offnode_cut = offnode/2;
+        r.total_edge  = tot/2;
+
+        std::vector<long> load(nprocs, 0);
+        long sum = 0;
+        for (int i = 0, N = owner.size(); i < N; ++i) {
+            load[owner[i]] += wgts[i];
+            sum += wgts[i];
+        }
+        const long mx = *std::max_element(load.begin(), load.end());
+        r.imbalance = (sum > 0) ? (Real(mx)*nprocs)/sum : 1.0;
+
+        return r;
+    }
+
+    //
+    // Greedy refinement of a partition of the graph: move a box to the
+    // neighboring part it exchanges the most ghost cells with if that
+    // reduces the edge cut, or if it keeps the edge cut and improves the
+    // balance, and the target part stays within maxload.  Every move
+    // decreases either the edge cut or the spread of the relative loads, so
+    // this terminates.  If group is not empty, boxes only move between parts
+    // of the same group.
+    //
+    void
+    RefinePartition (const CommGraph&         g,
+                     const std::vector<long>& wgts,
+                     const std::vector<Real>& maxload,
+                     const std::vector<int>&  group,
+                     std::vector<int>&        part,
+                     std::vector<long>&       load,
+                     std::vector<int>&        count)
+    {
+        BL_PROFILE("DistributionMapping::RefinePartition()");
+
+        const int N = part.size();
+        const int max_passes = 8;
+
+        std::vector<long> conn(load.size(), 0);
+        std::vector<int>  touched;
+
+        for (int pass = 0; pass < max_passes; ++pass)
+        {
+            int nmoved = 0;
+
+            for (int i = 0; i < N; ++i)
+            {
+                const int src = part[i];
+                if (count[src] == 1) continue;
+
+                touched.clear();
+                for (int k = g.xadj[i]; k < g.xadj[i+1]; ++k)
+                {
+                    const int p = part[g.adjncy[k]];
+                    if (conn[p] == 0) touched.push_back(p);
+                    conn[p] += g.adjwgt[k];
+                }
+
+                int  best     = src;
+                long bestgain = 0;
+                Real bestfill = load[src]/maxload[src];
+                for (int p : touched)
+                {
+                    if (p == src || load[p] + wgts[i] > maxload[p]) continue;
+                    if (!group.empty() && group[p] != group[src]) continue;
+
+                    const long gain = conn[p] - conn[src];
+                    const Real fill = (load[p] + wgts[i])/maxload[p];
+                    if (gain > bestgain || (gain == bestgain && fill < bestfill))
+                    {
+                        best     = p;
+                        bestgain = gain;
+                        bestfill = fill;
+                    }
+                }
+
+                for (int p : touched) {
+                    conn[p] = 0;
+                }
+
+                if (best != src)
+                {
+                    part[i] = best;
+                    load[src] -= wgts[i];
+                    load[best] += wgts[i];
+                    --count[src];
+                    ++count[best];
+                    ++nmoved;
+                }
+            }
+
+            if (flag_verbose_mapper) {
+                Print() << "  RefinePartition pass " << pass << " moved " << nmoved
+                        << " boxes" << std::endl;
+            }
+
+            if (nmoved == 0) break;
+        }
+    }
+
+    //
+    // The machine node of each process in the current ParallelContext.
+    //
+    std::vector<int>
+    ProcessNodes ()
+    {
+        const int nprocs = ParallelContext::NProcsSub();
+        const Vector<int>& node_ids = machine::node_ids();
+        std::vector<int> r(nprocs);
+        for (int p = 0; p < nprocs; ++p) {
+            r[p] = node_ids[ParallelContext::local_to_global_rank(p)];
+        }
+        return r;
+    }
+}
+
 static
 void
 Distribute (const std::vector<SFCToken>&     tokens,
@@ -1000,7 +1349,8 @@ void
 DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
                                           const std::vector<long>& wgts,
                                           int                   /*   nprocs */,
-                                          bool                     sort)
+                                          bool                     sort,
+                                          bool                     hilbert)
 {
     if (flag_verbose_mapper) {
         Print() << "DM: SFCProcessorMapDoIt called..." << std::endl;
@@ -1059,9 +1409,13 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
     }
     SFCToken::MaxPower = m;
     //
-    // Put'm in Morton space filling curve order.
+    // Put'm in Morton or Hilbert space filling curve order.
     //
-    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    if (hilbert) {
+        HilbertSort(tokens);
+    } else {
+        std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    }
     //
     // Split'm up as equitably as possible per team.
     //
@@ -1204,7 +1558,8 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
             sum_wgt += W;
         }
 
-        amrex::Print() << "SFC efficiency: " << (sum_wgt/(nteams*max_wgt)) << '\n';
+        amrex::Print() << (hilbert ? "HILBERT" : "SFC") << " efficiency: "
+                       << (sum_wgt/(nteams*max_wgt)) << '\n';
     }
 }
 
@@ -1258,6 +1613,415 @@ DistributionMapping::SFCProcessorMap (const BoxArray&          boxes,
     }
 }
 
+void
+DistributionMapping::HilbertProcessorMap (const BoxArray& boxes,
+                                          int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(boxes.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(boxes,nprocs);
+    }
+    else
+    {
+        std::vector<long> wgts;
+
+        wgts.reserve(boxes.size());
+
+	for (int i = 0, N = boxes.size(); i < N; ++i)
+        {
+            wgts.push_back(boxes[i].volume());
+        }
+
+        SFCProcessorMapDoIt(boxes,wgts,nprocs,true,true);
+    }
+}
+
+void
+DistributionMapping::HilbertProcessorMap (const BoxArray&          boxes,
+                                          const std::vector<long>& wgts,
+                                          int                      nprocs,
+                                          bool                     sort)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        SFCProcessorMapDoIt(boxes,wgts,nprocs,sort,true);
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMapDoIt (const BoxArray&          boxes,
+                                            const std::vector<long>& wgts,
+                                            const IntVect&           nghost,
+                                            const Periodicity&       period)
+{
+    BL_PROFILE("DistributionMapping::GraphProcessorMapDoIt()");
+
+#if defined (BL_USE_TEAM)
+    amrex::Abort("Team support is not implemented yet in GRAPH");
+#endif
+
+    const int nprocs = ParallelContext::NProcsSub();
+    const int N = boxes.size();
+    //
+    // Start from the Hilbert curve partition, which is already compact.
+    //
+    std::vector<SFCToken> tokens;
+    tokens.reserve(N);
+    Real totalvol = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        const Box& bx = boxes[i];
+        tokens.push_back(SFCToken(i,bx.smallEnd(),wgts[i]));
+        totalvol += wgts[i];
+    }
+
+    HilbertSort(tokens);
+
+    std::vector< std::vector<int> > vec(nprocs);
+
+    Distribute(tokens,nprocs,totalvol/nprocs,vec);
+
+    tokens.clear();
+
+    std::vector<int>  part(N);
+    std::vector<long> load(nprocs, 0);
+    std::vector<int>  count(nprocs, 0);
+    for (int p = 0; p < nprocs; ++p)
+    {
+        for (int i : vec[p]) {
+            part[i] = p;
+            load[p] += wgts[i];
+        }
+        count[p] = vec[p].size();
+    }
+
+    CommGraph g;
+    BuildCommGraph(boxes, nghost, period, g);
+
+    CommMetric m0;
+    if (verbose) {
+        m0 = ComputeCommMetric(g, part, wgts, nprocs);
+    }
+
+    std::vector<Real> maxload(nprocs, (1.0 + graph_imbalance) * totalvol / nprocs);
+
+    RefinePartition(g, wgts, maxload, std::vector<int>(), part, load, count);
+
+    for (int i = 0; i < N; ++i) {
+        m_ref->m_pmap[i] = ParallelContext::local_to_global_rank(part[i]);
+    }
+
+    if (verbose)
+    {
+        const CommMetric m = ComputeCommMetric(g, part, wgts, nprocs);
+        amrex::Print() << "GRAPH edge cut: " << m0.edge_cut << " -> " << m.edge_cut
+                       << " of " << m.total_edge << " ghost cells, imbalance: "
+                       << m0.imbalance << " -> " << m.imbalance << '\n';
+    }
+}
+
+void
+DistributionMapping::TopologyProcessorMapDoIt (const BoxArray&          boxes,
+                                               const std::vector<long>& wgts,
+                                               const IntVect&           nghost,
+                                               const Periodicity&       period)
+{
+    BL_PROFILE("DistributionMapping::TopologyProcessorMapDoIt()");
+
+#if defined (BL_USE_TEAM)
+    amrex::Abort("Team support is not implemented yet in TOPOLOGY");
+#endif
+
+    const int nprocs = ParallelContext::NProcsSub();
+    const int N = boxes.size();
+    //
+    // Group the processes by machine node.  The nodes are ordered by their
+    // IDs, which follow the network coordinates where they are known.
+    //
+    const std::vector<int> proc_node_ids = ProcessNodes();
+    std::map<int, std::vector<int> > node_procs;
+    for (int p = 0; p < nprocs; ++p) {
+        node_procs[proc_node_ids[p]].push_back(p);
+    }
+
+    std::vector< std::vector<int> > nodes;
+    std::vector<int> node_of_proc(nprocs);
+    std::vector<int> proc_order;
+    for (const auto& kv : node_procs)
+    {
+        for (int p : kv.second) {
+            node_of_proc[p] = nodes.size();
+            proc_order.push_back(p);
+        }
+        nodes.push_back(kv.second);
+    }
+    const int nnodes = nodes.size();
+
+    std::vector<SFCToken> tokens;
+    tokens.reserve(N);
+    Real totalvol = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        const Box& bx = boxes[i];
+        tokens.push_back(SFCToken(i,bx.smallEnd(),wgts[i]));
+        totalvol += wgts[i];
+    }
+
+    HilbertSort(tokens);
+
+    CommGraph g;
+    BuildCommGraph(boxes, nghost, period, g);
+    //
+    // First partition the boxes across the nodes.  Cut the Hilbert curve
+    // into one piece per process and give each node the pieces of as many
+    // processes as it has, so that every node gets a contiguous part of
+    // the curve.  Then refine to reduce the ghost cells sent off node.
+    //
+    std::vector< std::vector<int> > vec(nprocs);
+    Distribute(tokens,nprocs,totalvol/nprocs,vec);
+
+    std::vector<int>  npart(N);
+    std::vector<long> nload(nnodes, 0);
+    std::vector<int>  ncount(nnodes, 0);
+    for (int k = 0; k < nprocs; ++k)
+    {
+        const int n = node_of_proc[proc_order[k]];
+        for (int i : vec[k]) {
+            npart[i] = n;
+            nload[n] += wgts[i];
+            ++ncount[n];
+        }
+    }
+
+    std::vector<Real> nmaxload(nnodes);
+    for (int n = 0; n < nnodes; ++n) {
+        nmaxload[n] = (1.0 + graph_imbalance) * totalvol * nodes[n].size() / nprocs;
+    }
+
+    RefinePartition(g, wgts, nmaxload, std::vector<int>(), npart, nload, ncount);
+    //
+    // Then partition the boxes of each node across its processes, again
+    // starting from the Hilbert curve, and refine within the node.
+    //
+    std::vector<int>  part(N);
+    std::vector<long> load(nprocs, 0);
+    std::vector<int>  count(nprocs, 0);
+    std::vector<Real> maxload(nprocs);
+    for (int n = 0; n < nnodes; ++n)
+    {
+        const int nr = nodes[n].size();
+
+        std::vector<SFCToken> ntokens;
+        for (const SFCToken& tok : tokens) {
+            if (npart[tok.m_box] == n) ntokens.push_back(tok);
+        }
+
+        std::vector< std::vector<int> > nvec(nr);
+        Distribute(ntokens,nr,Real(nload[n])/nr,nvec);
+
+        for (int j = 0; j < nr; ++j)
+        {
+            const int p = nodes[n][j];
+            for (int i : nvec[j]) {
+                part[i] = p;
+                load[p] += wgts[i];
+            }
+            count[p] = nvec[j].size();
+            maxload[p] = (1.0 + graph_imbalance) * std::max(Real(nload[n])/nr, totalvol/nprocs);
+        }
+    }
+
+    RefinePartition(g, wgts, maxload, node_of_proc, part, load, count);
+
+    for (int i = 0; i < N; ++i) {
+        m_ref->m_pmap[i] = ParallelContext::local_to_global_rank(part[i]);
+    }
+
+    if (verbose)
+    {
+        const CommMetric m = ComputeCommMetric(g, part, wgts, nprocs, node_of_proc);
+        amrex::Print() << "TOPOLOGY edge cut: " << m.edge_cut << " of " << m.total_edge
+                       << " ghost cells, " << m.offnode_cut << " off node on "
+                       << nnodes << " nodes, imbalance: " << m.imbalance << '\n';
+    }
+}
+
+void
+DistributionMapping::TopologyProcessorMap (const BoxArray& boxes,
+                                           int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(boxes.size());
+
+    std::vector<long> wgts;
+
+    wgts.reserve(boxes.size());
+
+    for (int i = 0, N = boxes.size(); i < N; ++i)
+    {
+        wgts.push_back(boxes[i].volume());
+    }
+
+    TopologyProcessorMapDoIt(boxes,wgts,IntVect(graph_nghost),Periodicity::NonPeriodic());
+}
+
+void
+DistributionMapping::TopologyProcessorMap (const BoxArray&          boxes,
+                                           const std::vector<long>& wgts,
+                                           int                   /* nprocs */,
+                                           const IntVect&           nghost,
+                                           const Periodicity&       period)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    TopologyProcessorMapDoIt(boxes,wgts,nghost,period);
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray& boxes,
+                                        int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(boxes.size());
+
+    std::vector<long> wgts;
+
+    wgts.reserve(boxes.size());
+
+    for (int i = 0, N = boxes.size(); i < N; ++i)
+    {
+        wgts.push_back(boxes[i].volume());
+    }
+
+    GraphProcessorMapDoIt(boxes,wgts,IntVect(graph_nghost),Periodicity::NonPeriodic());
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray&          boxes,
+                                        const std::vector<long>& wgts,
+                                        int                   /* nprocs */,
+                                        const IntVect&           nghost,
+                                        const Periodicity&       period)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    GraphProcessorMapDoIt(boxes,wgts,nghost,period);
+}
+
+DistributionMapping::CommMetric
+DistributionMapping::computeCommMetric (const BoxArray&            boxes,
+                                        const DistributionMapping& dm,
+                                        const IntVect&             nghost,
+                                        const std::vector<long>&   wgts,
+                                        const Periodicity&         period)
+{
+    BL_PROFILE("DistributionMapping::computeCommMetric()");
+
+    const int N = boxes.size();
+    BL_ASSERT(dm.size() == N);
+    BL_ASSERT(wgts.empty() || static_cast<int>(wgts.size()) == N);
+
+    std::vector<long> w(wgts.begin(), wgts.end());
+    if (w.empty()) {
+        w.resize(N);
+        for (int i = 0; i < N; ++i) {
+            w[i] = boxes[i].numPts();
+        }
+    }
+
+    std::vector<int> owner(dm.ProcessorMap().begin(), dm.ProcessorMap().end());
+    const int nprocs = std::max(ParallelDescriptor::NProcs(),
+                                *std::max_element(owner.begin(), owner.end()) + 1);
+
+    std::vector<int> node;
+    if (nprocs == ParallelDescriptor::NProcs()) {
+        const Vector<int>& node_ids = machine::node_ids();
+        node.assign(node_ids.begin(), node_ids.end());
+    }
+
+    CommGraph g;
+    BuildCommGraph(boxes, nghost, period, g);
+
+    return ComputeCommMetric(g, owner, w, nprocs, node);
+}
+
+DistributionMapping::CommMetric
+DistributionMapping::computeCommMetric (const FabArrayBase& fa,
+                                        const IntVect&      nghost,
+                                        const Periodicity&  period)
+{
+    BL_PROFILE("DistributionMapping::computeCommMetric()");
+
+    const FabArrayBase::FB& TheFB = fa.getFB(nghost, period);
+
+    const Vector<int>& node_ids = machine::node_ids();
+    const int my_node = node_ids[ParallelDescriptor::MyProc()];
+
+    long cut = 0, tot = 0, offnode = 0;
+    for (const auto& kv : *TheFB.m_SndTags) {
+        for (const auto& tag : kv.second) {
+            cut += tag.sbox.numPts();
+            if (node_ids[kv.first] != my_node) {
+                offnode += tag.sbox.numPts();
+            }
+        }
+    }
+    for (const auto& tag : *TheFB.m_LocTags) {
+        tot += tag.sbox.numPts();
+    }
+    tot += cut;
+
+    const int nprocs = ParallelContext::NProcsSub();
+    const BoxArray& ba = fa.boxArray();
+    const DistributionMapping& dm = fa.DistributionMap();
+    std::vector<long> load(nprocs, 0);
+    long sum = 0;
+    for (int i = 0, N = ba.size(); i < N; ++i) {
+        load[ParallelContext::global_to_local_rank(dm[i])] += ba[i].numPts();
+        sum += ba[i].numPts();
+    }
+
+    ParallelAllReduce::Sum(cut, ParallelContext::CommunicatorSub());
+    ParallelAllReduce::Sum(tot, ParallelContext::CommunicatorSub());
+    ParallelAllReduce::Sum(offnode, ParallelContext::CommunicatorSub());
+
+    CommMetric r;
+    r.edge_cut    = cut;
+    r.offnode_cut = offnode;
+    r.total_edge  = tot;
+    const long mx = *std::max_element(load.begin(), load.end());
+    r.imbalance  = (sum > 0) ? (Real(mx)*nprocs)/sum : 1.0;
+
+    return r;
+}
+
 void
 DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
 				int                      nprocs)
@@ -1454,6 +2218,232 @@ DistributionMapping::makeSFC (const MultiFab& weight, bool sort)
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeHilbert (const MultiFab& weight, bool sort)
+{
+    DistributionMapping r;
+
+    Vector<long> cost(weight.size());
+#ifdef BL_USE_MPI
+    {
+	Vector<Real> rcost(cost.size(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+	    int i = mfi.index();
+	    rcost[i] = weight[mfi].sum(mfi.validbox(),0);
+	}
+
+	ParallelAllReduce::Sum(&rcost[0], rcost.size(), ParallelContext::CommunicatorSub());
+
+	Real wmax = *std::max_element(rcost.begin(), rcost.end());
+        Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
+
+	for (int i = 0; i < rcost.size(); ++i) {
+	    cost[i] = long(rcost[i]*scale) + 1L;
+	}
+    }
+#endif
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.HilbertProcessorMap(weight.boxArray(), cost, nprocs, sort);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const MultiFab& weight, const IntVect& nghost,
+                                const Periodicity& period)
+{
+    DistributionMapping r;
+
+    Vector<long> cost(weight.size());
+#ifdef BL_USE_MPI
+    {
+	Vector<Real> rcost(cost.size(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+	    int i = mfi.index();
+	    rcost[i] = weight[mfi].sum(mfi.validbox(),0);
+	}
+
+	ParallelAllReduce::Sum(&rcost[0], rcost.size(), ParallelContext::CommunicatorSub());
+
+	Real wmax = *std::max_element(rcost.begin(), rcost.end());
+        Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
+
+	for (int i = 0; i < rcost.size(); ++i) {
+	    cost[i] = long(rcost[i]*scale) + 1L;
+	}
+    }
+#endif
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.GraphProcessorMap(weight.boxArray(), cost, nprocs, nghost, period);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeTopology (const MultiFab& weight, const IntVect& nghost,
+                                   const Periodicity& period)
+{
+    DistributionMapping r;
+
+    Vector<long> cost(weight.size());
+#ifdef BL_USE_MPI
+    {
+	Vector<Real> rcost(cost.size(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+	    int i = mfi.index();
+	    rcost[i] = weight[mfi].sum(mfi.validbox(),0);
+	}
+
+	ParallelAllReduce::Sum(&rcost[0], rcost.size(), ParallelContext::CommunicatorSub());
+
+	Real wmax = *std::max_element(rcost.begin(), rcost.end());
+        Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
+
+	for (int i = 0; i < rcost.size(); ++i) {
+	    cost[i] = long(rcost[i]*scale) + 1L;
+	}
+    }
+#endif
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.TopologyProcessorMap(weight.boxArray(), cost, nprocs, nghost, period);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeIncremental (const DistributionMapping& dm,
+                                      const MultiFab&            cost,
+                                      Real                       max_imbalance,
+                                      long                       bytes_per_cell,
+                                      RebalanceInfo*             info)
+{
+    Vector<Real> rcost(cost.size(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(cost); mfi.isValid(); ++mfi) {
+        int i = mfi.index();
+        rcost[i] = cost[mfi].sum(mfi.validbox(),0);
+    }
+
+    ParallelAllReduce::Sum(&rcost[0], rcost.size(), ParallelContext::CommunicatorSub());
+
+    return makeIncremental(cost.boxArray(), dm, rcost, max_imbalance, bytes_per_cell, info);
+}
+
+DistributionMapping
+DistributionMapping::makeIncremental (const BoxArray&            ba,
+                                      const DistributionMapping& dm,
+                                      const Vector<Real>&        rcost,
+                                      Real                       max_imbalance,
+                                      long                       bytes_per_cell,
+                                      RebalanceInfo*             info)
+{
+    BL_PROFILE("DistributionMapping::makeIncremental()");
+
+    const int N = ba.size();
+    BL_ASSERT(dm.size() == N);
+    BL_ASSERT(rcost.size() == N);
+
+    const int nprocs = ParallelContext::NProcsSub();
+
+    std::vector<int>  owner(N);
+    std::vector<Real> load(nprocs, 0.0);
+    std::vector< std::vector<int> > procboxes(nprocs);
+    Real total = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        owner[i] = ParallelContext::global_to_local_rank(dm[i]);
+        load[owner[i]] += rcost[i];
+        procboxes[owner[i]].push_back(i);
+        total += rcost[i];
+    }
+
+    const Real avg    = total / nprocs;
+    const Real target = (1.0 + max_imbalance) * avg;
+
+    RebalanceInfo r;
+    r.imbalance_before = (avg > 0) ? *std::max_element(load.begin(), load.end()) / avg : 1.0;
+
+    std::vector<char> moved(N, 0);
+
+    for (int it = 0; it < N; ++it)
+    {
+        const int p = std::max_element(load.begin(), load.end()) - load.begin();
+        const int q = std::min_element(load.begin(), load.end()) - load.begin();
+        if (load[p] <= target || p == q) break;
+        //
+        // The useful part of a move is the excess it takes off p minus the
+        // excess it puts on q.  Pick the box with the most of it per byte.
+        //
+        int  best      = -1;
+        Real bestscore = 0;
+        for (int i : procboxes[p])
+        {
+            const Real w = rcost[i];
+            if (moved[i] || w <= 0 || load[q] + w >= load[p]) continue;
+
+            const Real useful = std::min(w, load[p] - target)
+                - std::max(Real(0.0), load[q] + w - target);
+            if (useful <= 0) continue;
+
+            const Real score = useful / std::max(1L, ba[i].numPts() * bytes_per_cell);
+            if (score > bestscore) {
+                best      = i;
+                bestscore = score;
+            }
+        }
+
+        if (best < 0) break;
+
+        auto& pb = procboxes[p];
+        pb.erase(std::find(pb.begin(), pb.end(), best));
+        procboxes[q].push_back(best);
+        load[p] -= rcost[best];
+        load[q] += rcost[best];
+        owner[best] = q;
+        moved[best] = 1;
+
+        ++r.nmoved;
+        r.bytes_moved += ba[best].numPts() * bytes_per_cell;
+    }
+
+    r.imbalance_after = (avg > 0) ? *std::max_element(load.begin(), load.end()) / avg : 1.0;
+
+    if (verbose) {
+        amrex::Print() << "Incremental rebalance: moving " << r.nmoved << " of " << N
+                       << " boxes, " << r.bytes_moved << " bytes, imbalance: "
+                       << r.imbalance_before << " -> " << r.imbalance_after << '\n';
+    }
+
+    if (info) *info = r;
+
+    if (r.nmoved == 0) {
+        return dm;
+    }
+
+    Vector<int> pmap(N);
+    for (int i = 0; i < N; ++i) {
+        pmap[i] = ParallelContext::local_to_global_rank(owner[i]);
+    }
+    return DistributionMapping(std::move(pmap));
+}
+
 std::vector<std::vector<int> >
 DistributionMapping::makeSFC (const BoxArray& ba, bool use_box_vol)
 {
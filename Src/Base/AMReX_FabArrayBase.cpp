@@ -1,5 +1,6 @@
 
 #include <algorithm>
+#include <limits>
 #include <AMReX_FabArrayBase.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
@@ -24,6 +25,7 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 int     FabArrayBase::MaxComp;
+bool    FabArrayBase::use_persistent_fb;
 
 #if defined(AMREX_USE_GPU) && defined(AMREX_USE_GPU_PRAGMA)
 
@@ -90,6 +92,7 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::use_persistent_fb = false;
 
     ParmParse pp("fabarray");
 
@@ -111,6 +114,7 @@ FabArrayBase::Initialize ()
     }
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
+    pp.query("use_persistent_fb",   FabArrayBase::use_persistent_fb);
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -990,8 +994,121 @@ FabArrayBase::FB::~FB ()
     delete m_LocTags;
     delete m_SndTags;
     delete m_RcvTags;
+#ifdef BL_USE_MPI
+    if (m_persistent) {
+        m_persistent->clear();
+        delete m_persistent;
+    }
+#endif
+}
+
+#ifdef BL_USE_MPI
+void
+FabArrayBase::FB::PersistentComm::clear ()
+{
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+    }
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+    }
+    if (m_the_send_data) amrex::The_FA_Arena()->free(m_the_send_data);
+    if (m_the_recv_data) amrex::The_FA_Arena()->free(m_the_recv_data);
+    m_the_send_data = nullptr;
+    m_the_recv_data = nullptr;
+    m_send_data.clear();
+    m_send_size.clear();
+    m_send_reqs.clear();
+    m_recv_data.clear();
+    m_recv_size.clear();
+    m_recv_from.clear();
+    m_recv_reqs.clear();
+    m_elem_bytes = 0;
+    m_comm = MPI_COMM_NULL;
+    m_tag = -1;
 }
 
+FabArrayBase::FB::PersistentComm*
+FabArrayBase::FB::getPersistentComm (int elem_bytes, MPI_Comm comm) const
+{
+    if (m_persistent == nullptr) {
+        m_persistent = new PersistentComm;
+    } else if (m_persistent->m_in_use) {
+        return nullptr;
+    } else if (m_persistent->m_elem_bytes == elem_bytes && m_persistent->m_comm == comm) {
+        return m_persistent;
+    }
+
+    BL_PROFILE("FabArrayBase::FB::getPersistentComm()");
+
+    PersistentComm& pc = *m_persistent;
+    pc.clear();
+    pc.m_elem_bytes = elem_bytes;
+    pc.m_comm = comm;
+    // All processes build the plan in the same FillBoundary call, so the tag
+    // matches.  It is reserved for as long as the plan lives.
+    pc.m_tag = ParallelDescriptor::PersistentSeqNum();
+
+    std::size_t total_send = 0;
+    for (auto const& kv : *m_SndTags)
+    {
+        std::size_t nbytes = 0;
+        for (auto const& cct : kv.second) {
+            nbytes += cct.sbox.numPts() * elem_bytes;
+        }
+        BL_ASSERT(nbytes > 0 && nbytes < std::numeric_limits<int>::max());
+        pc.m_send_size.push_back(static_cast<int>(nbytes));
+        total_send += nbytes;
+    }
+
+    std::size_t total_recv = 0;
+    for (auto const& kv : *m_RcvTags)
+    {
+        std::size_t nbytes = 0;
+        for (auto const& cct : kv.second) {
+            nbytes += cct.dbox.numPts() * elem_bytes;
+        }
+        BL_ASSERT(nbytes > 0 && nbytes < std::numeric_limits<int>::max());
+        pc.m_recv_size.push_back(static_cast<int>(nbytes));
+        pc.m_recv_from.push_back(kv.first);
+        total_recv += nbytes;
+    }
+
+    if (total_send > 0) {
+        pc.m_the_send_data = static_cast<char*>(amrex::The_FA_Arena()->alloc(total_send));
+    }
+    if (total_recv > 0) {
+        pc.m_the_recv_data = static_cast<char*>(amrex::The_FA_Arena()->alloc(total_recv));
+    }
+
+    char* p = pc.m_the_send_data;
+    int i = 0;
+    for (auto const& kv : *m_SndTags)
+    {
+        pc.m_send_data.push_back(p);
+        pc.m_send_reqs.push_back(MPI_REQUEST_NULL);
+        BL_MPI_REQUIRE( MPI_Send_init(p, pc.m_send_size[i], MPI_CHAR,
+                                      ParallelContext::global_to_local_rank(kv.first),
+                                      pc.m_tag, comm, &pc.m_send_reqs.back()) );
+        p += pc.m_send_size[i];
+        ++i;
+    }
+
+    p = pc.m_the_recv_data;
+    for (int k = 0, N = pc.m_recv_from.size(); k < N; ++k)
+    {
+        pc.m_recv_data.push_back(p);
+        pc.m_recv_reqs.push_back(MPI_REQUEST_NULL);
+        BL_MPI_REQUIRE( MPI_Recv_init(p, pc.m_recv_size[k], MPI_CHAR,
+                                      ParallelContext::global_to_local_rank(pc.m_recv_from[k]),
+                                      pc.m_tag, comm, &pc.m_recv_reqs.back()) );
+        p += pc.m_recv_size[k];
+    }
+
+    return m_persistent;
+}
+#endif
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -0,0 +1,292 @@
+#include <AMReX.H>
+#include <AMReX_BLassert.H>
+#include <AMReX_FabCompress.H>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace amrex {
+namespace FabCompress {
+
+namespace {
+
+    // ---- the word type with the same size as Real
+    using Word = std::conditional<sizeof(Real) == 8, std::uint64_t, std::uint32_t>::type;
+
+    enum : unsigned char { LosslessBlock = 0, QuantizedBlock = 1 };
+
+    inline Word toWord (Real x) { Word w; std::memcpy(&w, &x, sizeof(Real)); return w; }
+    inline Real toReal (Word w) { Real x; std::memcpy(&x, &w, sizeof(Real)); return x; }
+
+    template <class T>
+    void put (Vector<char>& out, const T& v)
+    {
+        const char* p = reinterpret_cast<const char*>(&v);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    template <class T>
+    T get (const char*& in)
+    {
+        T v;
+        std::memcpy(&v, in, sizeof(T));
+        in += sizeof(T);
+        return v;
+    }
+
+    //
+    // Byte-oriented run-length coding.  A control byte c < 128 is followed by
+    // c+1 literal bytes; c >= 128 is followed by one byte repeated c-125 times.
+    //
+    void rleEncode (const unsigned char* src, std::size_t n, Vector<char>& out)
+    {
+        std::size_t i = 0;
+        while (i < n) {
+            std::size_t run = 1;
+            while (i + run < n && run < 130 && src[i+run] == src[i]) { ++run; }
+            if (run >= 3) {
+                out.push_back(static_cast<char>(run + 125));
+                out.push_back(static_cast<char>(src[i]));
+                i += run;
+            } else {
+                std::size_t lit = 0;
+                // ---- extend the literal until a run of 3 starts
+                while (i + lit < n && lit < 128) {
+                    if (i + lit + 2 < n && src[i+lit] == src[i+lit+1] && src[i+lit] == src[i+lit+2]) {
+                        break;
+                    }
+                    ++lit;
+                }
+                out.push_back(static_cast<char>(lit - 1));
+                out.insert(out.end(), reinterpret_cast<const char*>(src + i),
+                           reinterpret_cast<const char*>(src + i + lit));
+                i += lit;
+            }
+        }
+    }
+
+    void rleDecode (const char* in, std::size_t nbytes, unsigned char* dst, std::size_t n)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+        const unsigned char* pend = p + nbytes;
+        std::size_t i = 0;
+        while (p < pend && i < n) {
+            unsigned c = *p++;
+            if (c < 128) {
+                std::size_t lit = c + 1;
+                BL_ASSERT(i + lit <= n);
+                std::memcpy(dst + i, p, lit);
+                p += lit;
+                i += lit;
+            } else {
+                std::size_t run = c - 125;
+                BL_ASSERT(i + run <= n);
+                std::memset(dst + i, *p++, run);
+                i += run;
+            }
+        }
+        if (i != n || p != pend) {
+            amrex::Abort("FabCompress: corrupt run-length coded block");
+        }
+    }
+
+    //
+    // Lossless: xor with the previous value, then group the bytes of equal
+    // significance so that the sign, exponent and leading mantissa bytes,
+    // which change slowly, form long runs.
+    //
+    void encodeLossless (const Real* x, long npts, Vector<char>& out)
+    {
+        const std::size_t nw = sizeof(Word);
+        Vector<unsigned char> planes(npts * nw);
+        Word prev = 0;
+        for (long i = 0; i < npts; ++i) {
+            Word w = toWord(x[i]);
+            Word d = w ^ prev;
+            prev = w;
+            for (std::size_t b = 0; b < nw; ++b) {
+                planes[b*npts + i] = static_cast<unsigned char>(d >> (8*(nw-1-b)));
+            }
+        }
+        rleEncode(planes.data(), planes.size(), out);
+    }
+
+    void decodeLossless (const char* in, std::size_t nbytes, Real* x, long npts)
+    {
+        const std::size_t nw = sizeof(Word);
+        Vector<unsigned char> planes(npts * nw);
+        rleDecode(in, nbytes, planes.data(), planes.size());
+        Word prev = 0;
+        for (long i = 0; i < npts; ++i) {
+            Word d = 0;
+            for (std::size_t b = 0; b < nw; ++b) {
+                d |= static_cast<Word>(planes[b*npts + i]) << (8*(nw-1-b));
+            }
+            prev ^= d;
+            x[i] = toReal(prev);
+        }
+    }
+
+    //
+    // Error-bounded: predict each value by the previously reconstructed one
+    // and quantize the residual with bin width 2*tol.  Each bin index is
+    // stored zigzag varint coded plus one; a zero marks a value stored exactly.
+    //
+    void putVarint (std::uint64_t v, Vector<unsigned char>& out)
+    {
+        while (v >= 0x80) {
+            out.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    std::uint64_t getVarint (const unsigned char*& p, const unsigned char* pend)
+    {
+        std::uint64_t v = 0;
+        int shift = 0;
+        while (p < pend) {
+            unsigned char c = *p++;
+            v |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+            if ((c & 0x80) == 0) return v;
+            shift += 7;
+        }
+        amrex::Abort("FabCompress: corrupt quantized block");
+        return 0;
+    }
+
+    void encodeQuantized (const Real* x, long npts, Real tol, Vector<char>& out)
+    {
+        const double width = 2.0*tol;
+        const double qmax = 4.0e18;
+        Vector<unsigned char> codes;
+        codes.reserve(npts);
+        Real prev = 0.0;
+        for (long i = 0; i < npts; ++i) {
+            const double q = std::nearbyint((static_cast<double>(x[i]) - prev) / width);
+            bool exact = true;
+            if (std::isfinite(q) && std::abs(q) < qmax) {
+                const std::int64_t iq = static_cast<std::int64_t>(q);
+                const Real r = static_cast<Real>(prev + width*iq);
+                if (std::abs(static_cast<double>(r) - x[i]) <= tol) {
+                    const std::uint64_t zz = (static_cast<std::uint64_t>(iq) << 1)
+                                           ^ static_cast<std::uint64_t>(iq >> 63);
+                    putVarint(zz + 1, codes);
+                    prev = r;
+                    exact = false;
+                }
+            }
+            if (exact) {
+                codes.push_back(0);
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(x + i);
+                codes.insert(codes.end(), p, p + sizeof(Real));
+                prev = x[i];
+            }
+        }
+        put(out, static_cast<std::uint64_t>(codes.size()));
+        rleEncode(codes.data(), codes.size(), out);
+    }
+
+    void decodeQuantized (const char* in, std::size_t nbytes, Real tol, Real* x, long npts)
+    {
+        const double width = 2.0*tol;
+        const std::uint64_t ncodes = get<std::uint64_t>(in);
+        Vector<unsigned char> codes(ncodes);
+        rleDecode(in, nbytes - sizeof(std::uint64_t), codes.data(), ncodes);
+        const unsigned char* p = codes.data();
+        const unsigned char* pend = p + ncodes;
+        Real prev = 0.0;
+        for (long i = 0; i < npts; ++i) {
+            const std::uint64_t v = getVarint(p, pend);
+            if (v == 0) {
+                if (p + sizeof(Real) > pend) {
+                    amrex::Abort("FabCompress: corrupt quantized block");
+                }
+                std::memcpy(x + i, p, sizeof(Real));
+                p += sizeof(Real);
+            } else {
+                const std::uint64_t zz = v - 1;
+                const std::int64_t iq = static_cast<std::int64_t>(zz >> 1)
+                                      ^ -static_cast<std::int64_t>(zz & 1);
+                x[i] = static_cast<Real>(prev + width*iq);
+            }
+            prev = x[i];
+        }
+    }
+
+    // ---- decode one component block starting at in; return the pointer past the block
+    const char* decodeBlock (const char* in, Real* x, long npts, bool skip)
+    {
+        const unsigned char mode = static_cast<unsigned char>(*in++);
+        Real tol = 0.0;
+        if (mode == QuantizedBlock) {
+            tol = get<Real>(in);
+        } else if (mode != LosslessBlock) {
+            amrex::Abort("FabCompress: unknown block type");
+        }
+        const std::uint64_t nbytes = get<std::uint64_t>(in);
+        if ( ! skip) {
+            if (mode == QuantizedBlock) {
+                decodeQuantized(in, nbytes, tol, x, npts);
+            } else {
+                decodeLossless(in, nbytes, x, npts);
+            }
+        }
+        return in + nbytes;
+    }
+}
+
+void
+compress (const Real* data, long npts, int ncomp, const Real* tol, Vector<char>& out)
+{
+    for (int n = 0; n < ncomp; ++n)
+    {
+        const Real* x = data + n*npts;
+        const bool lossy = tol != nullptr && tol[n] > 0.0;
+        out.push_back(static_cast<char>(lossy ? QuantizedBlock : LosslessBlock));
+        if (lossy) {
+            put(out, tol[n]);
+        }
+        // ---- reserve the block size, filled in below
+        const std::size_t size_pos = out.size();
+        put(out, std::uint64_t(0));
+        if (lossy) {
+            encodeQuantized(x, npts, tol[n], out);
+        } else {
+            encodeLossless(x, npts, out);
+        }
+        const std::uint64_t nbytes = out.size() - size_pos - sizeof(std::uint64_t);
+        std::memcpy(out.data() + size_pos, &nbytes, sizeof(std::uint64_t));
+    }
+}
+
+std::size_t
+decompress (const char* in, std::size_t nbytes, Real* data, long npts, int ncomp)
+{
+    const char* p = in;
+    for (int n = 0; n < ncomp; ++n) {
+        p = decodeBlock(p, data + n*npts, npts, false);
+    }
+    if (static_cast<std::size_t>(p - in) > nbytes) {
+        amrex::Abort("FabCompress::decompress: block extends past the end of the data");
+    }
+    return p - in;
+}
+
+void
+decompressComp (const char* in, std::size_t nbytes, Real* data, long npts, int ncomp, int icomp)
+{
+    BL_ASSERT(icomp >= 0 && icomp < ncomp);
+    const char* p = in;
+    for (int n = 0; n <= icomp; ++n) {
+        p = decodeBlock(p, data, npts, n != icomp);
+    }
+    if (static_cast<std::size_t>(p - in) > nbytes) {
+        amrex::Abort("FabCompress::decompressComp: block extends past the end of the data");
+    }
+}
+
+}
+}
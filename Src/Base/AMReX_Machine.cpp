@@ -24,6 +24,10 @@ struct DoubleInt {
 
 using Coord = Array<int, 4>;
 
+// the network model used to compute distances between nodes
+enum class Network { Flat, Dragonfly };
+Network network = Network::Flat;
+
 // returns coordinate in an index space with no switches
 // for dragonfly network
 Coord read_df_node_coord (const std::string & name)
@@ -148,14 +152,21 @@ int df_dist (const Coord & a, const Coord & b)
 
 Coord id_to_coord (int id)
 {
-    // TODO: implement support for other types of networks
-    return df_id_to_coord(id);
+    if (network == Network::Dragonfly) {
+        return df_id_to_coord(id);
+    } else {
+        return Coord {id,0,0,0};
+    }
 }
 
 int dist (const Coord & a, const Coord & b)
 {
-    // TODO: implement support for other types of networks
-    return df_dist(a, b);
+    if (network == Network::Dragonfly) {
+        return df_dist(a, b);
+    } else {
+        // one hop to the switch and one back, unless on the same node
+        return (a[0] == b[0]) ? 0 : 2;
+    }
 }
 
 struct Candidate
@@ -204,9 +215,13 @@ class Machine
     Machine () {
         get_params();
         get_machine_envs();
+        network = flag_nersc_df ? Network::Dragonfly : Network::Flat;
         node_ids = get_node_ids();
+        nbh_node_ids = get_nbh_node_ids();
     }
 
+    const Vector<int>& get_all_node_ids () const { return node_ids; }
+
     // find a compact neighborhood of size rank_n in the current ParallelContext subgroup
     Vector<int> find_best_nbh (int nbh_rank_n, bool flag_local_ranks)
     {
@@ -231,8 +246,8 @@ class Machine
             Vector<int> sg_node_ids(sg_rank_n);
             std::unordered_map<int, std::vector<int>> node_ranks;
             for (int i = 0; i < sg_rank_n; ++i) {
-                AMREX_ASSERT(sg_g_ranks[i] >= 0 && sg_g_ranks[i] < node_ids.size());
-                sg_node_ids[i] = node_ids[sg_g_ranks[i]];
+                AMREX_ASSERT(sg_g_ranks[i] >= 0 && sg_g_ranks[i] < nbh_node_ids.size());
+                sg_node_ids[i] = nbh_node_ids[sg_g_ranks[i]];
                 if (flag_local_ranks) {
                     node_ranks[sg_node_ids[i]].push_back(i);
                 } else {
@@ -311,9 +326,12 @@ class Machine
 
     int flag_verbose = 0;
     int flag_very_verbose = 0;
+    std::string topology_file;
+    int sim_ranks_per_node = 0;
     bool flag_nersc_df;
     int my_node_id;
     Vector<int> node_ids;
+    Vector<int> nbh_node_ids;
 
     NeighborhoodCache nbh_cache;
 
@@ -322,6 +340,8 @@ class Machine
         ParmParse pp("machine");
         pp.query("verbose", flag_verbose);
         pp.query("very_verbose", flag_very_verbose);
+        pp.query("topology_file", topology_file);
+        pp.query("ranks_per_node", sim_ranks_per_node);
     }
 
     std::string get_env_str (std::string env_key)
@@ -400,15 +420,69 @@ class Machine
         return result;
     }
 
+    // the lowest job rank sharing memory with this rank
+    int get_shared_node_id ()
+    {
+        int result = 0;
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+        MPI_Comm node_comm;
+        MPI_Comm_split_type(ParallelContext::CommunicatorAll(), MPI_COMM_TYPE_SHARED,
+                            ParallelDescriptor::MyProc(), MPI_INFO_NULL, &node_comm);
+        int rank_me = ParallelDescriptor::MyProc();
+        MPI_Allreduce(&rank_me, &result, 1, MPI_INT, MPI_MIN, node_comm);
+        MPI_Comm_free(&node_comm);
+#endif
+        return result;
+    }
+
+    // read the simulated topology, lines of "rank node_id", '#' starts a comment
+    Vector<int> read_topology_file ()
+    {
+        Vector<int> ids(ParallelDescriptor::NProcs(), -1);
+
+        Vector<char> file_chars;
+        ParallelDescriptor::ReadAndBcastFile(topology_file, file_chars);
+        std::istringstream is(file_chars.data());
+        for (std::string line; std::getline(is, line); ) {
+            auto pos = line.find('#');
+            if (pos != std::string::npos) {
+                line.erase(pos);
+            }
+            std::istringstream ls(line);
+            int rank, node_id;
+            if (ls >> rank >> node_id) {
+                if (rank >= 0 && rank < ids.size()) {
+                    ids[rank] = node_id;
+                }
+            }
+        }
+
+        for (int i = 0; i < ids.size(); ++i) {
+            if (ids[i] < 0) {
+                amrex::Abort("Machine: rank " + std::to_string(i) + " is missing in "
+                             + topology_file);
+            }
+        }
+        return ids;
+    }
+
     // get all node IDs in this job, indexed by job rank
     // this is collective over ALL ranks in the job
     Vector<int> get_node_ids ()
     {
         Vector<int> ids(ParallelDescriptor::NProcs(), 0);
+        if (!topology_file.empty()) {
+            ids = read_topology_file();
+        } else if (sim_ranks_per_node > 0) {
+            for (int i = 0; i < ids.size(); ++i) {
+                ids[i] = i / sim_ranks_per_node;
+            }
+        } else {
 #ifdef BL_USE_MPI
-        int node_id = get_my_node_id();
-        ParallelAllGather::AllGather(node_id, ids.data(), ParallelContext::CommunicatorAll());
+            int node_id = flag_nersc_df ? get_my_node_id() : get_shared_node_id();
+            ParallelAllGather::AllGather(node_id, ids.data(), ParallelContext::CommunicatorAll());
 #endif
+        }
         if (flag_verbose) {
             std::map<int, Vector<int>> node_ranks;
             for (int i = 0; i < ids.size(); ++i) {
@@ -423,6 +497,27 @@ class Machine
         return ids;
     }
 
+    // the node IDs used by find_best_nbh.  These are the dragonfly node IDs
+    // on Cray systems and 0 for every rank otherwise, whatever node_ids holds,
+    // so that the neighborhoods do not depend on the simulated or shared
+    // memory topology used by the TOPOLOGY distribution mapping.
+    // this is collective over ALL ranks in the job
+    Vector<int> get_nbh_node_ids ()
+    {
+        Vector<int> ids(ParallelDescriptor::NProcs(), 0);
+        if (flag_nersc_df) {
+            if (topology_file.empty() && sim_ranks_per_node <= 0) {
+                ids = node_ids;
+            } else {
+#ifdef BL_USE_MPI
+                int node_id = get_my_node_id();
+                ParallelAllGather::AllGather(node_id, ids.data(), ParallelContext::CommunicatorAll());
+#endif
+            }
+        }
+        return ids;
+    }
+
     // do a local search starting at current node
     std::pair<Vector<int>, double>
     baseline_score(const Vector<int> & sg_node_ids, int nbh_rank_n)
@@ -582,4 +677,9 @@ Vector<int> find_best_nbh (int rank_n, bool flag_local_ranks) {
     return the_machine->find_best_nbh(rank_n, flag_local_ranks);
 }
 
+const Vector<int>& node_ids () {
+    AMREX_ASSERT(the_machine);
+    return the_machine->get_all_node_ids();
+}
+
 }}
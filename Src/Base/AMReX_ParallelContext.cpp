@@ -36,6 +36,7 @@ Frame::Frame (Frame && rhs) noexcept
       m_rank_me(rhs.m_rank_me),
       m_nranks (rhs.m_nranks),
       m_mpi_tag(rhs.m_mpi_tag),
+      m_persistent_mpi_tag(rhs.m_persistent_mpi_tag),
       m_io_rank(rhs.m_io_rank),
       m_out_filename(std::move(rhs.m_out_filename)),
       m_out    (std::move(rhs.m_out))
@@ -106,11 +107,24 @@ int
 Frame::get_inc_mpi_tag ()
 {
     int cur_tag = m_mpi_tag;
-    m_mpi_tag = (m_mpi_tag < ParallelDescriptor::MaxTag()) ?
+    m_mpi_tag = (m_mpi_tag < ParallelDescriptor::MinPersistentTag()-1) ?
         m_mpi_tag + 1 : ParallelDescriptor::MinTag();
     return cur_tag;
 }
 
+int
+Frame::get_inc_persistent_mpi_tag ()
+{
+    // The first frame is made before the tag range is known.
+    if (m_persistent_mpi_tag < ParallelDescriptor::MinPersistentTag()) {
+        m_persistent_mpi_tag = ParallelDescriptor::MinPersistentTag();
+    }
+    int cur_tag = m_persistent_mpi_tag;
+    m_persistent_mpi_tag = (m_persistent_mpi_tag < ParallelDescriptor::MaxTag()) ?
+        m_persistent_mpi_tag + 1 : ParallelDescriptor::MinPersistentTag();
+    return cur_tag;
+}
+
 void
 Frame::set_ofs_name (std::string filename)
 {
@@ -56,7 +56,7 @@ namespace ParallelDescriptor
 
     MPI_Comm m_comm = MPI_COMM_NULL;    // communicator for all ranks, probably MPI_COMM_WORLD
 
-    int m_MinTag = 1000, m_MaxTag = -1;
+    int m_MinTag = 1000, m_MaxTag = -1, m_MinPersistentTag = -1;
 
     const int ioProcessor = 0;
 
@@ -317,6 +317,8 @@ ParallelDescriptor::StartParallel (int*    argc,
     if(!flag) {
         amrex::Abort("MPI_Comm_get_attr() failed to get MPI_TAG_UB");
     }
+    // MPI_TAG_UB is at least 32767
+    m_MinPersistentTag = m_MaxTag - 1023;
     BL_COMM_PROFILE_TAGRANGE(m_MinTag, m_MaxTag);
 
 #ifdef BL_USE_MPI3
@@ -1661,6 +1663,7 @@ ParallelDescriptor::StartParallel (int*    argc,
 {
     m_comm = 0;
     m_MaxTag = 9000;
+    m_MinPersistentTag = m_MaxTag - 1023;
     ParallelContext::push(m_comm);
 }
 
@@ -218,7 +218,8 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
         } else {
             data = mf[level];
         }
-	VisMF::Write(*data, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix));
+	VisMF::Write(*data, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix),
+                     VisMF::NFiles, false, VisMF::GetPlotCompression());
     }
 
 //    VisMF::SetNOutFiles(saveNFiles);
@@ -434,7 +435,8 @@ EB_WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
         MultiFab::Copy(mf_tmp, *mf[level], 0, 0, nc, 0);
         auto const& factory = dynamic_cast<EBFArrayBoxFactory const&>(mf[level]->Factory());
         MultiFab::Copy(mf_tmp, factory.getVolFrac(), 0, nc, 1, 0);
-	VisMF::Write(mf_tmp, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix));
+	VisMF::Write(mf_tmp, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix),
+                     VisMF::NFiles, false, VisMF::GetPlotCompression());
     }
 
 //    VisMF::SetNOutFiles(saveNFiles);
@@ -5,7 +5,14 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 
 #include <AMReX_TinyProfiler.H>
 #include <AMReX_ParallelDescriptor.H>
@@ -17,39 +24,471 @@
 #include <omp.h>
 #endif
 
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__PGI)
+#include <x86intrin.h>
+#define AMREX_TINY_PROFILER_USE_TSC
+#endif
+
 namespace amrex {
 
-std::vector<std::string>          TinyProfiler::regionstack;
-std::deque<std::tuple<double,double,std::string*> > TinyProfiler::ttstack;
-std::map<std::string,std::map<std::string, TinyProfiler::Stats> > TinyProfiler::statsmap;
 double TinyProfiler::t_init = std::numeric_limits<double>::max();
 
 namespace {
-    std::set<std::string> improperly_nested_timers;
+
+    using Ticks = std::int64_t;
+
+    //! Reading the clock is most of the cost of a timer, so the time
+    //! stamp counter is used where it is available.  Ticks are converted
+    //! to seconds in Finalize.
+    inline Ticks GetTicks () noexcept
+    {
+#ifdef AMREX_TINY_PROFILER_USE_TSC
+        return static_cast<Ticks>(__rdtsc());
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+            (std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    Ticks tick_init = 0;
+
+    //! All the names seen so far.  An id is the position in names.
+    struct NameTable
+    {
+        std::mutex mutex;
+        std::deque<std::string> names;
+        std::unordered_map<std::string,int> ids;
+    };
+
+    NameTable& GetNameTable ()
+    {
+        static NameTable table;
+        return table;
+    }
+
     static constexpr char mainregion[] = "main";
+    static constexpr char regionprefix[] = "REG::";
+}
+
+struct TinyProfiler::ThreadData
+{
+    struct Node
+    {
+        int name;      //!< name id, -1 for the root
+        int parent;    //!< parent node, -1 for the root
+        int lastchild; //!< the child found last, 0 if none
+        long n;        //!< number of calls
+        Ticks tin;     //!< inclusive ticks
+        Ticks tex;     //!< exclusive ticks
+    };
+
+    //! Maps the address of a name to its id without taking the lock.
+    struct CacheEntry
+    {
+        const char* key;
+        const char* name;  //!< interned
+        int id;
+    };
+    static constexpr int cache_size = 256;
+
+    std::vector<Node> nodes;  //!< nodes[0] is the root
+    TinyProfiler* top = nullptr;  //!< the call stack is linked through the running profilers
+    std::set<int> improperly_nested;
+    CacheEntry cache[cache_size];
+    std::vector<std::unique_ptr<TinyProfiler> > regions;  //!< started by StartRegion
+
+    ThreadData ()
+    {
+        nodes.push_back(Node{-1, -1, 0, 0L, 0, 0});
+        slots.assign(64, std::make_pair(std::uint64_t(0), -1));
+        shift = 64-6;
+        for (auto& e : cache) {
+            e.key = nullptr;
+            e.name = nullptr;
+            e.id = -1;
+        }
+    }
+
+    //! Returns the child of node parent with the given name, which is
+    //! added if needed.
+    int child (int parent, int name) noexcept
+    {
+        // A timer is often called repeatedly from the same place.
+        const int last = nodes[parent].lastchild;
+        if (last > 0 && nodes[last].name == name) return last;
+        return findChild(parent, name);
+    }
+
+    //! Removes the profilers above tp from the call stack.  Returns
+    //! false if tp is not in the call stack.
+    bool unwind (const TinyProfiler* tp) noexcept
+    {
+        TinyProfiler* p = top;
+        while (p && p != tp) p = p->parent;
+        if (p == nullptr) return false;
+        top = p;
+        return true;
+    }
+
+private:
+
+    //! Open addressing hash table from (parent, name) to the child node.
+    std::vector<std::pair<std::uint64_t,int> > slots;
+    int shift;
+
+    std::size_t slot (std::uint64_t key) const noexcept
+    {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+
+    int findChild (int parent, int name) noexcept
+    {
+        const std::uint64_t key = (static_cast<std::uint64_t>(parent) << 32)
+            | static_cast<std::uint32_t>(name);
+        const std::size_t mask = slots.size()-1;
+        std::size_t i = slot(key);
+        while (slots[i].second >= 0) {
+            if (slots[i].first == key) {
+                nodes[parent].lastchild = slots[i].second;
+                return slots[i].second;
+            }
+            i = (i+1) & mask;
+        }
+        const int inode = static_cast<int>(nodes.size());
+        nodes.push_back(Node{name, parent, 0, 0L, 0, 0});
+        slots[i] = std::make_pair(key, inode);
+        nodes[parent].lastchild = inode;
+        if (2*nodes.size() > slots.size()) rehash();
+        return inode;
+    }
+
+    void rehash ()
+    {
+        std::vector<std::pair<std::uint64_t,int> > old(2*slots.size(), std::make_pair(std::uint64_t(0), -1));
+        std::swap(old, slots);
+        --shift;
+        const std::size_t mask = slots.size()-1;
+        for (auto const& kv : old) {
+            if (kv.second >= 0) {
+                std::size_t i = slot(kv.first);
+                while (slots[i].second >= 0) i = (i+1) & mask;
+                slots[i] = kv;
+            }
+        }
+    }
+};
+
+namespace {
+
+    //! One per OpenMP thread, allocated in Initialize.  A thread only
+    //! touches its own entry until Finalize.
+    std::vector<std::unique_ptr<TinyProfiler::ThreadData> > threaddata;
+
+    inline TinyProfiler::ThreadData* ThisThread () noexcept
+    {
+#ifdef _OPENMP
+        const std::size_t tid = omp_get_thread_num();
+#else
+        const std::size_t tid = 0;
+#endif
+        return (tid < threaddata.size()) ? threaddata[tid].get() : nullptr;
+    }
+
+    using Node = TinyProfiler::ThreadData::Node;
+
+    //! A copy of the call tree of one thread
+    struct CallTree
+    {
+        explicit CallTree (const TinyProfiler::ThreadData& td)
+            : nodes(td.nodes), children(td.nodes.size())
+        {
+            for (int i = 1; i < static_cast<int>(nodes.size()); ++i) {
+                children[nodes[i].parent].push_back(i);
+            }
+        }
+        std::vector<Node> nodes;
+        std::vector<std::vector<int> > children;
+    };
+
+    //! Adds the children of snode in src to those of dnode in dst,
+    //! matching them by name.
+    void MergeTree (CallTree& dst, int dnode, const CallTree& src, int snode)
+    {
+        for (int sc : src.children[snode]) {
+            const Node& snd = src.nodes[sc];
+            int dc = -1;
+            for (int c : dst.children[dnode]) {
+                if (dst.nodes[c].name == snd.name) {
+                    dc = c;
+                    break;
+                }
+            }
+            if (dc < 0) {
+                dc = static_cast<int>(dst.nodes.size());
+                dst.nodes.push_back(Node{snd.name, dnode, 0, 0L, 0, 0});
+                dst.children.emplace_back();
+                dst.children[dnode].push_back(dc);
+            }
+            dst.nodes[dc].n += snd.n;
+            dst.nodes[dc].tin += snd.tin;
+            dst.nodes[dc].tex += snd.tex;
+            MergeTree(dst, dc, src, sc);
+        }
+    }
+
+    //! Adds the nodes below and including inode to stats by name.  The
+    //! inclusive time of a recursive call is only counted at the outermost
+    //! level.
+    template <class S>
+    void AddSubtree (const CallTree& tree, int inode, const std::vector<std::string>& names,
+                     double sec_per_tick, std::vector<int>& active,
+                     std::map<std::string,S>& stats)
+    {
+        const Node& nd = tree.nodes[inode];
+        S& st = stats[names[nd.name]];
+        st.n += nd.n;
+        st.dtex += nd.tex*sec_per_tick;
+        if (active[nd.name] == 0) {
+            st.dtin += nd.tin*sec_per_tick;
+        }
+        ++active[nd.name];
+        for (int c : tree.children[inode]) {
+            AddSubtree(tree, c, names, sec_per_tick, active, stats);
+        }
+        --active[nd.name];
+    }
+
+    //! Adds the outermost subtrees rooted at region regid to stats.
+    template <class S>
+    void AddRegion (const CallTree& tree, int inode, int regid, const std::vector<std::string>& names,
+                    double sec_per_tick, std::vector<int>& active,
+                    std::map<std::string,S>& stats)
+    {
+        for (int c : tree.children[inode]) {
+            if (tree.nodes[c].name == regid) {
+                AddSubtree(tree, c, names, sec_per_tick, active, stats);
+            } else {
+                AddRegion(tree, c, regid, names, sec_per_tick, active, stats);
+            }
+        }
+    }
+
+    //! The path of a node is the names from the top joined by tabs.
+    void MakePaths (const CallTree& tree, int inode, const std::string& prefix,
+                    const std::vector<std::string>& names, double sec_per_tick,
+                    Vector<std::string>& paths, std::vector<double>& vals)
+    {
+        for (int c : tree.children[inode]) {
+            const Node& nd = tree.nodes[c];
+            std::string path = prefix.empty() ? names[nd.name] : prefix + '\t' + names[nd.name];
+            vals.push_back(static_cast<double>(nd.n));
+            vals.push_back(nd.tin*sec_per_tick);
+            vals.push_back(nd.tex*sec_per_tick);
+            paths.push_back(path);
+            MakePaths(tree, c, path, names, sec_per_tick, paths, vals);
+        }
+    }
+
+    //! Merges the call trees of one thread across processes and prints
+    //! them on the I/O process.  vals holds n, dtin and dtex for each path.
+    void PrintCallTree (const Vector<std::string>& localPaths, const std::vector<double>& vals,
+                        const std::string& title, double dt_max)
+    {
+        Vector<std::string> paths;
+        bool alreadySynced;
+        amrex::SyncStrings(localPaths, paths, alreadySynced);
+        // SyncStrings does not preserve the order
+        std::sort(paths.begin(), paths.end());
+
+        if (paths.empty()) return;
+
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int ioproc = ParallelDescriptor::IOProcessorNumber();
+        const int npaths = paths.size();
+
+        std::vector<double> sendbuf(3*npaths, 0.0);
+        {
+            std::unordered_map<std::string,int> local;
+            for (int i = 0; i < localPaths.size(); ++i) {
+                local[localPaths[i]] = i;
+            }
+            for (int i = 0; i < npaths; ++i) {
+                auto it = local.find(paths[i]);
+                if (it != local.end()) {
+                    std::copy(&vals[3*it->second], &vals[3*it->second]+3, &sendbuf[3*i]);
+                }
+            }
+        }
+
+        std::vector<double> recvbuf;
+        if (nprocs == 1) {
+            recvbuf.swap(sendbuf);
+        } else {
+            if (ParallelDescriptor::IOProcessor()) recvbuf.resize(3*npaths*nprocs);
+            ParallelDescriptor::Gather(sendbuf.data(), 3*npaths, recvbuf.data(), 3*npaths, ioproc);
+        }
+
+        if (!ParallelDescriptor::IOProcessor()) return;
+
+        struct Entry
+        {
+            std::string name;
+            int depth = 0;
+            double navg = 0., dtinavg = 0., dtinmax = 0., dtexavg = 0., dtexmax = 0.;
+            std::vector<int> children;
+        };
+        std::vector<Entry> entries(npaths);
+        std::vector<int> tops;
+        std::unordered_map<std::string,int> index;
+        int maxnamelen = 0;
+        double maxncalls = 0.;
+        for (int i = 0; i < npaths; ++i) {
+            Entry& e = entries[i];
+            for (int p = 0; p < nprocs; ++p) {
+                const double* v = &recvbuf[3*(p*npaths+i)];
+                e.navg += v[0];
+                e.dtinavg += v[1];
+                e.dtinmax = std::max(e.dtinmax, v[1]);
+                e.dtexavg += v[2];
+                e.dtexmax = std::max(e.dtexmax, v[2]);
+            }
+            e.navg /= nprocs;
+            e.dtinavg /= nprocs;
+            e.dtexavg /= nprocs;
+            maxncalls = std::max(maxncalls, e.navg);
+
+            // paths are sorted, so a parent comes before its children
+            const std::size_t pos = paths[i].rfind('\t');
+            if (pos == std::string::npos) {
+                e.name = paths[i];
+                tops.push_back(i);
+            } else {
+                e.name = paths[i].substr(pos+1);
+                const int parent = index[paths[i].substr(0,pos)];
+                e.depth = entries[parent].depth + 1;
+                entries[parent].children.push_back(i);
+            }
+            index[paths[i]] = i;
+            maxnamelen = std::max(maxnamelen, int(2*e.depth + e.name.size()));
+        }
+
+        auto byincl = [&entries] (int a, int b) { return entries[a].dtinmax > entries[b].dtinmax; };
+        std::sort(tops.begin(), tops.end(), byincl);
+        for (auto& e : entries) {
+            std::sort(e.children.begin(), e.children.end(), byincl);
+        }
+
+        amrex::OutStream() << std::setfill(' ') << std::setprecision(4);
+        int wt = 9;
+        int wnc = (int) std::log10 (std::max(maxncalls,1.0)) + 1;
+        wnc = std::max(wnc, int(std::string("NCalls").size()));
+        int wp = 6;
+        maxnamelen = std::max(maxnamelen, int(title.size()));
+        const std::string hline(maxnamelen+wnc+2+(wt+2)*4+wp+2,'-');
+
+        amrex::OutStream() << "\n" << hline << "\n";
+        amrex::OutStream() << std::left
+                           << std::setw(maxnamelen) << title
+                           << std::right
+                           << std::setw(wnc+2) << "NCalls"
+                           << std::setw(wt+2) << "Incl. Avg"
+                           << std::setw(wt+2) << "Incl. Max"
+                           << std::setw(wt+2) << "Excl. Avg"
+                           << std::setw(wt+2) << "Excl. Max"
+                           << std::setw(wp+2)  << "Max %"
+                           << "\n" << hline << "\n";
+
+        std::vector<int> todo(tops.rbegin(), tops.rend());
+        while (!todo.empty())
+        {
+            const Entry& e = entries[todo.back()];
+            todo.pop_back();
+            todo.insert(todo.end(), e.children.rbegin(), e.children.rend());
+
+            amrex::OutStream() << std::setprecision(4) << std::left
+                               << std::setw(maxnamelen) << std::string(2*e.depth,' ')+e.name
+                               << std::right
+                               << std::setw(wnc+2) << static_cast<long>(e.navg)
+                               << std::setw(wt+2) << e.dtinavg
+                               << std::setw(wt+2) << e.dtinmax
+                               << std::setw(wt+2) << e.dtexavg
+                               << std::setw(wt+2) << e.dtexmax
+                               << std::setprecision(2) << std::setw(wp+1) << std::fixed
+                               << e.dtinmax*(100.0/dt_max) << "%";
+            amrex::OutStream().unsetf(std::ios_base::fixed);
+            amrex::OutStream() << "\n";
+        }
+        amrex::OutStream() << hline << "\n";
+
+        amrex::OutStream() << std::endl;
+    }
+
+    int InternName (TinyProfiler::ThreadData::CacheEntry* e, const char* name,
+                    const char*& interned) noexcept
+    {
+        int id;
+        {
+            NameTable& table = GetNameTable();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            auto r = table.ids.emplace(name, static_cast<int>(table.names.size()));
+            if (r.second) {
+                table.names.emplace_back(name);
+            }
+            id = r.first->second;
+            interned = table.names[id].c_str();
+        }
+
+        if (e) {
+            e->key = name;
+            e->name = interned;
+            e->id = id;
+        }
+        return id;
+    }
+
+    //! Returns the id of name, and its interned copy.  td may be null.
+    inline int NameId (TinyProfiler::ThreadData* td, const char* name, const char*& interned) noexcept
+    {
+        TinyProfiler::ThreadData::CacheEntry* e = nullptr;
+        if (td) {
+            const auto h = reinterpret_cast<std::uintptr_t>(name);
+            e = &(td->cache[(h ^ (h >> 8)) % TinyProfiler::ThreadData::cache_size]);
+            // The address of a name is not enough, because the name may be
+            // built at run time.
+            if (e->key == name && std::strcmp(name, e->name) == 0) {
+                interned = e->name;
+                return e->id;
+            }
+        }
+        return InternName(e, name, interned);
+    }
 }
 
 TinyProfiler::TinyProfiler (std::string funcname) noexcept
-    : fname(std::move(funcname))
+    : node(-1), tdata(ThisThread()), parent(nullptr), t0(0), tchild(0)
 {
+    fid = NameId(tdata, funcname.c_str(), fname);
     start();
 }
 
 TinyProfiler::TinyProfiler (std::string funcname, bool start_) noexcept
-    : fname(std::move(funcname))
+    : node(-1), tdata(ThisThread()), parent(nullptr), t0(0), tchild(0)
 {
+    fid = NameId(tdata, funcname.c_str(), fname);
     if (start_) start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname) noexcept
-    : fname(funcname)
+    : node(-1), tdata(ThisThread()), parent(nullptr), t0(0), tchild(0)
 {
+    fid = NameId(tdata, funcname, fname);
     start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname, bool start_) noexcept
-    : fname(funcname)
+    : node(-1), tdata(ThisThread()), parent(nullptr), t0(0), tchild(0)
 {
+    fid = NameId(tdata, funcname, fname);
     if (start_) start();
 }
 
@@ -61,85 +500,66 @@ TinyProfiler::~TinyProfiler ()
 void
 TinyProfiler::start () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
-    if (stats.empty() && !regionstack.empty())
+    // tdata is null if this was made before Initialize.
+    if (node < 0 && (tdata || (tdata = ThisThread())))
     {
-	double t = amrex::second();
-
-	ttstack.emplace_back(std::make_tuple(t, 0.0, &fname));
-	global_depth = ttstack.size();
-
 #ifdef AMREX_USE_CUDA
-	nvtx_id = nvtxRangeStartA(fname.c_str());
+        nvtx_id = nvtxRangeStartA(fname);
 #endif
-
-        for (auto const& region : regionstack)
-        {
-            Stats& st = statsmap[region][fname];
-            ++st.depth;
-            stats.push_back(&st);
-        }
+        parent = tdata->top;
+        node = tdata->child(parent ? parent->node : 0, fid);
+        tdata->top = this;
+        tchild = 0;
+        t0 = GetTicks();
     }
 }
 
 void
 TinyProfiler::stop () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
-    if (!stats.empty()) 
+    if (node >= 0)
     {
-	double t = amrex::second();
-
-	while (static_cast<int>(ttstack.size()) > global_depth) {
-	    ttstack.pop_back();
-	};
-
-	if (static_cast<int>(ttstack.size()) == global_depth)
-	{
-	    const std::tuple<double,double,std::string*>& tt = ttstack.back();
-	    
-	    // first: wall time when the pair is pushed into the stack
-	    // second: accumulated dt of children
-	    
-	    double dtin = t - std::get<0>(tt); // elapsed time since start() is called.
-	    double dtex = dtin - std::get<1>(tt);
-
-            for (Stats* st : stats)
-            {
-                --(st->depth);
-                ++(st->n);
-                if (st->depth == 0) {
-                    st->dtin += dtin;
-                }
-                st->dtex += dtex;
+        const Ticks t = GetTicks();
+        // Profilers started after this one and not yet stopped are dropped.
+        if (tdata->top == this || tdata->unwind(this))
+        {
+            const Ticks dt = t - t0;
+            auto& nd = tdata->nodes[node];
+            ++nd.n;
+            nd.tin += dt;
+            nd.tex += dt - tchild;
+            tdata->top = parent;
+            if (parent) {
+                parent->tchild += dt;
             }
-                
-	    ttstack.pop_back();
-	    if (!ttstack.empty()) {
-		std::tuple<double,double,std::string*>& parent = ttstack.back();
-		std::get<1>(parent) += dtin;
-	    }
-
+        }
+        else
+        {
+            tdata->improperly_nested.insert(fid);
+        }
+        node = -1;
 #ifdef AMREX_USE_CUDA
-	    nvtxRangeEnd(nvtx_id);
+        nvtxRangeEnd(nvtx_id);
 #endif
-	} else {
-	    improperly_nested_timers.insert(fname);
-	} 
-
-        stats.clear();
     }
 }
 
 void
 TinyProfiler::Initialize () noexcept
 {
-    regionstack.push_back(mainregion);
+    if (threaddata.empty())
+    {
+#ifdef _OPENMP
+        const int nthreads = omp_get_max_threads();
+#else
+        const int nthreads = 1;
+#endif
+        for (int i = 0; i < nthreads; ++i) {
+            threaddata.emplace_back(new ThreadData());
+        }
+    }
     t_init = amrex::second();
+    tick_init = GetTicks();
 }
 
 void
@@ -154,20 +574,33 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
       }
     }
 
+    const Ticks tick_final = GetTicks();
     double t_final = amrex::second();
+    const double sec_per_tick = (tick_final > tick_init)
+        ? (t_final - t_init) / static_cast<double>(tick_final - tick_init) : 0.0;
 
     // make a local copy so that any functions call after this will not be recorded in the local copy.
-    auto lstatsmap = statsmap;
+    std::vector<CallTree> trees;
+    std::set<int> improperly_nested_ids;
+    for (auto const& td : threaddata) {
+        trees.emplace_back(*td);
+        improperly_nested_ids.insert(td->improperly_nested.begin(), td->improperly_nested.end());
+    }
 
-    bool properly_nested = improperly_nested_timers.size() == 0;
+    std::vector<std::string> names;
+    {
+        NameTable& table = GetNameTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        names.assign(table.names.begin(), table.names.end());
+    }
+
+    bool properly_nested = improperly_nested_ids.size() == 0;
     ParallelDescriptor::ReduceBoolAnd(properly_nested);
     if (!properly_nested) {
 	Vector<std::string> local_imp, sync_imp;
 	bool synced;
-	for (std::set<std::string>::const_iterator it = improperly_nested_timers.begin();
-	     it != improperly_nested_timers.end(); ++it)
-	{
-	    local_imp.push_back(*it);
+	for (int id : improperly_nested_ids) {
+	    local_imp.push_back(names[id]);
 	}
 
 	amrex::SyncStrings(local_imp, sync_imp, synced);
@@ -200,6 +633,41 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
             << dt_min << " ... " << dt_avg << " ... " << dt_max << "\n";
     }
 
+    // The flat tables and the regions are for the call trees of all
+    // threads merged by path.  A timer started inside a parallel region
+    // is at the top of the tree of a worker thread, so its times are
+    // added up over the threads.
+    std::map<std::string,std::map<std::string, Stats> > lstatsmap;
+    if (!trees.empty())
+    {
+        CallTree tree = trees[0];
+        for (std::size_t tid = 1; tid < trees.size(); ++tid) {
+            MergeTree(tree, 0, trees[tid], 0);
+        }
+        std::vector<int> active(names.size(), 0);
+        auto& mainstats = lstatsmap[mainregion];
+        for (int c : tree.children[0]) {
+            AddSubtree(tree, c, names, sec_per_tick, active, mainstats);
+        }
+
+        std::set<int> regids;
+        const std::size_t lenprefix = std::strlen(regionprefix);
+        for (std::size_t i = 1; i < tree.nodes.size(); ++i) {
+            const std::string& name = names[tree.nodes[i].name];
+            if (name.compare(0, lenprefix, regionprefix) == 0) {
+                regids.insert(tree.nodes[i].name);
+            }
+        }
+        for (int regid : regids) {
+            AddRegion(tree, 0, regid, names, sec_per_tick, active,
+                      lstatsmap[names[regid].substr(lenprefix)]);
+        }
+    }
+    else
+    {
+        lstatsmap[mainregion];
+    }
+
     // make sure the set of regions is the same on all processes.
     {
         Vector<std::string> localRegions, syncedRegions;
@@ -228,6 +696,20 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
             amrex::Print() << "END REGION " << kv.first << "\n";
         }
     }
+
+    int nthreads = trees.size();
+    ParallelDescriptor::ReduceIntMax(nthreads);
+    for (int tid = 0; tid < nthreads; ++tid)
+    {
+        Vector<std::string> paths;
+        std::vector<double> vals;
+        if (tid < static_cast<int>(trees.size())) {
+            MakePaths(trees[tid], 0, std::string(), names, sec_per_tick, paths, vals);
+        }
+        std::string title = "Call Tree";
+        if (nthreads > 1) title += " (thread " + std::to_string(tid) + ")";
+        PrintCallTree(paths, vals, title, dt_max);
+    }
 }
 
 void
@@ -380,47 +862,53 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
 void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
-    if (std::find(regionstack.begin(), regionstack.end(), regname) == regionstack.end()) {
-        regionstack.emplace_back(std::move(regname));
+    ThreadData* td = ThisThread();
+    if (td) {
+        td->regions.emplace_back(new TinyProfiler(regionprefix+regname));
     }
 }
 
 void
 TinyProfiler::StopRegion (const std::string& regname) noexcept
 {
-    if (regname == regionstack.back()) {
-        regionstack.pop_back();
+    ThreadData* td = ThisThread();
+    if (td) {
+        const char* interned;
+        const int id = NameId(td, (regionprefix+regname).c_str(), interned);
+        if (!td->regions.empty() && td->regions.back()->fid == id) {
+            td->regions.pop_back();
+        } else {
+            td->improperly_nested.insert(id);
+        }
     }
 }
 
 TinyProfileRegion::TinyProfileRegion (std::string a_regname) noexcept
-    : regname(std::move(a_regname)),
-      tprof(std::string("REG::")+regname, false)
-{
-    TinyProfiler::StartRegion(regname);
-    tprof.start();
-}
+    : tprof(regionprefix+a_regname)
+{ }
 
 TinyProfileRegion::TinyProfileRegion (const char* a_regname) noexcept
-    : regname(a_regname),
-      tprof(std::string("REG::")+std::string(a_regname), false)
-{
-    TinyProfiler::StartRegion(a_regname);
-    tprof.start();
-}
+    : tprof(regionprefix+std::string(a_regname))
+{ }
 
 TinyProfileRegion::~TinyProfileRegion ()
 {
     tprof.stop();
-    TinyProfiler::StopRegion(regname);
 }
 
 void
 TinyProfiler::PrintCallStack (std::ostream& os)
 {
     os << "===== TinyProfilers ======\n";
-    for (auto const& x : ttstack) {
-        os << *(std::get<2>(x)) << "\n";
+    const ThreadData* td = ThisThread();
+    if (td) {
+        std::vector<const char*> labels;
+        for (const TinyProfiler* p = td->top; p; p = p->parent) {
+            labels.push_back(p->fname);
+        }
+        for (auto it = labels.crbegin(); it != labels.crend(); ++it) {
+            os << *it << "\n";
+        }
     }
 }
 
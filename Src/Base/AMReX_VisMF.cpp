@@ -6,9 +6,13 @@
 #include <cerrno>
 #include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <set>
 #include <limits>
 #include <array>
 #include <numeric>
+#include <cmath>
+#include <cstdlib>
 
 #include <AMReX_ccse-mpi.H>
 #include <AMReX_Utility.H>
@@ -17,6 +21,7 @@
 #include <AMReX_NFiles.H>
 #include <AMReX_FPC.H>
 #include <AMReX_FabArrayUtility.H>
+#include <AMReX_FabCompress.H>
 
 namespace amrex {
 
@@ -39,6 +44,7 @@ bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
 
 long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
+VisMF::Compression VisMF::plotCompression;
 
 
 //
@@ -50,6 +56,39 @@ int VisMF::nMFFileInStreams(4);
 namespace
 {
     bool initialized = false;
+
+    // ---- read one compressed fab record written by VisMF::WriteCompressed
+    void ReadCompressedRecord (std::istream& is, Vector<char>& cData)
+    {
+        std::int64_t nBytes(0);
+        is.read(reinterpret_cast<char *>(&nBytes), sizeof(std::int64_t));
+        if( ! is.good() || nBytes < 0) {
+            amrex::Error("VisMF: failed to read the size of a compressed fab");
+        }
+        cData.resize(nBytes);
+        is.read(cData.dataPtr(), nBytes);
+        if( ! is.good()) {
+            amrex::Error("VisMF: failed to read a compressed fab");
+        }
+    }
+
+    // ---- set the ghost cells of each fab to the average of its min and max
+    void SetGhostToMidRange (const FabArray<FArrayBox>& mf)
+    {
+        FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
+
+        for(MFIter mfi(*the_mf); mfi.isValid(); ++mfi) {
+            const int idx(mfi.index());
+
+            for(int j(0); j < mf.nComp(); ++j) {
+                const Real valMin(mf[mfi].min(mf.box(idx), j));
+                const Real valMax(mf[mfi].max(mf.box(idx), j));
+                const Real val((valMin + valMax) / 2.0);
+
+                the_mf->get(mfi).setComplement(val, mf.box(idx), j, 1);
+            }
+        }
+    }
 }
 
 void
@@ -87,6 +126,21 @@ VisMF::Initialize ()
     pp.query("iobuffersize", ioBufferSize);
     pp.query("allowsparsewrites", allowSparseWrites);
 
+    std::string plot_compression;
+    if(pp.query("plot_compression", plot_compression)) {
+      if(plot_compression == "none") {
+        plotCompression.codec = Compression::None;
+      } else if(plot_compression == "lossless") {
+        plotCompression.codec = Compression::Lossless;
+      } else if(plot_compression == "lossy") {
+        plotCompression.codec = Compression::Lossy;
+      } else {
+        amrex::Abort("VisMF::Initialize: vismf.plot_compression must be none, lossless or lossy");
+      }
+    }
+    pp.queryarr("plot_compression_abs_tol", plotCompression.abs_tol);
+    pp.queryarr("plot_compression_rel_tol", plotCompression.rel_tol);
+
     initialized = true;
 }
 
@@ -290,7 +344,9 @@ operator<< (std::ostream        &os,
       os << hd.m_max      << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
+    {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
       for(int i(0); i < hd.m_famin.size(); ++i) {
@@ -316,6 +372,16 @@ operator<< (std::ostream        &os,
       }
     }
 
+    if(hd.m_vers == VisMF::Header::Compressed_v1) {
+      // ---- compressed data are always native
+      os << FPC::NativeRealDescriptor() << '\n';
+      BL_ASSERT(hd.m_ctol.size() == hd.m_ncomp);
+      for(int i(0); i < hd.m_ctol.size(); ++i) {
+        os << hd.m_ctol[i] << ',';
+      }
+      os << '\n';
+    }
+
     os.flags(oflags);
     os.precision(oldPrec);
 
@@ -326,6 +392,24 @@ operator<< (std::ostream        &os,
     return os;
 }
 
+namespace {
+// ---- read one entry of a ',' terminated list of reals.  Unlike operator>>,
+// ---- this accepts the inf and nan that operator<< writes for such values.
+Real
+ReadListReal (std::istream &is, const char *what)
+{
+    std::string tok;
+    is >> std::ws;
+    std::getline(is, tok, ',');
+    char *end(nullptr);
+    const Real v(std::strtod(tok.c_str(), &end));
+    if( ! is.good() || tok.empty() || *end != '\0') {
+      amrex::Error(std::string("Expected a ',' when reading ") + what);
+    }
+    return v;
+}
+}
+
 std::istream&
 operator>> (std::istream  &is,
             VisMF::Header &hd)
@@ -376,21 +460,16 @@ operator>> (std::istream  &is,
       BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
-      char ch;
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
+    {
       hd.m_famin.resize(hd.m_ncomp);
       hd.m_famax.resize(hd.m_ncomp);
       for(int i(0); i < hd.m_famin.size(); ++i) {
-        is >> hd.m_famin[i] >> ch;
-	if( ch != ',' ) {
-	  amrex::Error("Expected a ',' when reading hd.m_famin");
-	}
+        hd.m_famin[i] = ReadListReal(is, "hd.m_famin");
       }
       for(int i(0); i < hd.m_famax.size(); ++i) {
-        is >> hd.m_famax[i] >> ch;
-	if( ch != ',' ) {
-	  amrex::Error("Expected a ',' when reading hd.m_famax");
-	}
+        hd.m_famax[i] = ReadListReal(is, "hd.m_famax");
       }
     }
     if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
@@ -399,6 +478,13 @@ operator>> (std::istream  &is,
     {
       is >> hd.m_writtenRD;
     }
+    if(hd.m_vers == VisMF::Header::Compressed_v1) {
+      is >> hd.m_writtenRD;
+      hd.m_ctol.resize(hd.m_ncomp);
+      for(int i(0); i < hd.m_ctol.size(); ++i) {
+        hd.m_ctol[i] = ReadListReal(is, "hd.m_ctol");
+      }
+    }
 
 
     if( ! is.good()) {
@@ -669,7 +755,7 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
       return;
     }
 
-    if(version == NoFabHeaderFAMinMax_v1) {
+    if(version == NoFabHeaderFAMinMax_v1 || version == Compressed_v1) {
       // ---- calculate FabArray min max values only
       m_min.clear();
       m_max.clear();
@@ -937,19 +1023,7 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     bool doConvert(*whichRD != FPC::NativeRealDescriptor());
 
     if(set_ghost) {
-        FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
-
-        for(MFIter mfi(*the_mf); mfi.isValid(); ++mfi) {
-            const int idx(mfi.index());
-
-            for(int j(0); j < mf.nComp(); ++j) {
-                const Real valMin(mf[mfi].min(mf.box(idx), j));
-                const Real valMax(mf[mfi].max(mf.box(idx), j));
-                const Real val((valMin + valMax) / 2.0);
-
-                the_mf->get(mfi).setComplement(val, mf.box(idx), j, 1);
-            }
-        }
+        SetGhostToMidRange(mf);
     }
 
     // ---- check if mf has sparse data
@@ -1090,6 +1164,122 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+long
+VisMF::Write (const FabArray<FArrayBox>& mf,
+              const std::string&         mf_name,
+              VisMF::How                 how,
+              bool                       set_ghost,
+              const Compression&         compression)
+{
+    if(compression.codec == Compression::None) {
+      return VisMF::Write(mf, mf_name, how, set_ghost);
+    }
+
+    if(set_ghost) {
+        SetGhostToMidRange(mf);
+    }
+
+    return VisMF::WriteCompressed(mf, mf_name, how, compression);
+}
+
+
+long
+VisMF::WriteCompressed (const FabArray<FArrayBox> &mf,
+                        const std::string         &mf_name,
+                        VisMF::How                 how,
+                        const Compression         &compression)
+{
+    BL_PROFILE("VisMF::WriteCompressed()");
+    BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
+
+    const int nComps(mf.nComp());
+    bool calcMinMax(false);
+    VisMF::Header hdr(mf, how, VisMF::Header::Compressed_v1, calcMinMax);
+
+    // ---- the error bound of each component, relative bounds use the FabArray range
+    hdr.m_ctol.resize(nComps, 0.0);
+    if(compression.codec == Compression::Lossy) {
+      const Vector<Real> &absTol = compression.abs_tol;
+      const Vector<Real> &relTol = compression.rel_tol;
+      for(int n(0); n < nComps; ++n) {
+        Real a(absTol.empty() ? 0.0 : absTol[std::min<int>(n, absTol.size() - 1)]);
+        const Real range(hdr.m_famax[n] - hdr.m_famin[n]);
+        // ---- a range that is not finite gives no usable relative bound
+        Real r((relTol.empty() || ! std::isfinite(range)) ? 0.0
+               : relTol[std::min<int>(n, relTol.size() - 1)] * range);
+        hdr.m_ctol[n] = (a > 0.0 && r > 0.0) ? std::min(a, r) : std::max(a, r);
+      }
+    }
+
+    // ---- compress the local fabs before taking a file, one thread per fab.
+    // ---- each record is the compressed size followed by the compressed data.
+    const Vector<int> &indexArray = mf.IndexArray();
+    const int nLocal(indexArray.size());
+    Vector<Vector<char> > cData(nLocal);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1)
+#endif
+    for(int li = 0; li < nLocal; ++li) {
+      const FArrayBox &fab = mf[indexArray[li]];
+      Vector<char> &buf = cData[li];
+      buf.resize(sizeof(std::int64_t));
+      FabCompress::compress(fab.dataPtr(), fab.box().numPts(), nComps, hdr.m_ctol.dataPtr(), buf);
+      std::int64_t nBytes(buf.size() - sizeof(std::int64_t));
+      std::memcpy(buf.dataPtr(), &nBytes, sizeof(std::int64_t));
+    }
+
+    long bytesWritten(0);
+    for(int li(0); li < nLocal; ++li) {
+      // ---- the record sizes are turned into offsets by FindOffsets
+      hdr.m_fod[indexArray[li]].m_head = cData[li].size();
+      bytesWritten += cData[li].size();
+    }
+
+    // ---- check if mf has sparse data
+    bool useSparseFPP(false);
+    const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+    std::set<int> procsWithData;
+    Vector<int> procsWithDataVector;
+    for(int i(0); i < pmap.size(); ++i) {
+      procsWithData.insert(pmap[i]);
+    }
+    if(allowSparseWrites && (static_cast<int>(procsWithData.size()) < nOutFiles)) {
+      useSparseFPP = true;
+      for(std::set<int>::iterator it = procsWithData.begin(); it != procsWithData.end(); ++it) {
+        procsWithDataVector.push_back(*it);
+      }
+    }
+
+    std::string filePrefix(mf_name + FabFileSuffix);
+
+    NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
+
+    if(useSparseFPP) {
+      nfi.SetSparseFPP(procsWithDataVector);
+    } else if(useDynamicSetSelection) {
+      nfi.SetDynamic();
+    }
+    for( ; nfi.ReadyToWrite(); ++nfi) {
+      for(int li(0); li < nLocal; ++li) {
+        nfi.Stream().write(cData[li].dataPtr(), cData[li].size());
+      }
+      nfi.Stream().flush();
+    }
+
+    int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
+    if(nfi.GetDynamic()) {
+      coordinatorProc = nfi.CoordinatorProc();
+    }
+
+    VisMF::FindOffsets(mf, filePrefix, hdr, groupSets, VisMF::Header::Compressed_v1, nfi,
+                       ParallelDescriptor::Communicator());
+
+    bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+
+    return bytesWritten;
+}
+
+
 long
 VisMF::WriteOnlyHeader (const FabArray<FArrayBox> & mf,
                         const std::string         & mf_name,
@@ -1141,8 +1331,9 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
       coordinatorProc = nfi.CoordinatorProc();
     }
 
-    if(FArrayBox::getFormat() == FABio::FAB_ASCII ||
-       FArrayBox::getFormat() == FABio::FAB_8BIT)
+    if((FArrayBox::getFormat() == FABio::FAB_ASCII ||
+        FArrayBox::getFormat() == FABio::FAB_8BIT) &&
+       whichVersion != VisMF::Header::Compressed_v1)
     {
 
 #ifdef BL_USE_MPI
@@ -1212,7 +1403,9 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
     } else {    // ---- calculate offsets
 
       RealDescriptor *whichRD = nullptr;
-      if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
+      if(FArrayBox::getFormat() == FABio::FAB_NATIVE ||
+         whichVersion == VisMF::Header::Compressed_v1)
+      {
         whichRD = FPC::NativeRealDescriptor().clone();
       } else if(FArrayBox::getFormat() == FABio::FAB_NATIVE_32) {
         whichRD = FPC::Native32RealDescriptor().clone();
@@ -1223,6 +1416,50 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
       int whichRDBytes(whichRD->numBytes());
       int nComps(mf.nComp());
 
+      // ---- compressed fabs have varying sizes, which are in m_head on the writing rank
+      Vector<long> compressedBytes;
+      if(whichVersion == VisMF::Header::Compressed_v1) {
+        compressedBytes.resize(mf.size(), 0L);
+#ifdef BL_USE_MPI
+        const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+        Vector<int> nmtags(nProcs,0);
+        Vector<int> offset(nProcs,0);
+        for(int i(0), N(mf.size()); i < N; ++i) {
+          ++nmtags[pmap[i]];
+        }
+        for(int i(1), N(offset.size()); i < N; ++i) {
+          offset[i] = offset[i-1] + nmtags[i-1];
+        }
+        Vector<long> senddata(std::max(1, nmtags[myProc]));
+        int ioffset(0);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+          senddata[ioffset++] = hdr.m_fod[mfi.index()].m_head;
+        }
+        Vector<long> recvdata(mf.size());
+        BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                    nmtags[myProc],
+                                    ParallelDescriptor::Mpi_typemap<long>::type(),
+                                    recvdata.dataPtr(),
+                                    nmtags.dataPtr(),
+                                    offset.dataPtr(),
+                                    ParallelDescriptor::Mpi_typemap<long>::type(),
+                                    coordinatorProc,
+                                    comm) );
+        if(myProc == coordinatorProc) {
+          Vector<int> cnt(nProcs,0);
+          for(int j(0), N(mf.size()); j < N; ++j) {
+            const int i(pmap[j]);
+            compressedBytes[j] = recvdata[offset[i]+cnt[i]];
+            ++cnt[i];
+          }
+        }
+#else
+        for(int j(0), N(mf.size()); j < N; ++j) {
+          compressedBytes[j] = hdr.m_fod[j].m_head;
+        }
+#endif
+      }
+
       if(myProc == coordinatorProc) {   // ---- calculate offsets
 	const BoxArray &mfBA = mf.boxArray();
 	const DistributionMapping &mfDM = mf.DistributionMap();
@@ -1279,8 +1516,12 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 	      for(int i(0); i < index.size(); ++i) {
                  hdr.m_fod[index[i]].m_name = whichFileName;
                  hdr.m_fod[index[i]].m_head = currentOffset[whichFileNumber];
-                 currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
-	                                           + fabHeaderBytes[index[i]];
+                 if(whichVersion == VisMF::Header::Compressed_v1) {
+                   currentOffset[whichFileNumber] += compressedBytes[index[i]];
+                 } else {
+                   currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
+	                                             + fabHeaderBytes[index[i]];
+                 }
               }
             }
 	  }
@@ -1375,7 +1616,17 @@ VisMF::readFAB (int                  idx,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(hdr.m_vers == Header::Version_v1) {
+    if(hdr.m_vers == Header::Compressed_v1) {
+      Vector<char> cData;
+      ReadCompressedRecord(*infs, cData);
+      if(whichComp == -1) {    // ---- read all components
+        FabCompress::decompress(cData.dataPtr(), cData.size(), fab->dataPtr(),
+                                fab->box().numPts(), hdr.m_ncomp);
+      } else {
+        FabCompress::decompressComp(cData.dataPtr(), cData.size(), fab->dataPtr(),
+                                    fab->box().numPts(), hdr.m_ncomp, whichComp);
+      }
+    } else if(hdr.m_vers == Header::Version_v1) {
       if(whichComp == -1) {    // ---- read all components
         fab->readFrom(*infs);
       } else {
@@ -1425,7 +1676,12 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    if(hdr.m_vers == Header::Compressed_v1) {
+      Vector<char> cData;
+      ReadCompressedRecord(*infs, cData);
+      FabCompress::decompress(cData.dataPtr(), cData.size(), fab.dataPtr(),
+                              fab.box().numPts(), fab.nComp());
+    } else if(NoFabHeader(hdr)) {
       if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
         infs->read((char *) fab.dataPtr(), fab.nBytes());
       } else {
@@ -2161,7 +2417,21 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
     }();
     bool doConvert = whichRD != FPC::NativeRealDescriptor();
 
-    VisMF::Header hdr(mf, VisMF::NFiles, VisMF::Header::Version_v1, true);
+    const VisMF::Header::Version version = currentVersion;
+    if (version != VisMF::Header::Version_v1 &&
+        version != VisMF::Header::NoFabHeader_v1 &&
+        version != VisMF::Header::NoFabHeaderMinMax_v1 &&
+        version != VisMF::Header::NoFabHeaderFAMinMax_v1)
+    {
+        amrex::Abort("VisMF::WriteAsync: unsupported header version " + std::to_string(version));
+    }
+    // ---- only Version_v1 has a header in front of each fab
+    const bool oldHeader = (version == VisMF::Header::Version_v1);
+    const bool fabMinMax = (version == VisMF::Header::Version_v1 ||
+                            version == VisMF::Header::NoFabHeaderMinMax_v1);
+    const bool faMinMax  = (version == VisMF::Header::NoFabHeaderFAMinMax_v1);
+
+    VisMF::Header hdr(mf, VisMF::NFiles, version, fabMinMax);
 
     const int nspots = (nprocs + (nfiles-1)) / nfiles;   // max spots per file
     const int nfull = nfiles + nprocs - nspots*nfiles;  // the first nfull files are full
@@ -2212,9 +2482,11 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
 
         const FArrayBox& fab = mf[mfi];
 
-        std::stringstream hss;
-        fio.write_header(hss, fab, ncomp);
-        total_bytes += static_cast<std::streamoff>(hss.tellp());
+        if (oldHeader) {
+            std::stringstream hss;
+            fio.write_header(hss, fab, ncomp);
+            total_bytes += static_cast<std::streamoff>(hss.tellp());
+        }
         total_bytes += fab.size() * whichRD.numBytes();
 
         // compute min and max
@@ -2300,12 +2572,14 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
     for (MFIter mfi(mf); mfi.isValid(); ++mfi)
     {
         const FArrayBox& fab = mf[mfi];
-        std::stringstream hss;
-        fio.write_header(hss, fab, ncomp);
-        int nbytes = static_cast<std::streamoff>(hss.tellp());
-        auto tstr = hss.str();
-        std::memcpy(p, tstr.c_str(), nbytes);
-        p += nbytes;
+        if (oldHeader) {
+            std::stringstream hss;
+            fio.write_header(hss, fab, ncomp);
+            int nbytes = static_cast<std::streamoff>(hss.tellp());
+            auto tstr = hss.str();
+            std::memcpy(p, tstr.c_str(), nbytes);
+            p += nbytes;
+        }
         long nreals = fab.size();
         if (doConvert) {
             ptmp = The_Pinned_Arena()->alloc(nreals*sizeof(Real));
@@ -2407,6 +2681,15 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
                 h.m_fod[k].m_head += offset[dm[k]];
             }
 
+            if (!fabMinMax) {
+                h.m_min.clear();
+                h.m_max.clear();
+            }
+            if (!faMinMax) {
+                h.m_famin.clear();
+                h.m_famax.clear();
+            }
+
             VisMF::WriteHeaderDoit(mf_name, h);
         }
 
@@ -2435,6 +2718,7 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
 
         Real t1 = amrex::second();
 
+        bool success = true;
         if (total_bytes > 0) {
             std::string file_name = amrex::Concatenate(mf_name + FabFileSuffix, ifile, 5);
             std::ofstream ofs;
@@ -2444,6 +2728,7 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
             if (!ofs.good()) amrex::FileOpenFailed(file_name);
             ofs.write(d.get(), total_bytes);
             ofs.close();
+            success = !ofs.fail();
         }
 
         Real t2 = amrex::second();
@@ -2464,6 +2749,7 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
         status.t_spin = t1-t0;
         status.t_write = t2-t1;
         status.t_send = tend-t2;
+        status.success = success;
         return status;
     },
     std::move(alldata), std::move(hdr), std::move(globaldata));
@@ -2477,7 +2763,8 @@ operator<< (std::ostream& os, const WriteAsyncStatus& status)
     os << "total bytes: " << status.nbytes << ", nspins: " << status.nspins
        << ", t_total: " << status.t_total << ", t_header: " << status.t_header
        << ", t_spin: " << status.t_spin << ", t_write: " << status.t_write
-       << ", t_send: " << status.t_send;
+       << ", t_send: " << status.t_send
+       << ", success: " << status.success;
     return os;
 }
 
@@ -7,11 +7,17 @@
 #include <AMReX_EB2_IF_Sphere.H>
 #include <AMReX_EB2_IF_Torus.H>
 #include <AMReX_EB2_IF_Spline.H>
+#include <AMReX_EB2_IF_STL.H>
 #include <AMReX_EB2_GeometryShop.H>
 #include <AMReX_EB2.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
 #include <AMReX.H>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
@@ -19,12 +25,16 @@ Vector<std::unique_ptr<IndexSpace> > IndexSpace::m_instance;
 
 int max_grid_size = 64;
 bool compare_with_ch_eb = false;
+std::string cache_dir;
+int verbose = 0;
 
 void Initialize ()
 {
     ParmParse pp("eb2");
     pp.query("max_grid_size", max_grid_size);
     pp.query("compare_with_ch_eb", compare_with_ch_eb);
+    pp.query("cache_dir", cache_dir);
+    pp.query("verbose", verbose);
 
     amrex::ExecOnFinalize(Finalize);
 }
@@ -65,6 +75,126 @@ const IndexSpace* TopIndexSpaceIfPresent() noexcept {
     return nullptr;
 }
 
+namespace {
+    void addToKey (std::ostream&) {}
+
+    template <typename T, typename... Ts>
+    void addToKey (std::ostream& os, const T& v, const Ts&... vs);
+
+    template <typename... Ts>
+    void addToKey (std::ostream& os, const RealArray& a, const Ts&... vs)
+    {
+        for (auto x : a) os << ' ' << x;
+        addToKey(os, vs...);
+    }
+
+    template <typename T, typename... Ts>
+    void addToKey (std::ostream& os, const T& v, const Ts&... vs)
+    {
+        os << ' ' << v;
+        addToKey(os, vs...);
+    }
+
+    template <typename... Ts>
+    std::string makeGeomKey (const std::string& geom_type, const Ts&... vs)
+    {
+        std::ostringstream os;
+        os.precision(17);
+        os << geom_type;
+        addToKey(os, vs...);
+        return os.str();
+    }
+}
+
+std::string
+cacheKey (const std::string& geom_key, const Geometry& geom,
+          int required_coarsening_level, int max_coarsening_level, int ngrow)
+{
+    if (cache_dir.empty() || geom_key.empty()) return std::string();
+
+    std::ostringstream os;
+    os.precision(17);
+    os << "EB2Cache-V1 " << AMREX_SPACEDIM << ' ' << sizeof(Real)
+       << ' ' << geom.Domain() << ' ' << geom.Coord();
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        os << ' ' << geom.ProbLo(idim) << ' ' << geom.ProbHi(idim)
+           << ' ' << geom.isPeriodic(idim);
+    }
+    os << ' ' << required_coarsening_level << ' ' << max_coarsening_level
+       << ' ' << ngrow << ' ' << max_grid_size << ' ' << geom_key;
+
+    std::string key = os.str();
+    std::replace(key.begin(), key.end(), '\n', ' ');
+    return key;
+}
+
+std::string
+cacheDirectory (const std::string& key)
+{
+    // 64-bit FNV-1a
+    std::uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+    return cache_dir + "/eb2_" + hex;
+}
+
+int
+readCacheHeader (const std::string& dir, const std::string& key)
+{
+    const std::string header = dir + "/Header";
+    int exists = 0;
+    if (ParallelDescriptor::IOProcessor()) {
+        exists = amrex::FileExists(header);
+    }
+    ParallelDescriptor::Bcast(&exists, 1, ParallelDescriptor::IOProcessorNumber());
+    if (!exists) return 0;
+
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(header, fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream is(fileCharPtrString, std::istringstream::in);
+
+    std::string cached_key;
+    int nlevels = 0;
+    std::getline(is, cached_key);
+    is >> nlevels;
+    if (is.fail() || cached_key != key) return 0;
+    return nlevels;
+}
+
+void
+writeCache (const std::string& dir, const std::string& key,
+            const Vector<Level const*>& levels)
+{
+    BL_PROFILE("EB2::writeCache()");
+
+    const std::string header = dir + "/Header";
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dir, 0755)) {
+            amrex::CreateDirectoryFailed(dir);
+        }
+        amrex::UnlinkFile(header);
+    }
+    ParallelDescriptor::Barrier();
+
+    for (int ilev = 0, N = levels.size(); ilev < N; ++ilev) {
+        levels[ilev]->write(dir + "/Level_" + std::to_string(ilev));
+    }
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ofstream os(header);
+        if (!os.good()) {
+            amrex::FileOpenFailed(header);
+        }
+        os << key << '\n' << levels.size() << '\n';
+    }
+    ParallelDescriptor::Barrier();
+}
+
 void
 Build (const Geometry& geom, int required_coarsening_level,
        int max_coarsening_level, int ngrow)
@@ -78,7 +208,7 @@ Build (const Geometry& geom, int required_coarsening_level,
         EB2::AllRegularIF rif;
         EB2::GeometryShop<EB2::AllRegularIF> gshop(rif);
         EB2::Build(gshop, geom, required_coarsening_level,
-                   max_coarsening_level, ngrow);
+                   max_coarsening_level, ngrow, makeGeomKey(geom_type));
     }
     else if (geom_type == "box")
     {
@@ -95,7 +225,7 @@ Build (const Geometry& geom, int required_coarsening_level,
 
         EB2::GeometryShop<EB2::BoxIF> gshop(bf);
         EB2::Build(gshop, geom, required_coarsening_level,
-                   max_coarsening_level, ngrow);
+                   max_coarsening_level, ngrow, makeGeomKey(geom_type, lo, hi, has_fluid_inside));
     }
     else if (geom_type == "cylinder")
     {
@@ -120,7 +250,7 @@ Build (const Geometry& geom, int required_coarsening_level,
 
         EB2::GeometryShop<EB2::CylinderIF> gshop(cf);
         EB2::Build(gshop, geom, required_coarsening_level,
-                   max_coarsening_level, ngrow);
+                   max_coarsening_level, ngrow, makeGeomKey(geom_type, center, radius, height, direction, has_fluid_inside));
     }
     else if (geom_type == "plane")
     {
@@ -134,7 +264,7 @@ Build (const Geometry& geom, int required_coarsening_level,
 
         EB2::GeometryShop<EB2::PlaneIF> gshop(pf);
         EB2::Build(gshop, geom, required_coarsening_level,
-                   max_coarsening_level, ngrow);
+                   max_coarsening_level, ngrow, makeGeomKey(geom_type, point, normal));
     }
     else if (geom_type == "sphere")
     {
@@ -151,7 +281,7 @@ Build (const Geometry& geom, int required_coarsening_level,
 
         EB2::GeometryShop<EB2::SphereIF> gshop(sf);
         EB2::Build(gshop, geom, required_coarsening_level,
-                   max_coarsening_level, ngrow);
+                   max_coarsening_level, ngrow, makeGeomKey(geom_type, center, radius, has_fluid_inside));
     }
     else if (geom_type == "torus")
     {
@@ -170,7 +300,35 @@ Build (const Geometry& geom, int required_coarsening_level,
 
         EB2::GeometryShop<EB2::TorusIF> gshop(sf);
         EB2::Build(gshop, geom, required_coarsening_level,
-                   max_coarsening_level, ngrow);
+                   max_coarsening_level, ngrow, makeGeomKey(geom_type, center, small_radius, large_radius));
+    }
+    else if (geom_type == "stl")
+    {
+        std::string stl_file;
+        pp.get("stl_file", stl_file);
+
+        Real scale = 1.0;
+        pp.query("stl_scale", scale);
+
+        RealArray center{AMREX_D_DECL(0.0,0.0,0.0)};
+        pp.query("stl_center", center);
+
+        bool has_fluid_inside;
+        pp.get("stl_has_fluid_inside", has_fluid_inside);
+
+        // in units of the largest cell size
+        Real band = 4.0;
+        pp.query("stl_band", band);
+        const auto dx = geom.CellSizeArray();
+        band *= *std::max_element(dx.begin(), dx.end());
+
+        EB2::STLIF sf(stl_file, scale, center, has_fluid_inside, band);
+
+        EB2::GeometryShop<EB2::STLIF> gshop(sf);
+        EB2::Build(gshop, geom, required_coarsening_level,
+                   max_coarsening_level, ngrow,
+                   makeGeomKey(geom_type, stl_file, sf.checksum(), scale, center,
+                               has_fluid_inside, sf.band()));
     }
     else
     {
@@ -0,0 +1,786 @@
+#include <AMReX_EB2_IF_STL.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+#include <AMReX_BLProfiler.H>
+#include <AMReX_Print.H>
+#include <AMReX.H>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <fstream>
+#include <limits>
+#include <cmath>
+#include <cstring>
+
+namespace amrex { namespace EB2 {
+
+namespace {
+
+constexpr int stl_leaf_size = 8;
+constexpr int stl_stack_size = 64;
+// Upper bound on the number of nodes of the inside/outside grid
+constexpr double stl_max_inside_nodes = 134217728.;  // 2^27, 16 MB of flags
+constexpr int stl_bits = 8*sizeof(unsigned long);
+
+// Reads this process's share of the triangles, 9 Reals each, in file
+// order starting with triangle number first.
+void
+readSTL (const std::string& filename, Vector<Real>& tri, long& first)
+{
+    BL_PROFILE("EB2::STLIF::readSTL()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    // The file is binary if its size matches the triangle count in the
+    // binary header; ASCII files start with "solid", but so do some
+    // binary ones.
+    long header[2] = {0, 0};  // is_binary, number of triangles
+    Vector<Real> alltri;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::ifstream is(filename, std::ios::in | std::ios::binary);
+        if (!is.good()) {
+            amrex::FileOpenFailed(filename);
+        }
+        is.seekg(0, std::ios::end);
+        const long file_size = is.tellg();
+        if (file_size >= 84) {
+            char head[84];
+            is.seekg(0, std::ios::beg);
+            is.read(head, 84);
+            std::uint32_t n;
+            std::memcpy(&n, head+80, 4);
+            if (file_size == 84 + 50*static_cast<long>(n)) {
+                header[0] = 1;
+                header[1] = n;
+            }
+        }
+
+        if (!header[0])
+        {
+            // ASCII files are parsed here and scattered below.
+            is.close();
+            std::ifstream ascii(filename);
+            std::string word;
+            while (ascii >> word) {
+                if (word == "vertex") {
+                    Real x, y, z;
+                    ascii >> x >> y >> z;
+                    alltri.push_back(x);
+                    alltri.push_back(y);
+                    alltri.push_back(z);
+                }
+            }
+            if (ascii.bad() || alltri.size() % 9 != 0) {
+                amrex::Abort("EB2::STLIF: failed to parse "+filename);
+            }
+            header[1] = alltri.size()/9;
+        }
+    }
+    ParallelDescriptor::Bcast(header, 2, ParallelDescriptor::IOProcessorNumber());
+
+    const long ntri = header[1];
+    first = (ntri * myproc) / nprocs;
+    const long last = (ntri * (myproc+1)) / nprocs;
+
+    if (header[0])
+    {
+        // Every process reads its own contiguous chunk.
+        tri.resize(9*(last-first));
+        if (last > first) {
+            std::ifstream is(filename, std::ios::in | std::ios::binary);
+            if (!is.good()) {
+                amrex::FileOpenFailed(filename);
+            }
+            is.seekg(84 + 50*first, std::ios::beg);
+            Vector<char> buf(50*(last-first));
+            is.read(buf.data(), buf.size());
+            if (!is.good()) {
+                amrex::Abort("EB2::STLIF: failed to read "+filename);
+            }
+            for (long i = 0; i < last-first; ++i) {
+                float v[9];
+                // skip the stored normal
+                std::memcpy(v, buf.data() + 50*i + 12, 36);
+                for (int m = 0; m < 9; ++m) {
+                    tri[9*i+m] = v[m];
+                }
+            }
+        }
+    }
+    else
+    {
+#ifdef BL_USE_MPI
+        if (nprocs > 1)
+        {
+            Vector<int> count(nprocs), offset(nprocs);
+            for (int i = 0; i < nprocs; ++i) {
+                offset[i] = 9*((ntri * i) / nprocs);
+                count[i] = 9*((ntri * (i+1)) / nprocs) - offset[i];
+            }
+            tri.resize(count[myproc]);
+            BL_MPI_REQUIRE( MPI_Scatterv(alltri.data(), count.data(), offset.data(),
+                                         ParallelDescriptor::Mpi_typemap<Real>::type(),
+                                         tri.data(), count[myproc],
+                                         ParallelDescriptor::Mpi_typemap<Real>::type(),
+                                         ParallelDescriptor::IOProcessorNumber(),
+                                         ParallelDescriptor::Communicator()) );
+            return;
+        }
+#endif
+        tri = std::move(alltri);
+    }
+}
+
+inline Real dot3 (const Real* a, const Real* b) noexcept
+{
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+inline void cross3 (const Real* a, const Real* b, Real* c) noexcept
+{
+    c[0] = a[1]*b[2] - a[2]*b[1];
+    c[1] = a[2]*b[0] - a[0]*b[2];
+    c[2] = a[0]*b[1] - a[1]*b[0];
+}
+
+// Closest point q on triangle (a,b,c) to p.  Returns the feature it lies
+// on: 0 face, 1-3 edges 01, 12, 20, 4-6 vertices 0, 1, 2.
+int
+closestPointOnTriangle (const Real* p, const Real* a, const Real* b, const Real* c, Real* q) noexcept
+{
+    Real ab[3], ac[3], ap[3], bp[3], cp[3];
+    for (int m = 0; m < 3; ++m) {
+        ab[m] = b[m]-a[m];
+        ac[m] = c[m]-a[m];
+        ap[m] = p[m]-a[m];
+        bp[m] = p[m]-b[m];
+        cp[m] = p[m]-c[m];
+    }
+
+    const Real d1 = dot3(ab,ap);
+    const Real d2 = dot3(ac,ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        for (int m = 0; m < 3; ++m) q[m] = a[m];
+        return 4;
+    }
+
+    const Real d3 = dot3(ab,bp);
+    const Real d4 = dot3(ac,bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        for (int m = 0; m < 3; ++m) q[m] = b[m];
+        return 5;
+    }
+
+    const Real vc = d1*d4 - d3*d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        const Real v = d1/(d1-d3);
+        for (int m = 0; m < 3; ++m) q[m] = a[m] + v*ab[m];
+        return 1;
+    }
+
+    const Real d5 = dot3(ab,cp);
+    const Real d6 = dot3(ac,cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        for (int m = 0; m < 3; ++m) q[m] = c[m];
+        return 6;
+    }
+
+    const Real vb = d5*d2 - d1*d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        const Real w = d2/(d2-d6);
+        for (int m = 0; m < 3; ++m) q[m] = a[m] + w*ac[m];
+        return 3;
+    }
+
+    const Real va = d3*d6 - d5*d4;
+    if (va <= 0.0 && (d4-d3) >= 0.0 && (d5-d6) >= 0.0) {
+        const Real w = (d4-d3)/((d4-d3)+(d5-d6));
+        for (int m = 0; m < 3; ++m) q[m] = b[m] + w*(c[m]-b[m]);
+        return 2;
+    }
+
+    const Real denom = 1.0/(va+vb+vc);
+    const Real v = vb*denom;
+    const Real w = vc*denom;
+    for (int m = 0; m < 3; ++m) q[m] = a[m] + ab[m]*v + ac[m]*w;
+    return 0;
+}
+
+inline Real boxDist2 (const Real* p, const Real* lo, const Real* hi) noexcept
+{
+    Real d2 = 0.0;
+    for (int m = 0; m < 3; ++m) {
+        const Real d = std::max(std::max(lo[m]-p[m], p[m]-hi[m]), Real(0.0));
+        d2 += d*d;
+    }
+    return d2;
+}
+
+void
+buildTree (STLIF::Tree& tree, Vector<Real>& tri)
+{
+    BL_PROFILE("EB2::STLIF::buildTree()");
+
+    const int ntri = tri.size()/9;
+    Vector<Real> centroid(3*ntri);
+    for (int i = 0; i < ntri; ++i) {
+        for (int m = 0; m < 3; ++m) {
+            centroid[3*i+m] = (tri[9*i+m] + tri[9*i+3+m] + tri[9*i+6+m]) * (1./3.);
+        }
+    }
+
+    Vector<int> perm(ntri);
+    std::iota(perm.begin(), perm.end(), 0);
+
+    // Split at the median of the centroids along the longest side of
+    // their bounding box, until there are at most stl_leaf_size triangles.
+    tree.nodes.reserve(2*(ntri/stl_leaf_size+1));
+    std::function<int(int,int)> build = [&] (int first, int last) -> int
+    {
+        const int inode = tree.nodes.size();
+        tree.nodes.emplace_back();
+        STLIF::Tree::Node node;
+        Real clo[3], chi[3];
+        for (int m = 0; m < 3; ++m) {
+            node.lo[m] = clo[m] = std::numeric_limits<Real>::max();
+            node.hi[m] = chi[m] = std::numeric_limits<Real>::lowest();
+        }
+        for (int i = first; i < last; ++i) {
+            const int t = perm[i];
+            for (int m = 0; m < 3; ++m) {
+                for (int v = 0; v < 3; ++v) {
+                    node.lo[m] = std::min(node.lo[m], tri[9*t+3*v+m]);
+                    node.hi[m] = std::max(node.hi[m], tri[9*t+3*v+m]);
+                }
+                clo[m] = std::min(clo[m], centroid[3*t+m]);
+                chi[m] = std::max(chi[m], centroid[3*t+m]);
+            }
+        }
+        node.first = first;
+        node.last = last;
+        node.left = node.right = -1;
+        if (last - first > stl_leaf_size) {
+            int dir = 0;
+            for (int m = 1; m < 3; ++m) {
+                if (chi[m]-clo[m] > chi[dir]-clo[dir]) dir = m;
+            }
+            const int mid = first + (last-first)/2;
+            std::nth_element(perm.begin()+first, perm.begin()+mid, perm.begin()+last,
+                             [&] (int a, int b) {
+                                 return centroid[3*a+dir] < centroid[3*b+dir]
+                                     || (centroid[3*a+dir] == centroid[3*b+dir] && a < b);
+                             });
+            node.left = build(first, mid);
+            node.right = build(mid, last);
+        }
+        tree.nodes[inode] = node;
+        return inode;
+    };
+    if (ntri > 0) build(0, ntri);
+
+    tree.ntri = ntri;
+    tree.vert.resize(9*ntri);
+    for (int i = 0; i < ntri; ++i) {
+        std::copy(tri.begin()+9*perm[i], tri.begin()+9*perm[i]+9, tree.vert.begin()+9*i);
+    }
+}
+
+// Face, edge and vertex pseudonormals.  Vertices are welded by exact
+// coordinates.
+void
+buildNormals (STLIF::Tree& tree)
+{
+    BL_PROFILE("EB2::STLIF::buildNormals()");
+
+    const int ntri = tree.ntri;
+    const Real* vert = tree.vert.data();
+
+    tree.facenorm.resize(3*ntri);
+    for (int t = 0; t < ntri; ++t) {
+        const Real* a = vert + 9*t;
+        Real ab[3], ac[3], n[3];
+        for (int m = 0; m < 3; ++m) {
+            ab[m] = a[3+m]-a[m];
+            ac[m] = a[6+m]-a[m];
+        }
+        cross3(ab, ac, n);
+        const Real nn = std::sqrt(dot3(n,n));
+        for (int m = 0; m < 3; ++m) tree.facenorm[3*t+m] = n[m]/nn;
+    }
+
+    Vector<int> order(3*ntri);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [=] (int a, int b) {
+        return std::lexicographical_compare(vert+3*a, vert+3*a+3, vert+3*b, vert+3*b+3);
+    });
+    tree.vertid.resize(3*ntri);
+    int nvert = 0;
+    for (int i = 0; i < 3*ntri; ++i) {
+        if (i > 0 && !std::equal(vert+3*order[i], vert+3*order[i]+3, vert+3*order[i-1])) {
+            ++nvert;
+        }
+        tree.vertid[order[i]] = nvert;
+    }
+    if (ntri > 0) ++nvert;
+
+    tree.vertnorm.assign(3*nvert, 0.0);
+    for (int t = 0; t < ntri; ++t) {
+        for (int v = 0; v < 3; ++v) {
+            const Real* p0 = vert + 9*t + 3*v;
+            const Real* p1 = vert + 9*t + 3*((v+1)%3);
+            const Real* p2 = vert + 9*t + 3*((v+2)%3);
+            Real e1[3], e2[3];
+            for (int m = 0; m < 3; ++m) {
+                e1[m] = p1[m]-p0[m];
+                e2[m] = p2[m]-p0[m];
+            }
+            Real c = dot3(e1,e2) / std::sqrt(dot3(e1,e1)*dot3(e2,e2));
+            const Real angle = std::acos(std::max(Real(-1.0),std::min(Real(1.0),c)));
+            Real* vn = &tree.vertnorm[3*tree.vertid[3*t+v]];
+            for (int m = 0; m < 3; ++m) vn[m] += angle*tree.facenorm[3*t+m];
+        }
+    }
+
+    auto edge_key = [&] (int i) -> std::pair<int,int> {
+        const int t = i/3, e = i%3;
+        const int v0 = tree.vertid[3*t+e];
+        const int v1 = tree.vertid[3*t+(e+1)%3];
+        return std::make_pair(std::min(v0,v1), std::max(v0,v1));
+    };
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&] (int a, int b) {
+        return edge_key(a) < edge_key(b);
+    });
+    tree.edgeid.resize(3*ntri);
+    int nedge = 0;
+    for (int i = 0; i < 3*ntri; ++i) {
+        if (i > 0 && edge_key(order[i]) != edge_key(order[i-1])) {
+            ++nedge;
+        }
+        tree.edgeid[order[i]] = nedge;
+    }
+    if (ntri > 0) ++nedge;
+
+    tree.edgenorm.assign(3*nedge, 0.0);
+    for (int i = 0; i < 3*ntri; ++i) {
+        Real* en = &tree.edgenorm[3*tree.edgeid[i]];
+        for (int m = 0; m < 3; ++m) en[m] += tree.facenorm[3*(i/3)+m];
+    }
+}
+
+// Twice the signed area of (a,b,p) projected on the yz-plane.  The end
+// points are put in a fixed order first, so that the two triangles that
+// share an edge get exactly opposite values.
+inline Real edgeFunction (const Real* a, const Real* b, Real py, Real pz) noexcept
+{
+    if (a[1] < b[1] || (a[1] == b[1] && a[2] < b[2])) {
+        return (b[1]-a[1])*(pz-a[2]) - (b[2]-a[2])*(py-a[1]);
+    } else {
+        return -((a[1]-b[1])*(pz-b[2]) - (a[2]-b[2])*(py-b[1]));
+    }
+}
+
+// Is p, on the edge a->b of a counterclockwise triangle, inside it?  The
+// top-left rule of rasterizers: each point of a projected surface is then
+// covered by exactly one triangle.
+inline bool ownsEdge (const Real* a, const Real* b) noexcept
+{
+    return b[2] < a[2] || (b[2] == a[2] && b[1] < a[1]);
+}
+
+// The inside/outside flags are the parities of the number of crossings of
+// rays in the +x direction from the nodes.  Each process counts the
+// crossings of its own triangles; a crossing at x flips the nodes of the
+// line below x.
+void
+buildInsideGrid (STLIF::Data& data)
+{
+    BL_PROFILE("EB2::STLIF::buildInsideGrid()");
+
+    // The nearest node of a point within the bounding box is closer than
+    // sqrt(3)/2*h, so with h <= band it is on the side of a point that
+    // has no surface within band.
+    Real h = data.band;
+    auto nnodes = [&] (int m) -> int {
+        return static_cast<int>(std::floor((data.hi[m]-data.lo[m])/h)) + 2;
+    };
+    while (double(data.hi[0]-data.lo[0]+2*h) * double(data.hi[1]-data.lo[1]+2*h)
+           * double(data.hi[2]-data.lo[2]+2*h) / (double(h)*h*h) > stl_max_inside_nodes) {
+        h *= 1.25;
+    }
+    data.h = h;
+    data.band = std::max(data.band, h);
+    for (int m = 0; m < 3; ++m) data.n[m] = nnodes(m);
+
+    const int nx = data.n[0];
+    const long nbits = long(nx)*data.n[1]*data.n[2];
+    Vector<unsigned long>& bits = data.inside;
+    bits.assign((nbits+stl_bits-1)/stl_bits, 0UL);
+
+    const long nchunk = data.chunk.size()/9;
+    for (long t = 0; t < nchunk; ++t)
+    {
+        const Real* a = &data.chunk[9*t];
+        const Real* b = a+3;
+        const Real* c = a+6;
+        const Real area = (b[1]-a[1])*(c[2]-a[2]) - (b[2]-a[2])*(c[1]-a[1]);
+        if (area == 0.0) continue;  // parallel to the rays
+        if (area < 0.0) std::swap(b,c);
+
+        const Real ylo = std::min(a[1],std::min(b[1],c[1]));
+        const Real yhi = std::max(a[1],std::max(b[1],c[1]));
+        const Real zlo = std::min(a[2],std::min(b[2],c[2]));
+        const Real zhi = std::max(a[2],std::max(b[2],c[2]));
+        const int jlo = std::max(0,           static_cast<int>(std::floor((ylo-data.lo[1])/h)));
+        const int jhi = std::min(data.n[1]-1, static_cast<int>(std::ceil ((yhi-data.lo[1])/h)));
+        const int klo = std::max(0,           static_cast<int>(std::floor((zlo-data.lo[2])/h)));
+        const int khi = std::min(data.n[2]-1, static_cast<int>(std::ceil ((zhi-data.lo[2])/h)));
+
+        for (int k = klo; k <= khi; ++k) {
+            const Real pz = data.lo[2] + k*h;
+            for (int j = jlo; j <= jhi; ++j) {
+                const Real py = data.lo[1] + j*h;
+                const Real e0 = edgeFunction(a, b, py, pz);
+                const Real e1 = edgeFunction(b, c, py, pz);
+                const Real e2 = edgeFunction(c, a, py, pz);
+                if ((e0 > 0.0 || (e0 == 0.0 && ownsEdge(a,b))) &&
+                    (e1 > 0.0 || (e1 == 0.0 && ownsEdge(b,c))) &&
+                    (e2 > 0.0 || (e2 == 0.0 && ownsEdge(c,a))))
+                {
+                    const Real x = (e1*a[0] + e2*b[0] + e0*c[0]) / (e0+e1+e2);
+                    // number of nodes of the line with x_i < x
+                    const int i0 = std::min(nx, std::max(0,
+                        static_cast<int>(std::ceil((x-data.lo[0])/h))));
+                    if (i0 > 0) {
+                        const long ib = (i0-1) + nx*(j + long(data.n[1])*k);
+                        bits[ib/stl_bits] ^= 1UL << (ib%stl_bits);
+                    }
+                }
+            }
+        }
+    }
+
+#ifdef BL_USE_MPI
+    if (ParallelDescriptor::NProcs() > 1) {
+        BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, bits.data(), bits.size(),
+                                      ParallelDescriptor::Mpi_typemap<unsigned long>::type(),
+                                      MPI_BXOR, ParallelDescriptor::Communicator()) );
+    }
+#endif
+
+    // Node i is flipped by the marks at i and above.
+    for (long line = 0, nline = long(data.n[1])*data.n[2]; line < nline; ++line) {
+        unsigned long cur = 0;
+        for (long ib = nx*line + nx-1; ib >= nx*line; --ib) {
+            cur ^= (bits[ib/stl_bits] >> (ib%stl_bits)) & 1UL;
+            bits[ib/stl_bits] = (bits[ib/stl_bits] & ~(1UL << (ib%stl_bits)))
+                |                cur << (ib%stl_bits);
+        }
+    }
+}
+
+}
+
+STLIF::STLIF (const std::string& a_filename, Real a_scale, const RealArray& a_center,
+              bool a_has_fluid_inside, Real a_band)
+    : m_data(std::make_shared<Data>()),
+      m_sign(a_has_fluid_inside ? -1.0 : 1.0)
+{
+    BL_PROFILE("EB2::STLIF::STLIF()");
+
+    if (a_band <= 0.0) {
+        amrex::Abort("EB2::STLIF: band must be positive");
+    }
+
+    Data& data = *m_data;
+    Vector<Real>& tri = data.chunk;
+    long first = 0;
+    readSTL(a_filename, tri, first);
+
+    // Sum of the 64-bit FNV-1a of each triangle as read and its number,
+    // so that it does not depend on how the file is split.
+    std::uint64_t checksum = 0;
+    for (long t = 0, N = tri.size()/9; t < N; ++t) {
+        std::uint64_t h = 14695981039346656037ULL;
+        const long number = first + t;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&number);
+        for (std::size_t i = 0; i < sizeof(long); ++i) {
+            h ^= bytes[i];
+            h *= 1099511628211ULL;
+        }
+        bytes = reinterpret_cast<const unsigned char*>(&tri[9*t]);
+        for (std::size_t i = 0; i < 9*sizeof(Real); ++i) {
+            h ^= bytes[i];
+            h *= 1099511628211ULL;
+        }
+        checksum += h;
+    }
+
+    Real center[3] = {0.0, 0.0, 0.0};
+    for (int m = 0; m < AMREX_SPACEDIM; ++m) center[m] = a_center[m];
+
+    // Transform, and drop degenerate triangles, which have no normal.
+    long ntri = 0;
+    for (long t = 0, N = tri.size()/9; t < N; ++t) {
+        Real* a = &tri[9*t];
+        for (int v = 0; v < 3; ++v) {
+            for (int m = 0; m < 3; ++m) {
+                a[3*v+m] = a_scale*a[3*v+m] + center[m];
+            }
+        }
+        Real ab[3], ac[3], n[3];
+        for (int m = 0; m < 3; ++m) {
+            ab[m] = a[3+m]-a[m];
+            ac[m] = a[6+m]-a[m];
+        }
+        cross3(ab, ac, n);
+        if (dot3(n,n) > 0.0) {
+            std::copy(a, a+9, &tri[9*ntri]);
+            ++ntri;
+        }
+    }
+    tri.resize(9*ntri);
+
+    for (int m = 0; m < 3; ++m) {
+        data.lo[m] = std::numeric_limits<Real>::max();
+        data.hi[m] = std::numeric_limits<Real>::lowest();
+    }
+    for (long i = 0, N = tri.size()/3; i < N; ++i) {
+        for (int m = 0; m < 3; ++m) {
+            data.lo[m] = std::min(data.lo[m], tri[3*i+m]);
+            data.hi[m] = std::max(data.hi[m], tri[3*i+m]);
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(ntri);
+    ParallelDescriptor::ReduceRealMin(data.lo, 3);
+    ParallelDescriptor::ReduceRealMax(data.hi, 3);
+#ifdef BL_USE_MPI
+    if (ParallelDescriptor::NProcs() > 1) {
+        BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, &checksum, 1, MPI_UINT64_T, MPI_SUM,
+                                      ParallelDescriptor::Communicator()) );
+    }
+#endif
+
+    if (ntri == 0) {
+        amrex::Abort("EB2::STLIF: no triangles in "+a_filename);
+    }
+
+    data.ntri = ntri;
+    data.checksum = checksum;
+    data.band = a_band;
+
+    buildInsideGrid(data);
+}
+
+void
+STLIF::prepare (const BoxArray& ba, const DistributionMapping& dm,
+                const Geometry& geom, int ngrow) const
+{
+    BL_PROFILE("EB2::STLIF::prepare()");
+
+    Data& data = *m_data;
+    const int nprocs = ParallelDescriptor::NProcs();
+    const Real band = data.band;
+    const auto problo = geom.ProbLoArray();
+    const auto dxinv = geom.InvCellSizeArray();
+
+    // The cell holding x, clamped so that far away triangles do not
+    // overflow an int.
+    const Real big = 0.25*std::numeric_limits<int>::max();
+    auto cell = [&] (Real x, int m) -> int {
+        const Real i = std::floor((x-problo[m])*dxinv[m]);
+        return static_cast<int>(std::max(-big, std::min(big, i)));
+    };
+
+    // Each triangle goes to the owners of the boxes whose nodes, grown by
+    // ngrow cells, come within band of it.  One more cell covers the upper
+    // nodes and round-off.
+    Vector<Vector<Real> > sendbuf(nprocs);
+    std::vector<std::pair<int,Box> > isects;
+    Vector<int> procs;
+    for (long t = 0, N = data.chunk.size()/9; t < N; ++t)
+    {
+        const Real* v = &data.chunk[9*t];
+        Real tlo[3], thi[3];
+        for (int m = 0; m < 3; ++m) {
+            tlo[m] = std::min(v[m],std::min(v[3+m],v[6+m]));
+            thi[m] = std::max(v[m],std::max(v[3+m],v[6+m]));
+        }
+#if (AMREX_SPACEDIM == 2)
+        // the function is evaluated at z = 0
+        if (tlo[2] > band || thi[2] < -band) continue;
+#endif
+        IntVect lo, hi;
+        for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+            lo[m] = cell(tlo[m]-band, m) - (ngrow+1);
+            hi[m] = cell(thi[m]+band, m) + (ngrow+1);
+        }
+        ba.intersections(Box(lo,hi), isects);
+        procs.clear();
+        for (const auto& is : isects) {
+            procs.push_back(dm[is.first]);
+        }
+        std::sort(procs.begin(), procs.end());
+        procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+        for (int p : procs) {
+            sendbuf[p].insert(sendbuf[p].end(), v, v+9);
+        }
+    }
+
+    Vector<Real> tri;
+#ifdef BL_USE_MPI
+    if (nprocs > 1)
+    {
+        MPI_Comm comm = ParallelDescriptor::Communicator();
+        const MPI_Datatype mpi_real = ParallelDescriptor::Mpi_typemap<Real>::type();
+
+        Vector<int> sendcnt(nprocs), recvcnt(nprocs), sendoff(nprocs), recvoff(nprocs);
+        for (int i = 0; i < nprocs; ++i) {
+            sendcnt[i] = sendbuf[i].size();
+        }
+        BL_MPI_REQUIRE( MPI_Alltoall(sendcnt.data(), 1, MPI_INT,
+                                     recvcnt.data(), 1, MPI_INT, comm) );
+
+        Vector<Real> send;
+        for (int i = 0; i < nprocs; ++i) {
+            sendoff[i] = send.size();
+            send.insert(send.end(), sendbuf[i].begin(), sendbuf[i].end());
+            Vector<Real>().swap(sendbuf[i]);
+        }
+        int nrecv = 0;
+        for (int i = 0; i < nprocs; ++i) {
+            recvoff[i] = nrecv;
+            nrecv += recvcnt[i];
+        }
+        tri.resize(nrecv);
+        BL_MPI_REQUIRE( MPI_Alltoallv(send.data(), sendcnt.data(), sendoff.data(), mpi_real,
+                                      tri.data(), recvcnt.data(), recvoff.data(), mpi_real,
+                                      comm) );
+    }
+    else
+#endif
+    {
+        tri = std::move(sendbuf[0]);
+    }
+
+    Tree tree;
+    buildTree(tree, tri);
+    buildNormals(tree);
+    data.tree = std::move(tree);
+    data.prepared = true;
+}
+
+RealArray
+STLIF::lowerBound () const noexcept
+{
+    RealArray r;
+    for (int m = 0; m < AMREX_SPACEDIM; ++m) r[m] = m_data->lo[m];
+    return r;
+}
+
+RealArray
+STLIF::upperBound () const noexcept
+{
+    RealArray r;
+    for (int m = 0; m < AMREX_SPACEDIM; ++m) r[m] = m_data->hi[m];
+    return r;
+}
+
+Real
+STLIF::operator() (const RealArray& a_p) const noexcept
+{
+    const Data& data = *m_data;
+    if (!data.prepared) {
+        amrex::Abort("EB2::STLIF: prepare() must be called before the function is evaluated");
+    }
+
+    const Tree& tree = data.tree;
+    const Real p[3] = {AMREX_D_DECL(a_p[0], a_p[1], a_p[2])};
+
+    // Only triangles within band are looked at.
+    Real dist2 = data.band*data.band;
+    Real q[3] = {0.0, 0.0, 0.0};
+    int tmin = -1, fmin = 0;
+
+    int stack[stl_stack_size];
+    int nstack = 0;
+    if (tree.ntri > 0) stack[nstack++] = 0;
+    while (nstack > 0)
+    {
+        const Tree::Node& node = tree.nodes[stack[--nstack]];
+        if (boxDist2(p, node.lo, node.hi) >= dist2) continue;
+
+        if (node.left < 0) {
+            for (int t = node.first; t < node.last; ++t) {
+                const Real* v = &tree.vert[9*t];
+                Real qt[3];
+                const int f = closestPointOnTriangle(p, v, v+3, v+6, qt);
+                const Real d2 = (p[0]-qt[0])*(p[0]-qt[0])
+                    +           (p[1]-qt[1])*(p[1]-qt[1])
+                    +           (p[2]-qt[2])*(p[2]-qt[2]);
+                if (d2 < dist2) {
+                    dist2 = d2;
+                    tmin = t;
+                    fmin = f;
+                    q[0] = qt[0];
+                    q[1] = qt[1];
+                    q[2] = qt[2];
+                }
+            }
+        } else {
+            // Push the farther child first so the nearer one is visited
+            // next and tightens the bound early.
+            const Tree::Node& l = tree.nodes[node.left];
+            const Tree::Node& r = tree.nodes[node.right];
+            const Real dl = boxDist2(p, l.lo, l.hi);
+            const Real dr = boxDist2(p, r.lo, r.hi);
+            AMREX_ASSERT(nstack+2 <= stl_stack_size);
+            if (dl <= dr) {
+                stack[nstack++] = node.right;
+                stack[nstack++] = node.left;
+            } else {
+                stack[nstack++] = node.left;
+                stack[nstack++] = node.right;
+            }
+        }
+    }
+
+    if (tmin < 0)
+    {
+        // No surface within band: the segment to the nearest node of the
+        // inside/outside grid does not cross it.
+        bool inside = false;
+        if (p[0] >= data.lo[0] && p[0] <= data.hi[0] &&
+            p[1] >= data.lo[1] && p[1] <= data.hi[1] &&
+            p[2] >= data.lo[2] && p[2] <= data.hi[2])
+        {
+            long ib = 0;
+            for (int m = 2; m >= 0; --m) {
+                const int i = std::min(data.n[m]-1, static_cast<int>(std::floor((p[m]-data.lo[m])/data.h + 0.5)));
+                ib = ib*data.n[m] + i;
+            }
+            inside = (data.inside[ib/stl_bits] >> (ib%stl_bits)) & 1UL;
+        }
+        return inside ? m_sign*data.band : -m_sign*data.band;
+    }
+
+    if (dist2 == 0.0) return 0.0;
+
+    const Real* n;
+    if (fmin == 0) {
+        n = &tree.facenorm[3*tmin];
+    } else if (fmin <= 3) {
+        n = &tree.edgenorm[3*tree.edgeid[3*tmin+fmin-1]];
+    } else {
+        n = &tree.vertnorm[3*tree.vertid[3*tmin+fmin-4]];
+    }
+    const Real pq[3] = {p[0]-q[0], p[1]-q[1], p[2]-q[2]};
+    const Real d = std::sqrt(dist2);
+    return (dot3(pq,n) > 0.0) ? -m_sign*d : m_sign*d;
+}
+
+}}
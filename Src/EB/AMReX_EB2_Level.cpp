@@ -1,7 +1,10 @@
 
 #include <AMReX_EB2_Level.H>
 #include <AMReX_IArrayBox.H>
+#include <AMReX_Utility.H>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
@@ -670,4 +673,142 @@ Level::fillLevelSet (MultiFab& levelset, const Geometry& geom) const
     }
 }
         
+void
+Level::write (const std::string& dir) const
+{
+    BL_PROFILE("EB2::Level::write()");
+
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dir, 0755)) {
+            amrex::CreateDirectoryFailed(dir);
+        }
+
+        std::ofstream os(dir+"/Header");
+        if (!os.good()) {
+            amrex::FileOpenFailed(dir+"/Header");
+        }
+        os << m_allregular << '\n' << m_ngrow << '\n';
+        // BoxArray::readFrom cannot read an empty BoxArray back
+        os << m_grids.size() << '\n';
+        if (!m_grids.empty()) {
+            m_grids.writeOn(os);
+            os << '\n';
+        }
+        os << m_covered_grids.size() << '\n';
+        if (!m_covered_grids.empty()) {
+            m_covered_grids.writeOn(os);
+            os << '\n';
+        }
+        os << m_levelset.nGrow() << '\n';
+    }
+    ParallelDescriptor::Barrier();
+
+    if (m_grids.empty()) return;
+
+    VisMF::Write(m_levelset, dir+"/LevelSet");
+
+    // The 32-bit cell flags are split into two 16-bit halves so that
+    // they are stored exactly in single precision too.
+    MultiFab flag(m_grids, m_dmap, 2, m_cellflag.nGrow());
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(flag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        auto const& src = m_cellflag.array(mfi);
+        auto const& dst = flag.array(mfi);
+        AMREX_HOST_DEVICE_FOR_3D (bx, i, j, k,
+        {
+            const uint32_t v = src(i,j,k).getValue();
+            dst(i,j,k,0) = static_cast<Real>(v & 0xffffu);
+            dst(i,j,k,1) = static_cast<Real>(v >> 16);
+        });
+    }
+    VisMF::Write(flag, dir+"/CellFlag");
+
+    VisMF::Write(m_volfrac, dir+"/VolFrac");
+    VisMF::Write(m_centroid, dir+"/Centroid");
+    VisMF::Write(m_bndryarea, dir+"/BndryArea");
+    VisMF::Write(m_bndrycent, dir+"/BndryCent");
+    VisMF::Write(m_bndrynorm, dir+"/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        VisMF::Write(m_areafrac[idim], dir+"/AreaFrac_"+std::to_string(idim));
+        VisMF::Write(m_facecent[idim], dir+"/FaceCent_"+std::to_string(idim));
+    }
+}
+
+void
+Level::read (const std::string& dir)
+{
+    BL_PROFILE("EB2::Level::read()");
+
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(dir+"/Header", fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream is(fileCharPtrString, std::istringstream::in);
+
+    int nboxes, ng_levelset;
+    is >> m_allregular >> m_ngrow;
+    is >> nboxes;
+    if (nboxes > 0) m_grids.readFrom(is);
+    is >> nboxes;
+    if (nboxes > 0) m_covered_grids.readFrom(is);
+    is >> ng_levelset;
+    if (is.fail()) {
+        amrex::Abort("EB2::Level::read: failed to read "+dir+"/Header");
+    }
+
+    m_ok = true;
+    if (m_grids.empty()) return;
+
+    m_dmap = DistributionMapping(m_grids);
+
+    const int ng = 2;
+    MFInfo mf_info;
+    mf_info.SetTag("EB2::Level");
+    m_levelset.define(amrex::convert(m_grids,IntVect::TheNodeVector()), m_dmap, 1, ng_levelset, mf_info);
+    m_cellflag.define(m_grids, m_dmap, 1, ng, mf_info);
+    m_volfrac.define(m_grids, m_dmap, 1, ng, mf_info);
+    m_centroid.define(m_grids, m_dmap, AMREX_SPACEDIM, ng, mf_info);
+    m_bndryarea.define(m_grids, m_dmap, 1, ng, mf_info);
+    m_bndrycent.define(m_grids, m_dmap, AMREX_SPACEDIM, ng, mf_info);
+    m_bndrynorm.define(m_grids, m_dmap, AMREX_SPACEDIM, ng, mf_info);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_areafrac[idim].define(amrex::convert(m_grids, IntVect::TheDimensionVector(idim)),
+                                m_dmap, 1, ng, mf_info);
+        m_facecent[idim].define(amrex::convert(m_grids, IntVect::TheDimensionVector(idim)),
+                                m_dmap, AMREX_SPACEDIM-1, ng, mf_info);
+    }
+
+    VisMF::Read(m_levelset, dir+"/LevelSet");
+
+    MultiFab flag(m_grids, m_dmap, 2, ng);
+    VisMF::Read(flag, dir+"/CellFlag");
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(flag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        auto const& src = flag.array(mfi);
+        auto const& dst = m_cellflag.array(mfi);
+        AMREX_HOST_DEVICE_FOR_3D (bx, i, j, k,
+        {
+            dst(i,j,k) = EBCellFlag(static_cast<uint32_t>(src(i,j,k,0))
+                                  | (static_cast<uint32_t>(src(i,j,k,1)) << 16));
+        });
+    }
+
+    VisMF::Read(m_volfrac, dir+"/VolFrac");
+    VisMF::Read(m_centroid, dir+"/Centroid");
+    VisMF::Read(m_bndryarea, dir+"/BndryArea");
+    VisMF::Read(m_bndrycent, dir+"/BndryCent");
+    VisMF::Read(m_bndrynorm, dir+"/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        VisMF::Read(m_areafrac[idim], dir+"/AreaFrac_"+std::to_string(idim));
+        VisMF::Read(m_facecent[idim], dir+"/FaceCent_"+std::to_string(idim));
+    }
+}
+
 }}
@@ -10,9 +10,10 @@ MLABecLaplacian::MLABecLaplacian (const Vector<Geometry>& a_geom,
                                   const Vector<BoxArray>& a_grids,
                                   const Vector<DistributionMapping>& a_dmap,
                                   const LPInfo& a_info,
-                                  const Vector<FabFactory<FArrayBox> const*>& a_factory)
+                                  const Vector<FabFactory<FArrayBox> const*>& a_factory,
+                                  int a_ncomp)
 {
-    define(a_geom, a_grids, a_dmap, a_info, a_factory);
+    define(a_geom, a_grids, a_dmap, a_info, a_factory, a_ncomp);
 }
 
 void
@@ -20,10 +21,13 @@ MLABecLaplacian::define (const Vector<Geometry>& a_geom,
                          const Vector<BoxArray>& a_grids,
                          const Vector<DistributionMapping>& a_dmap,
                          const LPInfo& a_info,
-                         const Vector<FabFactory<FArrayBox> const*>& a_factory)
+                         const Vector<FabFactory<FArrayBox> const*>& a_factory,
+                         int a_ncomp)
 {
     BL_PROFILE("MLABecLaplacian::define()");
 
+    m_ncomp = a_ncomp;
+
     MLCellABecLap::define(a_geom, a_grids, a_dmap, a_info, a_factory);
 
     const int ncomp = getNComp();
@@ -49,6 +53,9 @@ MLABecLaplacian::define (const Vector<Geometry>& a_geom,
             }
         }
     }
+
+    m_acoef_set.assign(m_num_amr_levels, 1);
+    m_bcoef_set.assign(m_num_amr_levels, 1);
 }
 
 MLABecLaplacian::~MLABecLaplacian ()
@@ -57,6 +64,10 @@ MLABecLaplacian::~MLABecLaplacian ()
 void
 MLABecLaplacian::setScalars (Real a, Real b) noexcept
 {
+    if (a != m_a_scalar || b != m_b_scalar) {
+        m_scalars_set = true;
+        m_needs_update = true;
+    }
     m_a_scalar = a;
     m_b_scalar = b;
     if (a == 0.0)
@@ -64,6 +75,7 @@ MLABecLaplacian::setScalars (Real a, Real b) noexcept
         for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
         {
             m_a_coeffs[amrlev][0].setVal(0.0);
+            m_acoef_set[amrlev] = 1;
         }
     }
 }
@@ -72,6 +84,7 @@ void
 MLABecLaplacian::setACoeffs (int amrlev, const MultiFab& alpha)
 {
     MultiFab::Copy(m_a_coeffs[amrlev][0], alpha, 0, 0, 1, 0);
+    m_acoef_set[amrlev] = 1;
     m_needs_update = true;
 }
 
@@ -85,6 +98,15 @@ MLABecLaplacian::setBCoeffs (int amrlev,
             MultiFab::Copy(m_b_coeffs[amrlev][0][idim], *beta[idim], 0, icomp, 1, 0);
         }
     }
+    m_bcoef_set[amrlev] = 1;
+    m_needs_update = true;
+}
+
+void
+MLABecLaplacian::setDeepHaloSmooth (int max_sweeps, int max_box_length) noexcept
+{
+    m_deep_halo_max_sweeps = max_sweeps;
+    m_deep_halo_max_box = max_box_length;
     m_needs_update = true;
 }
 
@@ -93,75 +115,98 @@ MLABecLaplacian::averageDownCoeffs ()
 {
     BL_PROFILE("MLABecLaplacian::averageDownCoeffs()");
 
+    // A level needs to be redone if its own coefficients or those of a
+    // finer amr level have been set.
+    bool do_a = false;
+    bool do_b = false;
     for (int amrlev = m_num_amr_levels-1; amrlev > 0; --amrlev)
     {
+        do_a = do_a || m_acoef_set[amrlev];
+        do_b = do_b || m_bcoef_set[amrlev];
+
         auto& fine_a_coeffs = m_a_coeffs[amrlev];
         auto& fine_b_coeffs = m_b_coeffs[amrlev];
 
-        averageDownCoeffsSameAmrLevel(fine_a_coeffs, fine_b_coeffs);
-        averageDownCoeffsToCoarseAmrLevel(amrlev);
+        averageDownCoeffsSameAmrLevel(fine_a_coeffs, fine_b_coeffs, do_a, do_b);
+        averageDownCoeffsToCoarseAmrLevel(amrlev, do_a, do_b);
     }
 
-    averageDownCoeffsSameAmrLevel(m_a_coeffs[0], m_b_coeffs[0]);
+    do_a = do_a || m_acoef_set[0];
+    do_b = do_b || m_bcoef_set[0];
+    averageDownCoeffsSameAmrLevel(m_a_coeffs[0], m_b_coeffs[0], do_a, do_b);
 }
 
 void
 MLABecLaplacian::averageDownCoeffsSameAmrLevel (Vector<MultiFab>& a,
-                                                Vector<Array<MultiFab,AMREX_SPACEDIM> >& b)
+                                                Vector<Array<MultiFab,AMREX_SPACEDIM> >& b,
+                                                bool do_a, bool do_b)
 {
     int nmglevs = a.size();
     for (int mglev = 1; mglev < nmglevs; ++mglev)
     {
-        if (m_a_scalar == 0.0)
+        if (do_a)
         {
-            a[mglev].setVal(0.0);
+            if (m_a_scalar == 0.0)
+            {
+                a[mglev].setVal(0.0);
+            }
+            else
+            {
+                amrex::average_down(a[mglev-1], a[mglev], 0, 1, mg_coarsen_ratio);
+            }
         }
-        else
+
+        if (do_b)
         {
-            amrex::average_down(a[mglev-1], a[mglev], 0, 1, mg_coarsen_ratio);
+            Vector<const MultiFab*> fine {AMREX_D_DECL(&(b[mglev-1][0]),
+                                                       &(b[mglev-1][1]),
+                                                       &(b[mglev-1][2]))};
+            Vector<MultiFab*> crse {AMREX_D_DECL(&(b[mglev][0]),
+                                                 &(b[mglev][1]),
+                                                 &(b[mglev][2]))};
+            IntVect ratio {mg_coarsen_ratio};
+            amrex::average_down_faces(fine, crse, ratio, 0);
         }
-        
-        Vector<const MultiFab*> fine {AMREX_D_DECL(&(b[mglev-1][0]),
-                                                   &(b[mglev-1][1]),
-                                                   &(b[mglev-1][2]))};
-        Vector<MultiFab*> crse {AMREX_D_DECL(&(b[mglev][0]),
-                                             &(b[mglev][1]),
-                                             &(b[mglev][2]))};
-        IntVect ratio {mg_coarsen_ratio};
-        amrex::average_down_faces(fine, crse, ratio, 0);
     }
 }
 
 void
-MLABecLaplacian::averageDownCoeffsToCoarseAmrLevel (int flev)
+MLABecLaplacian::averageDownCoeffsToCoarseAmrLevel (int flev, bool do_a, bool do_b)
 {
     auto& fine_a_coeffs = m_a_coeffs[flev  ].back();
     auto& fine_b_coeffs = m_b_coeffs[flev  ].back();
     auto& crse_a_coeffs = m_a_coeffs[flev-1].front();
     auto& crse_b_coeffs = m_b_coeffs[flev-1].front();
 
-    if (m_a_scalar != 0.0) {
+    if (do_a && m_a_scalar != 0.0) {
         // We coarsen from the back of flev to the front of flev-1.
         // So we use mg_coarsen_ratio.
         amrex::average_down(fine_a_coeffs, crse_a_coeffs, 0, 1, mg_coarsen_ratio);
     }
 
-    amrex::average_down_faces(amrex::GetArrOfConstPtrs(fine_b_coeffs),
-                              amrex::GetArrOfPtrs(crse_b_coeffs),
-                              mg_coarsen_ratio, 0);
+    if (do_b) {
+        amrex::average_down_faces(amrex::GetArrOfConstPtrs(fine_b_coeffs),
+                                  amrex::GetArrOfPtrs(crse_b_coeffs),
+                                  mg_coarsen_ratio, 0);
+    }
 }
 
 void
 MLABecLaplacian::applyMetricTermsCoeffs ()
 {
 #if (AMREX_SPACEDIM != 3)
+    // Only the coefficients set since the last update are still unscaled.
     for (int alev = 0; alev < m_num_amr_levels; ++alev)
     {
         const int mglev = 0;
-        applyMetricTerm(alev, mglev, m_a_coeffs[alev][mglev]);
-        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
-        {
-            applyMetricTerm(alev, mglev, m_b_coeffs[alev][mglev][idim]);
+        if (m_acoef_set[alev]) {
+            applyMetricTerm(alev, mglev, m_a_coeffs[alev][mglev]);
+        }
+        if (m_bcoef_set[alev]) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+            {
+                applyMetricTerm(alev, mglev, m_b_coeffs[alev][mglev][idim]);
+            }
         }
     }
 #endif
@@ -174,37 +219,10 @@ MLABecLaplacian::prepareForSolve ()
 
     MLCellABecLap::prepareForSolve();
 
-#if (AMREX_SPACEDIM != 3)
-    applyMetricTermsCoeffs();
-#endif
-
-    averageDownCoeffs();
-
-    m_is_singular.clear();
-    m_is_singular.resize(m_num_amr_levels, false);
-    auto itlo = std::find(m_lobc[0].begin(), m_lobc[0].end(), BCType::Dirichlet);
-    auto ithi = std::find(m_hibc[0].begin(), m_hibc[0].end(), BCType::Dirichlet);
-    if (itlo == m_lobc[0].end() && ithi == m_hibc[0].end())
-    {  // No Dirichlet
-        for (int alev = 0; alev < m_num_amr_levels; ++alev)
-        {
-            if (m_domain_covered[alev])
-            {
-                if (m_a_scalar == 0.0)
-                {
-                    m_is_singular[alev] = true;
-                }
-                else
-                {
-                    Real asum = m_a_coeffs[alev].back().sum();
-                    Real amax = m_a_coeffs[alev].back().norm0();
-                    m_is_singular[alev] = (asum <= amax * 1.e-12);
-                }
-            }
-        }
-    }
-
-    m_needs_update = false;
+    m_acoef_set.assign(m_num_amr_levels, 1);
+    m_bcoef_set.assign(m_num_amr_levels, 1);
+    m_scalars_set = true;
+    updateCoeffs();
 }
 
 void
@@ -406,6 +424,147 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
     }
 }
 
+void
+MLABecLaplacian::smoothMulti (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                              int nsweeps, bool skip_fillboundary) const
+{
+    if (useDeepHalo(amrlev, mglev)) {
+        deepHaloSmooth(amrlev, mglev, sol, rhs, nsweeps);
+    } else {
+        MLCellABecLap::smoothMulti(amrlev, mglev, sol, rhs, nsweeps, skip_fillboundary);
+    }
+}
+
+void
+MLABecLaplacian::prepareDeepHalo ()
+{
+    BL_PROFILE("MLABecLaplacian::prepareDeepHalo()");
+
+    m_deep_halo_sweeps.clear();
+    m_a_coeffs_halo.clear();
+    m_b_coeffs_halo.clear();
+    m_halo_buf.clear();
+
+    // Smoothing the ghost cells is only correct if none of them is next
+    // to a physical or coarse/fine boundary, because the boundary
+    // treatment of the smoother is only known for the valid cells.
+    const int amrlev = 0;
+    if (m_deep_halo_max_sweeps <= 0 || isTensorOp() || useChebyshev() || !m_domain_covered[amrlev]
+        || !m_geom[amrlev][0].isAllPeriodic()) {
+        return;
+    }
+
+    const int ncomp = getNComp();
+    const int nmglevs = m_num_mg_levels[amrlev];
+    m_deep_halo_sweeps.resize(nmglevs, 0);
+    m_a_coeffs_halo.resize(nmglevs);
+    m_b_coeffs_halo.resize(nmglevs);
+    m_halo_buf.resize(nmglevs);
+
+    for (int mglev = 0; mglev < nmglevs; ++mglev)
+    {
+        const BoxArray& ba = m_grids[amrlev][mglev];
+        const DistributionMapping& dm = m_dmap[amrlev][mglev];
+        const Geometry& geom = m_geom[amrlev][mglev];
+
+        int minlen = std::numeric_limits<int>::max();
+        for (int i = 0, N = ba.size(); i < N; ++i) {
+            minlen = std::min(minlen, ba[i].shortside());
+        }
+        if (minlen > m_deep_halo_max_box) continue;
+
+        // The redundant work in the ghost cells grows with the number of
+        // sweeps relative to the box size.  The ghost cells also must not
+        // wrap around the periodic domain more than once.
+        int nsweeps = std::min(m_deep_halo_max_sweeps, std::max(1, minlen/8));
+        nsweeps = std::min(nsweeps, geom.Domain().shortside()/2);
+        if (nsweeps <= 0) continue;
+
+        m_deep_halo_sweeps[mglev] = nsweeps;
+        const int ng = 2*nsweeps;
+
+        m_a_coeffs_halo[mglev].define(ba, dm, 1, ng, MFInfo(), *m_factory[amrlev][mglev]);
+        MultiFab::Copy(m_a_coeffs_halo[mglev], m_a_coeffs[amrlev][mglev], 0, 0, 1, 0);
+        m_a_coeffs_halo[mglev].FillBoundary(geom.periodicity());
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            const BoxArray& fba = amrex::convert(ba, IntVect::TheDimensionVector(idim));
+            m_b_coeffs_halo[mglev][idim].define(fba, dm, ncomp, ng, MFInfo(), *m_factory[amrlev][mglev]);
+            MultiFab::Copy(m_b_coeffs_halo[mglev][idim], m_b_coeffs[amrlev][mglev][idim],
+                           0, 0, ncomp, 0);
+            m_b_coeffs_halo[mglev][idim].FillBoundary(geom.periodicity());
+        }
+    }
+}
+
+void
+MLABecLaplacian::deepHaloSmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                                 int nsweeps) const
+{
+    BL_PROFILE("MLABecLaplacian::deepHaloSmooth()");
+
+    const int ncomp = getNComp();
+    const int depth = m_deep_halo_sweeps[mglev];
+    const auto& period = m_geom[amrlev][mglev].periodicity();
+
+    // sol and rhs share a buffer so that the first exchange fills both.
+    auto& buf = m_halo_buf[mglev];
+    if (buf == nullptr) {
+        buf.reset(new MultiFab(sol.boxArray(), sol.DistributionMap(), 2*ncomp, 2*depth,
+                               MFInfo(), *m_factory[amrlev][mglev]));
+    }
+    MultiFab::Copy(*buf, sol, 0, 0, ncomp, 0);
+    MultiFab::Copy(*buf, rhs, 0, ncomp, ncomp, 0);
+
+    const MultiFab& acoef = m_a_coeffs_halo[mglev];
+    AMREX_D_TERM(const MultiFab& bxcoef = m_b_coeffs_halo[mglev][0];,
+                 const MultiFab& bycoef = m_b_coeffs_halo[mglev][1];,
+                 const MultiFab& bzcoef = m_b_coeffs_halo[mglev][2];);
+
+    const Real* h = m_geom[amrlev][mglev].CellSize();
+    AMREX_D_TERM(const Real dhx = m_b_scalar/(h[0]*h[0]);,
+                 const Real dhy = m_b_scalar/(h[1]*h[1]);,
+                 const Real dhz = m_b_scalar/(h[2]*h[2]));
+    const Real alpha = m_a_scalar;
+
+    int nfill = 2*ncomp;
+    for (int isweep = 0; isweep < nsweeps; isweep += depth)
+    {
+        buf->FillBoundary(0, nfill, period);
+        nfill = ncomp;
+
+        // After each half sweep one less layer of ghost cells is up to date.
+        const int nhalf = 2*std::min(depth, nsweeps-isweep);
+        for (int ihalf = 0; ihalf < nhalf; ++ihalf)
+        {
+            const int redblack = ihalf % 2;
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(*buf); mfi.isValid(); ++mfi)
+            {
+                const Box& gbx = amrex::grow(mfi.validbox(), nhalf-1-ihalf);
+                const auto& solnfab = buf->array(mfi);
+                const auto rhsfab = Array4<Real const>(solnfab, ncomp);
+                const auto& afab = acoef.array(mfi);
+                AMREX_D_TERM(const auto& bxfab = bxcoef.array(mfi);,
+                             const auto& byfab = bycoef.array(mfi);,
+                             const auto& bzfab = bzcoef.array(mfi););
+
+                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( gbx, thread_box,
+                {
+                    abec_gsrb_interior(thread_box, solnfab, rhsfab, alpha,
+                                       AMREX_D_DECL(dhx, dhy, dhz), afab,
+                                       AMREX_D_DECL(bxfab, byfab, bzfab),
+                                       ncomp, redblack);
+                });
+            }
+        }
+    }
+
+    MultiFab::Copy(sol, *buf, 0, 0, ncomp, 0);
+}
+
 void
 MLABecLaplacian::FFlux (int amrlev, const MFIter& mfi,
                         const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
@@ -496,38 +655,56 @@ MLABecLaplacian::FFlux (Box const& box, Real const* dxinv, Real bscalar,
 void
 MLABecLaplacian::update ()
 {
+    BL_PROFILE("MLABecLaplacian::update()");
+
     if (MLCellABecLap::needsUpdate()) MLCellABecLap::update();
 
+    updateCoeffs();
+}
+
+void
+MLABecLaplacian::updateCoeffs ()
+{
 #if (AMREX_SPACEDIM != 3)
     applyMetricTermsCoeffs();
 #endif
 
     averageDownCoeffs();
 
-    m_is_singular.clear();
-    m_is_singular.resize(m_num_amr_levels, false);
-    auto itlo = std::find(m_lobc[0].begin(), m_lobc[0].end(), BCType::Dirichlet);
-    auto ithi = std::find(m_hibc[0].begin(), m_hibc[0].end(), BCType::Dirichlet);
-    if (itlo == m_lobc[0].end() && ithi == m_hibc[0].end())
-    {  // No Dirichlet
-        for (int alev = 0; alev < m_num_amr_levels; ++alev)
-        {
-            if (m_domain_covered[alev])
+    const bool a_changed = m_scalars_set ||
+        std::find(m_acoef_set.begin(), m_acoef_set.end(), 1) != m_acoef_set.end();
+    if (a_changed)
+    {
+        m_is_singular.clear();
+        m_is_singular.resize(m_num_amr_levels, false);
+        auto itlo = std::find(m_lobc[0].begin(), m_lobc[0].end(), BCType::Dirichlet);
+        auto ithi = std::find(m_hibc[0].begin(), m_hibc[0].end(), BCType::Dirichlet);
+        if (itlo == m_lobc[0].end() && ithi == m_hibc[0].end())
+        {  // No Dirichlet
+            for (int alev = 0; alev < m_num_amr_levels; ++alev)
             {
-                if (m_a_scalar == 0.0)
+                if (m_domain_covered[alev])
                 {
-                    m_is_singular[alev] = true;
-                }
-                else
-                {
-                    Real asum = m_a_coeffs[alev].back().sum();
-                    Real amax = m_a_coeffs[alev].back().norm0();
-                    m_is_singular[alev] = (asum <= amax * 1.e-12);
+                    if (m_a_scalar == 0.0)
+                    {
+                        m_is_singular[alev] = true;
+                    }
+                    else
+                    {
+                        Real asum = m_a_coeffs[alev].back().sum();
+                        Real amax = m_a_coeffs[alev].back().norm0();
+                        m_is_singular[alev] = (asum <= amax * 1.e-12);
+                    }
                 }
             }
         }
     }
 
+    prepareDeepHalo();
+
+    m_acoef_set.assign(m_num_amr_levels, 0);
+    m_bcoef_set.assign(m_num_amr_levels, 0);
+    m_scalars_set = false;
     m_needs_update = false;
 }
 
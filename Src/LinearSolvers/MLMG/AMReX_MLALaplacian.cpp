@@ -54,12 +54,14 @@ MLALaplacian::setScalars (Real a, Real b) noexcept
             m_a_coeffs[amrlev][0].setVal(0.0);
         }
     }
+    m_needs_update = true;
 }
 
 void
 MLALaplacian::setACoeffs (int amrlev, const MultiFab& alpha)
 {
     MultiFab::Copy(m_a_coeffs[amrlev][0], alpha, 0, 0, 1, 0);
+    m_needs_update = true;
 }
 
 void
@@ -113,6 +115,22 @@ MLALaplacian::prepareForSolve ()
 
     MLCellABecLap::prepareForSolve();
 
+    updateCoeffs();
+}
+
+void
+MLALaplacian::update ()
+{
+    BL_PROFILE("MLALaplacian::update()");
+
+    if (MLCellABecLap::needsUpdate()) MLCellABecLap::update();
+
+    updateCoeffs();
+}
+
+void
+MLALaplacian::updateCoeffs ()
+{
     averageDownCoeffs();
 
     m_is_singular.clear();
@@ -138,6 +156,8 @@ MLALaplacian::prepareForSolve ()
             }
         }
     }
+
+    m_needs_update = false;
 }
 
 void
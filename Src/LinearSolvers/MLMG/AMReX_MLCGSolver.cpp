@@ -10,6 +10,7 @@
 #include <AMReX_MLCGSolver.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_ParallelReduce.H>
+#include <AMReX_Reduce.H>
 #include <AMReX_MLMG.H>
 
 #ifdef _OPENMP
@@ -48,6 +49,54 @@ sxay (MultiFab&       ss,
     sxay(ss,xx,a,yy,0,nghost);
 }
 
+//
+// Sums and a max over the bottom communicator that are started before a
+// matrix-vector product and waited for after it, so that the latency of
+// the reduction is hidden behind the product.
+//
+class NonBlockingReduce
+{
+public:
+    explicit NonBlockingReduce (MPI_Comm comm) : m_comm(comm) {}
+
+    NonBlockingReduce (const NonBlockingReduce&) = delete;
+    NonBlockingReduce& operator= (const NonBlockingReduce&) = delete;
+
+    ~NonBlockingReduce () { wait(); }
+
+    void start (Real* sums, int nsums, Real* maxval)
+    {
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+        const MPI_Datatype dtype = ParallelDescriptor::Mpi_typemap<Real>::type();
+        MPI_Iallreduce(MPI_IN_PLACE, sums, nsums, dtype, MPI_SUM, m_comm, &m_reqs[0]);
+        MPI_Iallreduce(MPI_IN_PLACE, maxval, 1, dtype, MPI_MAX, m_comm, &m_reqs[1]);
+        m_active = true;
+#else
+        ParallelAllReduce::Sum(sums, nsums, m_comm);
+        ParallelAllReduce::Max(*maxval, m_comm);
+#endif
+    }
+
+    void wait ()
+    {
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+        if (m_active) {
+            BL_PROFILE("MLCGSolver::ParallelAllReduce");
+            MPI_Waitall(2, m_reqs, MPI_STATUSES_IGNORE);
+            m_active = false;
+        }
+#endif
+    }
+
+private:
+    MPI_Comm m_comm;
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+    MPI_Request m_reqs[2];
+    bool m_active = false;
+#endif
+};
+
 }
 
 MLCGSolver::MLCGSolver (MLMG* a_mlmg, MLLinOp& _lp, Type _typ)
@@ -71,6 +120,10 @@ MLCGSolver::solve (MultiFab&       sol,
 {
     if (solver_type == Type::BiCGStab) {
         return solve_bicgstab(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::PipeBiCGStab) {
+        return solve_pipebicgstab(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::PipeCG) {
+        return solve_pipecg(sol,rhs,eps_rel,eps_abs);
     } else {
         return solve_cg(sol,rhs,eps_rel,eps_abs);
     }
@@ -391,6 +444,416 @@ MLCGSolver::solve_cg (MultiFab&       sol,
     return ret;
 }
 
+int
+MLCGSolver::solve_pipebicgstab (MultiFab&       sol,
+                                const MultiFab& rhs,
+                                Real            eps_rel,
+                                Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipebicgstab");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // r, w and z are the inputs of the matrix-vector products and need the
+    // ghost cells of sol.
+    MultiFab r    (ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab w    (ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab z    (ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+    z.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rh   (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab y    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab t    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab v    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    p.setVal(0.0);
+    s.setVal(0.0);
+    v.setVal(0.0);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+    Lp.normalize(amrlev, mglev, r);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+
+    sol.setVal(0);
+
+    Real rnorm = norm_inf(r);
+    const Real rnorm0 = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeBiCGStab: Initial error (error0) =    " << rnorm0 << '\n';
+    }
+    int ret = 0, nit = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    NonBlockingReduce nbr(Lp.BottomCommunicator());
+
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, w);
+
+    // rvals = { (rh,r), (rh,w), (rh,s), (rh,z) }
+    Real rvals[4] = { dotxy(rh,r,true), dotxy(rh,w,true), 0.0, 0.0 };
+    Real rmax = 0.0;
+    nbr.start(rvals, 2, &rmax);
+
+    Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, t);
+
+    nbr.wait();
+
+    Real rho = rvals[0];
+    Real alpha = 0, beta = 0, omega = 0;
+    if ( rho == 0 )
+    {
+        ret = 1;
+    }
+    else if ( rvals[1] == 0 )
+    {
+        ret = 2;
+    }
+    else
+    {
+        alpha = rho/rvals[1];
+    }
+
+    for (; ret == 0 && nit <= maxiter; ++nit)
+    {
+        if ( nit > 1 )
+        {
+            // p = r + beta*(p - omega*s), s = w + beta*(s - omega*z), z = t + beta*(z - omega*v)
+            sxay(p, p, -omega, s, nghost);
+            sxay(p, r,   beta, p, nghost);
+            sxay(s, s, -omega, z, nghost);
+            sxay(s, w,   beta, s, nghost);
+            sxay(z, z, -omega, v, nghost);
+            sxay(z, t,   beta, z, nghost);
+        }
+        else
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(z,t,0,0,ncomp,nghost);
+        }
+        sxay(q, r, -alpha, s, nghost);
+        sxay(y, w, -alpha, z, nghost);
+        //
+        // One reduction for omega and the half-step residual norm,
+        // overlapped with v = A z.
+        //
+        Real yvals[2] = { dotxy(q,y,true), dotxy(y,y,true) };
+        Real qmax = norm_inf(q,true);
+        nbr.start(yvals, 2, &qmax);
+
+        Lp.apply(amrlev, mglev, v, z, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, v);
+
+        nbr.wait();
+
+        rnorm = qmax;
+
+        if ( verbose > 2 && ParallelDescriptor::IOProcessor() )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: Half Iter "
+                           << std::setw(11) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs )
+        {
+            sxay(sol, sol, alpha, p, nghost);
+            break;
+        }
+
+        if ( yvals[1] )
+        {
+            omega = yvals[0]/yvals[1];
+        }
+        else
+        {
+            ret = 3; break;
+        }
+
+        // sol += alpha*p + omega*q, r = q - omega*y, w = y - omega*(t - alpha*v)
+        sxay(sol, sol, alpha, p, nghost);
+        sxay(sol, sol, omega, q, nghost);
+        sxay(r, q, -omega, y, nghost);
+        sxay(t, t, -alpha, v, nghost);
+        sxay(w, y, -omega, t, nghost);
+        //
+        // One reduction for alpha, beta and the residual norm, overlapped
+        // with t = A w.
+        //
+        rvals[0] = dotxy(rh,r,true);
+        rvals[1] = dotxy(rh,w,true);
+        rvals[2] = dotxy(rh,s,true);
+        rvals[3] = dotxy(rh,z,true);
+        rmax = norm_inf(r,true);
+        nbr.start(rvals, 4, &rmax);
+
+        Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, t);
+
+        nbr.wait();
+
+        rnorm = rmax;
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: Iteration "
+                           << std::setw(11) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        if ( omega == 0 )
+        {
+            ret = 4; break;
+        }
+
+        const Real rho_1 = rho;
+        rho = rvals[0];
+        if ( rho == 0 )
+        {
+            ret = 1; break;
+        }
+        beta = (rho/rho_1)*(alpha/omega);
+
+        const Real denom = rvals[1] + beta*rvals[2] - beta*omega*rvals[3];
+        if ( denom == 0 )
+        {
+            ret = 2; break;
+        }
+        alpha = rho/denom;
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeBiCGStab: Final: Iteration "
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipeBiCGStab:: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+int
+MLCGSolver::solve_pipecg (MultiFab&       sol,
+                          const MultiFab& rhs,
+                          Real            eps_rel,
+                          Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipecg");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // r and w are the inputs of the matrix-vector products and need the
+    // ghost cells of sol.
+    MultiFab r(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab z    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    sol.setVal(0);
+
+    Real       rnorm    = norm_inf(r);
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeCG: Initial error (error0) :    " << rnorm0 << '\n';
+    }
+
+    Real gamma_1 = 0, alpha_1 = 0;
+    int  ret     = 0;
+    int  nit     = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 ) {
+            amrex::Print() << "MLCGSolver_PipeCG: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    NonBlockingReduce nbr(Lp.BottomCommunicator());
+
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+    for (; nit <= maxiter; ++nit)
+    {
+        //
+        // One reduction for gamma, delta and the norm of the residual of
+        // the previous iteration, overlapped with q = A w.
+        //
+        Real vals[2] = { dotxy(r,r,true), dotxy(w,r,true) };
+        Real rmax = norm_inf(r,true);
+        nbr.start(vals, 2, &rmax);
+
+        Lp.apply(amrlev, mglev, q, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+        nbr.wait();
+
+        if ( nit > 1 )
+        {
+            rnorm = rmax;
+
+            if ( verbose > 2 )
+            {
+                amrex::Print() << "MLCGSolver_pipecg:   Iteration"
+                               << std::setw(4) << nit-1
+                               << " rel. err. "
+                               << rnorm/(rnorm0) << '\n';
+            }
+
+            if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) {
+                --nit;
+                break;
+            }
+        }
+
+        const Real gamma = vals[0];
+        const Real delta = vals[1];
+
+        if ( gamma == 0 )
+        {
+            ret = 1; break;
+        }
+
+        Real alpha, beta;
+        if ( nit == 1 )
+        {
+            beta = 0;
+            if ( delta == 0 ) { ret = 1; break; }
+            alpha = gamma/delta;
+        }
+        else
+        {
+            beta = gamma/gamma_1;
+            const Real denom = delta - beta*gamma/alpha_1;
+            if ( denom == 0 ) { ret = 1; break; }
+            alpha = gamma/denom;
+        }
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_pipecg:"
+                           << " nit " << nit
+                           << " gamma " << gamma
+                           << " alpha " << alpha << '\n';
+        }
+
+        if ( nit == 1 )
+        {
+            MultiFab::Copy(z,q,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(z, q, beta, z, nghost);
+            sxay(s, w, beta, s, nghost);
+            sxay(p, r, beta, p, nghost);
+        }
+        sxay(sol, sol,  alpha, p, nghost);
+        sxay(  r,   r, -alpha, s, nghost);
+        sxay(  w,   w, -alpha, z, nghost);
+
+        gamma_1 = gamma;
+        alpha_1 = alpha;
+    }
+
+    if ( nit > maxiter ) {
+        // The norm of the last residual has not been computed yet.
+        nit = maxiter;
+        rnorm = norm_inf(r);
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_pipecg: Final Iteration"
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_pipecg: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
 Real
 MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
 {
@@ -405,9 +868,15 @@ Real
 MLCGSolver::norm_inf (const MultiFab& res, bool local)
 {
     int ncomp = res.nComp();
-    Real result = std::numeric_limits<Real>::lowest();
-    for (int n=0; n<ncomp; n++)
-      result = std::max(result,res.norm0(n,0,true));
+    ReduceOps<ReduceOpMax> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    reduce_op.eval(res, IntVect(0), reduce_data,
+    [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& fab) -> ReduceTuple
+    {
+        return ReduceTuple(fab.norm(bx, 0, 0, ncomp));
+    });
+    Real result = amrex::get<0>(reduce_data.value());
 
     if (!local) {
         BL_PROFILE("MLCGSolver::ParallelAllReduce");
@@ -342,6 +342,10 @@ MLCellLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
                      bool skip_fillboundary) const
 {
     BL_PROFILE("MLCellLinOp::smooth()");
+    if (useChebyshev()) {
+        chebyshevSmooth(amrlev, mglev, sol, rhs, m_cheby_degree);
+        return;
+    }
     for (int redblack = 0; redblack < 2; ++redblack)
     {
         applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution,
@@ -430,6 +434,198 @@ MLCellLinOp::correctionResidual (int amrlev, int mglev, MultiFab& resid, MultiFa
     MultiFab::Xpay(resid, -1.0, b, 0, 0, ncomp, 0);
 }
 
+void
+MLCellLinOp::smoothSP (int amrlev, int mglev, SPMultiFab& sol, const SPMultiFab& rhs,
+                       bool skip_fillboundary) const
+{
+    BL_PROFILE("MLCellLinOp::smoothSP()");
+    for (int redblack = 0; redblack < 2; ++redblack)
+    {
+        applyBCSP(amrlev, mglev, sol, skip_fillboundary);
+        FsmoothSP(amrlev, mglev, sol, rhs, redblack);
+        skip_fillboundary = false;
+    }
+}
+
+void
+MLCellLinOp::correctionResidualSP (int amrlev, int mglev, SPMultiFab& resid, SPMultiFab& x,
+                                   const SPMultiFab& b) const
+{
+    BL_PROFILE("MLCellLinOp::correctionResidualSP()");
+    const int ncomp = getNComp();
+    applyBCSP(amrlev, mglev, x);
+    FapplySP(amrlev, mglev, resid, x);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(resid,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        auto const& rfab = resid.array(mfi);
+        auto const& bfab = b.array(mfi);
+        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            rfab(i,j,k,n) = bfab(i,j,k,n) - rfab(i,j,k,n);
+        });
+    }
+}
+
+void
+MLCellLinOp::restrictionSP (int, int, SPMultiFab& crse, SPMultiFab& fine) const
+{
+    BL_PROFILE("MLCellLinOp::restrictionSP()");
+
+    const int ncomp = getNComp();
+
+    SPMultiFab cfine;
+    SPMultiFab* cmf = &crse;
+    if (!amrex::isMFIterSafe(crse, fine))
+    {
+        cfine.define(amrex::coarsen(fine.boxArray(), 2), fine.DistributionMap(), ncomp, 0);
+        cmf = &cfine;
+    }
+
+    const SPMultiFab& ffine = fine;
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*cmf,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        auto const cfab = cmf->array(mfi);
+        auto const ffab = ffine.array(mfi);
+        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            mg_cc_restrict(i,j,k,n,cfab,ffab);
+        });
+    }
+
+    if (cmf != &crse) {
+        crse.ParallelCopy(cfine, 0, 0, ncomp);
+    }
+}
+
+void
+MLCellLinOp::interpolationSP (int amrlev, int fmglev, SPMultiFab& fine, const SPMultiFab& crse) const
+{
+    BL_PROFILE("MLCellLinOp::interpolationSP()");
+
+    const int ncomp = getNComp();
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(crse,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx    = mfi.tilebox();
+        auto const cfab = crse.array(mfi);
+        auto       ffab = fine.array(mfi);
+        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            mg_cc_interp(i,j,k,n,ffab,cfab);
+        });
+    }
+}
+
+// Homogeneous physical boundary conditions in single precision.  Only
+// cross stencils are supported.
+void
+MLCellLinOp::applyBCSP (int amrlev, int mglev, SPMultiFab& in, bool skip_fillboundary) const
+{
+    BL_PROFILE("MLCellLinOp::applyBCSP()");
+
+    AMREX_ALWAYS_ASSERT(isCrossStencil() && !isTensorOp());
+
+    const int ncomp = getNComp();
+    if (!skip_fillboundary) {
+        in.FillBoundary(0, ncomp, m_geom[amrlev][mglev].periodicity(), true);
+    }
+
+    const int flagbc = 0;
+    const int imaxorder = maxorder;
+
+    const Real dxi = m_geom[amrlev][mglev].InvCellSize(0);
+    const Real dyi = (AMREX_SPACEDIM >= 2) ? m_geom[amrlev][mglev].InvCellSize(1) : 1.0;
+    const Real dzi = (AMREX_SPACEDIM == 3) ? m_geom[amrlev][mglev].InvCellSize(2) : 1.0;
+
+    const auto& maskvals = m_maskvals[amrlev][mglev];
+    const auto& bcondloc = *m_bcondloc[amrlev][mglev];
+
+    BaseFab<float> foofab(Box::TheUnitBox(),ncomp);
+    const auto& foo = foofab.const_array();
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.SetDynamic(true);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(in, mfi_info); mfi.isValid(); ++mfi)
+    {
+        const Box& vbx   = mfi.validbox();
+        const auto& iofab = in.array(mfi);
+
+        const auto & bdlv = bcondloc.bndryLocs(mfi);
+        const auto & bdcv = bcondloc.bndryConds(mfi);
+
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            const Orientation olo(idim,Orientation::low);
+            const Orientation ohi(idim,Orientation::high);
+            const Box blo = amrex::adjCellLo(vbx, idim);
+            const Box bhi = amrex::adjCellHi(vbx, idim);
+            const int blen = vbx.length(idim);
+            const auto& mlo = maskvals[olo].array(mfi);
+            const auto& mhi = maskvals[ohi].array(mfi);
+            for (int icomp = 0; icomp < ncomp; ++icomp) {
+                const BoundCond bctlo = bdcv[icomp][olo];
+                const BoundCond bcthi = bdcv[icomp][ohi];
+                const Real bcllo = bdlv[icomp][olo];
+                const Real bclhi = bdlv[icomp][ohi];
+                if (idim == 0) {
+                    AMREX_LAUNCH_HOST_DEVICE_LAMBDA (
+                    blo, tboxlo, {
+                    mllinop_apply_bc_x(0, tboxlo, blen, iofab, mlo,
+                                       bctlo, bcllo, foo,
+                                       imaxorder, dxi, flagbc, icomp);
+                    },
+                    bhi, tboxhi, {
+                    mllinop_apply_bc_x(1, tboxhi, blen, iofab, mhi,
+                                       bcthi, bclhi, foo,
+                                       imaxorder, dxi, flagbc, icomp);
+                    });
+                } else if (idim == 1) {
+                    AMREX_LAUNCH_HOST_DEVICE_LAMBDA (
+                    blo, tboxlo, {
+                    mllinop_apply_bc_y(0, tboxlo, blen, iofab, mlo,
+                                       bctlo, bcllo, foo,
+                                       imaxorder, dyi, flagbc, icomp);
+                    },
+                    bhi, tboxhi, {
+                    mllinop_apply_bc_y(1, tboxhi, blen, iofab, mhi,
+                                       bcthi, bclhi, foo,
+                                       imaxorder, dyi, flagbc, icomp);
+                    });
+                } else {
+                    AMREX_LAUNCH_HOST_DEVICE_LAMBDA (
+                    blo, tboxlo, {
+                    mllinop_apply_bc_z(0, tboxlo, blen, iofab, mlo,
+                                       bctlo, bcllo, foo,
+                                       imaxorder, dzi, flagbc, icomp);
+                    },
+                    bhi, tboxhi, {
+                    mllinop_apply_bc_z(1, tboxhi, blen, iofab, mhi,
+                                       bcthi, bclhi, foo,
+                                       imaxorder, dzi, flagbc, icomp);
+                    });
+                }
+            }
+        }
+    }
+}
+
 void
 MLCellLinOp::applyBC (int amrlev, int mglev, MultiFab& in, BCMode bc_mode, StateMode,
                       const MLMGBndry* bndry, bool skip_fillboundary) const
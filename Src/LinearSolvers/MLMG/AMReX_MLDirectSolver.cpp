@@ -0,0 +1,653 @@
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <AMReX_MLDirectSolver.H>
+#include <AMReX_BoxIterator.H>
+#include <AMReX_ParallelContext.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+namespace amrex {
+
+namespace {
+
+// Gather send on process 0 of the current sub-communicator.  cnt and
+// disp are only defined on process 0.
+template <class T>
+void
+gatherSub (const Vector<T>& send, Vector<T>& recv, Vector<int>& cnt, Vector<int>& disp)
+{
+    const int n = send.size();
+#ifdef BL_USE_MPI
+    MPI_Comm comm = ParallelContext::CommunicatorSub();
+    const int nprocs = ParallelContext::NProcsSub();
+    const bool root = ParallelContext::MyProcSub() == 0;
+    cnt.resize(root ? nprocs : 0);
+    disp.resize(root ? nprocs : 0);
+    BL_MPI_REQUIRE( MPI_Gather(const_cast<int*>(&n), 1, MPI_INT,
+                               cnt.data(), 1, MPI_INT, 0, comm) );
+    long ntot = 0;
+    for (int i = 0; i < static_cast<int>(cnt.size()); ++i) {
+        disp[i] = ntot;
+        ntot += cnt[i];
+    }
+    AMREX_ALWAYS_ASSERT(ntot < std::numeric_limits<int>::max());
+    recv.resize(ntot);
+    BL_MPI_REQUIRE( MPI_Gatherv(const_cast<T*>(send.data()), n,
+                                ParallelDescriptor::Mpi_typemap<T>::type(),
+                                recv.data(), cnt.data(), disp.data(),
+                                ParallelDescriptor::Mpi_typemap<T>::type(), 0, comm) );
+#else
+    recv = send;
+    cnt.assign(1, n);
+    disp.assign(1, 0);
+#endif
+}
+
+// Inverse of gatherSub.  recv must have the right size on entry.
+template <class T>
+void
+scatterSub (const Vector<T>& send, const Vector<int>& cnt, const Vector<int>& disp,
+            Vector<T>& recv)
+{
+#ifdef BL_USE_MPI
+    BL_MPI_REQUIRE( MPI_Scatterv(const_cast<T*>(send.data()),
+                                 const_cast<int*>(cnt.data()), const_cast<int*>(disp.data()),
+                                 ParallelDescriptor::Mpi_typemap<T>::type(),
+                                 recv.data(), recv.size(),
+                                 ParallelDescriptor::Mpi_typemap<T>::type(), 0,
+                                 ParallelContext::CommunicatorSub()) );
+#else
+    amrex::ignore_unused(cnt);
+    amrex::ignore_unused(disp);
+    recv = send;
+#endif
+}
+
+template <class T>
+void
+bcastSub (T* p, int n)
+{
+#ifdef BL_USE_MPI
+    ParallelDescriptor::Bcast(p, n, 0, ParallelContext::CommunicatorSub());
+#else
+    amrex::ignore_unused(p);
+    amrex::ignore_unused(n);
+#endif
+}
+
+// Reverse Cuthill-McKee ordering of the graph in CSR form (ptr, adj).
+// Returns perm with perm[new] = old.
+Vector<long>
+rcmOrdering (const Vector<long>& ptr, const Vector<long>& adj)
+{
+    const long n = ptr.size()-1;
+    auto degree = [&] (long i) { return ptr[i+1]-ptr[i]; };
+
+    Vector<long> order;
+    order.reserve(n);
+    Vector<char> visited(n, 0);
+    Vector<long> level(n, -1);
+    Vector<long> nbrs;
+
+    // Breadth-first search from root on the unvisited nodes.  Returns the
+    // nodes in the order they are reached, neighbors by increasing degree.
+    auto bfs = [&] (long root, Vector<long>& q) -> long
+    {
+        q.clear();
+        q.push_back(root);
+        level[root] = 0;
+        long nlevels = 1;
+        for (long head = 0; head < static_cast<long>(q.size()); ++head)
+        {
+            const long i = q[head];
+            nbrs.clear();
+            for (long k = ptr[i]; k < ptr[i+1]; ++k) {
+                const long j = adj[k];
+                if (!visited[j] && level[j] < 0) {
+                    level[j] = level[i]+1;
+                    nbrs.push_back(j);
+                }
+            }
+            std::sort(nbrs.begin(), nbrs.end(), [&] (long a, long b)
+                      { return degree(a) < degree(b) || (degree(a) == degree(b) && a < b); });
+            q.insert(q.end(), nbrs.begin(), nbrs.end());
+            nlevels = std::max(nlevels, level[i]+1);
+        }
+        return nlevels;
+    };
+
+    Vector<long> q;
+    for (long seed = 0; seed < n; ++seed)
+    {
+        if (visited[seed]) continue;
+
+        // Look for a pseudo-peripheral node of this component
+        long root = seed;
+        long nlevels = bfs(root, q);
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            long cand = q.back();
+            const long lastlev = level[cand];
+            for (long m : q) {
+                if (level[m] == lastlev && degree(m) < degree(cand)) cand = m;
+            }
+            for (long m : q) level[m] = -1;
+            const long nl = bfs(cand, q);
+            if (nl <= nlevels) {
+                for (long m : q) level[m] = -1;
+                bfs(root, q);
+                break;
+            }
+            root = cand;
+            nlevels = nl;
+        }
+
+        for (long m : q) {
+            visited[m] = 1;
+            level[m] = -1;
+            order.push_back(m);
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+}
+
+MLDirectSolver::MLDirectSolver (MLLinOp& a_lp)
+    : Lp(a_lp)
+{}
+
+MLDirectSolver::~MLDirectSolver () {}
+
+long
+MLDirectSolver::pointId (const IntVect& iv) const noexcept
+{
+    long id = 0;
+    long stride = 1;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        long i = iv[idim] - m_domain.smallEnd(idim);
+        if (m_period[idim] > 0) {
+            i = ((i % m_period[idim]) + m_period[idim]) % m_period[idim];
+        }
+        id += i*stride;
+        stride *= m_len[idim];
+    }
+    return id;
+}
+
+bool
+MLDirectSolver::setup (const MultiFab& x)
+{
+    BL_PROFILE("MLDirectSolver::setup()");
+
+    Real setup_start_time = amrex::second();
+
+    // Independent components share the matrix and are solved one by one.
+    const int ncomp = Lp.getNComp();
+    if (ncomp > 1 && !Lp.hasIndependentComponents()) {
+        if (verbose > 0) {
+            amrex::Print() << "MLDirectSolver does not work with coupled components\n";
+        }
+        return false;
+    }
+
+    const int amrlev = 0;
+    const int mglev = Lp.NMGLevels(amrlev) - 1;
+    const Geometry& geom = Lp.Geom(amrlev, mglev);
+    const bool root = ParallelContext::MyProcSub() == 0;
+
+    // Nodal points on periodic boundaries are the same unknown on both
+    // sides, so indices are wrapped into one period.
+    m_domain = amrex::convert(geom.Domain(), x.ixType());
+    IntVect cperiod;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        if (geom.isPeriodic(idim)) {
+            const int n = geom.Domain().length(idim);
+            m_period[idim] = n;
+            m_len[idim] = n;
+            // Points of the same color must be at least three apart
+            // including across the periodic boundary.
+            cperiod[idim] = n;
+            for (int p = 3; p < n; ++p) {
+                if (n % p == 0) { cperiod[idim] = p; break; }
+            }
+        } else {
+            m_period[idim] = 0;
+            m_len[idim] = m_domain.length(idim);
+            cperiod[idim] = 3;
+        }
+    }
+    const int ncolors = AMREX_D_TERM(cperiod[0],*cperiod[1],*cperiod[2]);
+
+    auto color = [&] (const IntVect& iv) -> int
+    {
+        int c = 0;
+        for (int idim = AMREX_SPACEDIM-1; idim >= 0; --idim) {
+            long i = iv[idim] - m_domain.smallEnd(idim);
+            if (m_period[idim] > 0) {
+                i = ((i % m_period[idim]) + m_period[idim]) % m_period[idim];
+            }
+            c = c*cperiod[idim] + static_cast<int>(i % cperiod[idim]);
+        }
+        return c;
+    };
+
+    auto in_domain = [&] (const IntVect& iv) -> bool
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (m_period[idim] == 0 &&
+                (iv[idim] < m_domain.smallEnd(idim) || iv[idim] > m_domain.bigEnd(idim))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Ids of the local points, in MFIter order
+    Vector<long> point_ids;
+    for (MFIter mfi(x); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        for (BoxIterator bi(bx); bi.ok(); ++bi) {
+            point_ids.push_back(pointId(bi()));
+        }
+    }
+
+    // Probe the operator with one vector per color.  Each nonzero in the
+    // result then comes from the only neighbor of that color.
+    Vector<long> rows, cols;
+    Vector<Real> vals;
+    {
+        MultiFab in(x.boxArray(), x.DistributionMap(), ncomp, x.nGrow(), MFInfo(), *Lp.Factory(amrlev,mglev));
+        MultiFab out(x.boxArray(), x.DistributionMap(), ncomp, 0, MFInfo(), *Lp.Factory(amrlev,mglev));
+        const Box nbr(IntVect(-1), IntVect(1));
+
+        for (int c = 0; c < ncolors; ++c)
+        {
+            in.setVal(0.0);
+            for (MFIter mfi(in); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                FArrayBox& fab = in[mfi];
+                for (BoxIterator bi(bx); bi.ok(); ++bi) {
+                    if (color(bi()) == c) {
+                        for (int n = 0; n < ncomp; ++n) fab(bi(),n) = 1.0;
+                    }
+                }
+            }
+
+            Lp.apply(amrlev, mglev, out, in, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+            for (MFIter mfi(out); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                const FArrayBox& fab = out[mfi];
+                for (BoxIterator bi(bx); bi.ok(); ++bi)
+                {
+                    const Real v = fab(bi());
+                    if (v == 0.0) continue;
+                    for (BoxIterator ni(nbr); ni.ok(); ++ni)
+                    {
+                        const IntVect iv = bi() + ni();
+                        if (in_domain(iv) && color(iv) == c) {
+                            rows.push_back(pointId(bi()));
+                            cols.push_back(pointId(iv));
+                            vals.push_back(v);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Vector<long> all_ids, all_rows, all_cols;
+    Vector<Real> all_vals;
+    Vector<int> cnt, disp;
+    gatherSub(point_ids, all_ids, m_recv_cnt, m_recv_disp);
+    gatherSub(rows, all_rows, cnt, disp);
+    gatherSub(cols, all_cols, cnt, disp);
+    gatherSub(vals, all_vals, cnt, disp);
+
+    int ok = 1;
+    if (root)
+    {
+        Vector<long> ids = all_ids;
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        m_nrows = ids.size();
+
+        auto dense = [&] (long id) -> long
+        {
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            return (it != ids.end() && *it == id) ? it - ids.begin() : -1;
+        };
+
+        m_recv_index.resize(all_ids.size());
+        for (long k = 0; k < static_cast<long>(all_ids.size()); ++k) {
+            m_recv_index[k] = dense(all_ids[k]);
+        }
+
+        if (m_nrows > max_size)
+        {
+            ok = 0;
+            if (verbose > 0) {
+                amrex::AllPrint() << "MLDirectSolver: " << m_nrows
+                                  << " unknowns is more than the maximum of " << max_size << "\n";
+            }
+        }
+        else
+        {
+            // Coordinate format in the dense ordering.  Points shared by
+            // several fabs give the same entries more than once.
+            Vector<std::pair<long,long> > ij;
+            Vector<Real> aij;
+            ij.reserve(all_rows.size());
+            aij.reserve(all_rows.size());
+            for (long k = 0; k < static_cast<long>(all_rows.size()); ++k) {
+                const long i = dense(all_rows[k]);
+                const long j = dense(all_cols[k]);
+                if (i >= 0 && j >= 0) {
+                    ij.push_back(std::make_pair(i,j));
+                    aij.push_back(all_vals[k]);
+                }
+            }
+            Vector<long> idx(ij.size());
+            for (long k = 0; k < static_cast<long>(idx.size()); ++k) idx[k] = k;
+            std::stable_sort(idx.begin(), idx.end(), [&] (long a, long b) { return ij[a] < ij[b]; });
+
+            Vector<long> ptr(m_nrows+1, 0);
+            Vector<long> colind;
+            Vector<Real> values;
+            for (long k = 0; k < static_cast<long>(idx.size()); ++k) {
+                if (k > 0 && ij[idx[k]] == ij[idx[k-1]]) continue;
+                ++ptr[ij[idx[k]].first+1];
+                colind.push_back(ij[idx[k]].second);
+                values.push_back(aij[idx[k]]);
+            }
+            for (long i = 0; i < m_nrows; ++i) ptr[i+1] += ptr[i];
+
+            // Rows without entries (e.g., covered cells and Dirichlet
+            // nodes) become identity rows.  For a singular operator the
+            // first row with off-diagonal entries is replaced by the
+            // identity, which fixes the constant in the null space.
+            m_pinned = -1;
+            Vector<long> ptr2(m_nrows+1, 0);
+            Vector<long> colind2;
+            Vector<Real> values2;
+            for (long i = 0; i < m_nrows; ++i)
+            {
+                bool offdiag = false;
+                for (long k = ptr[i]; k < ptr[i+1]; ++k) {
+                    if (colind[k] != i) offdiag = true;
+                }
+                if (ptr[i] == ptr[i+1] ||
+                    (m_pinned < 0 && offdiag && Lp.isBottomSingular()))
+                {
+                    if (ptr[i] != ptr[i+1]) m_pinned = i;
+                    colind2.push_back(i);
+                    values2.push_back(1.0);
+                }
+                else
+                {
+                    for (long k = ptr[i]; k < ptr[i+1]; ++k) {
+                        colind2.push_back(colind[k]);
+                        values2.push_back(values[k]);
+                    }
+                }
+                ptr2[i+1] = colind2.size();
+            }
+
+            // Structure of A+A^T without the diagonal for the ordering
+            Vector<std::pair<long,long> > edges;
+            for (long i = 0; i < m_nrows; ++i) {
+                for (long k = ptr2[i]; k < ptr2[i+1]; ++k) {
+                    const long j = colind2[k];
+                    if (j != i) {
+                        edges.push_back(std::make_pair(i,j));
+                        edges.push_back(std::make_pair(j,i));
+                    }
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+            Vector<long> gptr(m_nrows+1, 0);
+            Vector<long> gadj(edges.size());
+            for (long k = 0; k < static_cast<long>(edges.size()); ++k) {
+                ++gptr[edges[k].first+1];
+                gadj[k] = edges[k].second;
+            }
+            for (long i = 0; i < m_nrows; ++i) gptr[i+1] += gptr[i];
+
+            m_perm = rcmOrdering(gptr, gadj);
+            Vector<long> iperm(m_nrows);
+            for (long i = 0; i < m_nrows; ++i) iperm[m_perm[i]] = i;
+
+            // Envelope of the reordered matrix
+            m_first.resize(m_nrows);
+            for (long inew = 0; inew < m_nrows; ++inew) {
+                const long iold = m_perm[inew];
+                long f = inew;
+                for (long k = gptr[iold]; k < gptr[iold+1]; ++k) {
+                    f = std::min(f, iperm[gadj[k]]);
+                }
+                m_first[inew] = f;
+            }
+            m_start.resize(m_nrows+1);
+            m_start[0] = 0;
+            for (long i = 0; i < m_nrows; ++i) {
+                m_start[i+1] = m_start[i] + (i - m_first[i]);
+            }
+
+            if (m_start[m_nrows] > max_factor_size)
+            {
+                ok = 0;
+                if (verbose > 0) {
+                    amrex::AllPrint() << "MLDirectSolver: factors of " << m_start[m_nrows]
+                                      << " entries are more than the maximum of "
+                                      << max_factor_size << "\n";
+                }
+            }
+            else
+            {
+                m_lval.assign(m_start[m_nrows], 0.0);
+                m_uval.assign(m_start[m_nrows]+m_nrows, 0.0);
+                for (long iold = 0; iold < m_nrows; ++iold) {
+                    const long i = iperm[iold];
+                    for (long k = ptr2[iold]; k < ptr2[iold+1]; ++k) {
+                        const long j = iperm[colind2[k]];
+                        if (j < i) {
+                            m_lval[m_start[i] + j - m_first[i]] = values2[k];
+                        } else {
+                            m_uval[m_start[j] + j + i - m_first[j]] = values2[k];
+                        }
+                    }
+                }
+                if (m_pinned >= 0) m_pinned = iperm[m_pinned];
+
+                ok = factor();
+                if (!ok && verbose > 0) {
+                    amrex::AllPrint() << "MLDirectSolver: zero pivot in LU factorization\n";
+                }
+            }
+        }
+
+        if (!ok) {
+            m_perm.clear();
+            m_first.clear();
+            m_start.clear();
+            m_lval.clear();
+            m_uval.clear();
+        }
+    }
+
+    bcastSub(&ok, 1);
+
+    // Only the root of the subcommunicator has the factors, and it need
+    // not be the I/O process.
+    if (ok && verbose > 0 && root) {
+        Real setup_time = amrex::second() - setup_start_time;
+        amrex::AllPrint() << "MLDirectSolver: " << m_nrows << " unknowns, "
+                          << 2*m_start[m_nrows]+m_nrows << " entries in the LU factors, "
+                          << "setup time " << setup_time << "\n";
+    }
+
+    return ok;
+}
+
+bool
+MLDirectSolver::factor ()
+{
+    BL_PROFILE("MLDirectSolver::factor()");
+
+    // L(i,j) for first[i] <= j < i is lval[start[i]+j-first[i]] and
+    // U(j,i) for first[i] <= j <= i is uval[start[i]+i+j-first[i]].
+    const long n = m_nrows;
+    Real* AMREX_RESTRICT lval = m_lval.data();
+    Real* AMREX_RESTRICT uval = m_uval.data();
+
+    Real amax = 0.0;
+    for (Real v : m_lval) amax = std::max(amax, std::abs(v));
+    for (Real v : m_uval) amax = std::max(amax, std::abs(v));
+    const Real tiny = amax * std::numeric_limits<Real>::epsilon();
+
+    for (long i = 0; i < n; ++i)
+    {
+        const long fi = m_first[i];
+        const long li = m_start[i] - fi;
+        const long ui = m_start[i] + i - fi;
+
+        for (long j = fi; j < i; ++j)
+        {
+            const long fj = m_first[j];
+            const long uj = m_start[j] + j - fj;
+            Real s = lval[li+j];
+            for (long k = std::max(fi,fj); k < j; ++k) {
+                s -= lval[li+k]*uval[uj+k];
+            }
+            lval[li+j] = s / uval[uj+j];
+        }
+
+        for (long j = fi; j <= i; ++j)
+        {
+            const long fj = m_first[j];
+            const long lj = m_start[j] - fj;
+            Real s = uval[ui+j];
+            for (long k = std::max(fi,fj); k < j; ++k) {
+                s -= lval[lj+k]*uval[ui+k];
+            }
+            uval[ui+j] = s;
+        }
+
+        if (!(std::abs(uval[ui+i]) > tiny)) return false;
+    }
+
+    return true;
+}
+
+void
+MLDirectSolver::gatherValues (const MultiFab& b, int comp, Vector<Real>& v) const
+{
+    Vector<Real> local;
+    for (MFIter mfi(b); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const FArrayBox& fab = b[mfi];
+        for (BoxIterator bi(bx); bi.ok(); ++bi) {
+            local.push_back(fab(bi(),comp));
+        }
+    }
+
+    Vector<Real> all;
+    Vector<int> cnt, disp;
+    gatherSub(local, all, cnt, disp);
+
+    if (ParallelContext::MyProcSub() == 0) {
+        v.assign(m_nrows, 0.0);
+        for (long k = 0; k < static_cast<long>(all.size()); ++k) {
+            v[m_recv_index[k]] = all[k];
+        }
+    }
+}
+
+void
+MLDirectSolver::scatterValues (const Vector<Real>& v, int comp, MultiFab& x) const
+{
+    long nlocal = 0;
+    for (MFIter mfi(x); mfi.isValid(); ++mfi) {
+        nlocal += mfi.validbox().numPts();
+    }
+
+    Vector<Real> all;
+    if (ParallelContext::MyProcSub() == 0) {
+        all.resize(m_recv_index.size());
+        for (long k = 0; k < static_cast<long>(all.size()); ++k) {
+            all[k] = v[m_recv_index[k]];
+        }
+    }
+
+    Vector<Real> local(nlocal);
+    scatterSub(all, m_recv_cnt, m_recv_disp, local);
+
+    long k = 0;
+    for (MFIter mfi(x); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        FArrayBox& fab = x[mfi];
+        for (BoxIterator bi(bx); bi.ok(); ++bi) {
+            fab(bi(),comp) = local[k++];
+        }
+    }
+}
+
+void
+MLDirectSolver::solve (MultiFab& x, const MultiFab& b)
+{
+    BL_PROFILE("MLDirectSolver::solve()");
+
+    Vector<Real> v;
+    for (int comp = 0; comp < x.nComp(); ++comp)
+    {
+        gatherValues(b, comp, v);
+
+        if (ParallelContext::MyProcSub() == 0)
+        {
+            const long n = m_nrows;
+            Vector<Real> y(n);
+            for (long i = 0; i < n; ++i) y[i] = v[m_perm[i]];
+            if (m_pinned >= 0) y[m_pinned] = 0.0;
+
+            for (long i = 0; i < n; ++i)
+            {
+                const long fi = m_first[i];
+                const long li = m_start[i] - fi;
+                Real s = y[i];
+                for (long j = fi; j < i; ++j) s -= m_lval[li+j]*y[j];
+                y[i] = s;
+            }
+
+            for (long i = n-1; i >= 0; --i)
+            {
+                const long fi = m_first[i];
+                const long ui = m_start[i] + i - fi;
+                y[i] /= m_uval[ui+i];
+                const Real yi = y[i];
+                for (long j = fi; j < i; ++j) y[j] -= m_uval[ui+j]*yi;
+            }
+
+            for (long i = 0; i < n; ++i) v[m_perm[i]] = y[i];
+        }
+
+        scatterValues(v, comp, x);
+    }
+}
+
+}
@@ -0,0 +1,451 @@
+
+#include <cmath>
+#include <iomanip>
+
+#include <AMReX_MLKrylov.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParallelReduce.H>
+
+#ifdef AMREX_USE_EB
+#include <AMReX_EBMultiFabUtil.H>
+#endif
+
+// The Krylov iterations are done on the correction form with homogeneous
+// boundary conditions.  L(x) = A x + g, where g = L(0) is the contribution of
+// the inhomogeneous boundary conditions, so A x = L(x) - g.  Starting from
+// zero, the MLMG cycles applied to L(z) = r + g give z = M^{-1} r, with M^{-1}
+// linear in r.
+
+namespace amrex {
+
+MLKrylov::MLKrylov (MLMG& a_mlmg, Type a_type)
+    : mlmg(a_mlmg),
+      linop(a_mlmg.linop),
+      solver_type(a_type),
+      namrlevs(a_mlmg.linop.NAMRLevels()),
+      ncomp(a_mlmg.linop.getNComp())
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(linop.isCellCentered(),
+                                     "MLKrylov only supports cell-centered operators");
+}
+
+MLKrylov::~MLKrylov ()
+{}
+
+Real
+MLKrylov::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs,
+                 Real a_tol_rel, Real a_tol_abs)
+{
+    BL_PROFILE("MLKrylov::solve()");
+
+    AMREX_ASSERT(namrlevs <= a_sol.size());
+    AMREX_ASSERT(namrlevs <= a_rhs.size());
+
+    Real solve_start_time = amrex::second();
+
+    rhs.resize(namrlevs);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        if (rhs[alev].empty()) {
+            rhs[alev].define(a_rhs[alev]->boxArray(), a_rhs[alev]->DistributionMap(), ncomp, 0,
+                             MFInfo(), *linop.Factory(alev));
+        }
+        MultiFab::Copy(rhs[alev], *a_rhs[alev], 0, 0, ncomp, 0);
+    }
+
+    volfrac.resize(namrlevs);
+    volfrac[0] = 1.0;
+    for (int alev = 1; alev < namrlevs; ++alev) {
+        const Real rr = linop.AMRRefRatio(alev-1);
+        volfrac[alev] = volfrac[alev-1] / (AMREX_D_TERM(rr,*rr,*rr));
+    }
+
+    mlmg.buildFineMask();
+
+    // g = L(0)
+    makeVec(bcterm, 0);
+    makeVec(tmp, 1);
+    for (int alev = 0; alev < namrlevs; ++alev) {
+        tmp[alev].setVal(0.0);
+    }
+    mlmg.apply(GetVecOfPtrs(bcterm), GetVecOfPtrs(tmp));
+
+    if (linop.isSingular(0))
+    {
+        // Remove the part of rhs - g that is not in the range of the operator
+        for (int alev = 0; alev < namrlevs; ++alev) {
+            tmp[alev].setVal(1.0);
+        }
+        Real sums[3];
+        dotProducts({&tmp, &tmp, &tmp}, {&rhs, &bcterm, &tmp}, sums);
+        const Real offset = (sums[0]-sums[1]) / sums[2];
+        for (int alev = 0; alev < namrlevs; ++alev) {
+            rhs[alev].plus(-offset, 0, ncomp, 0);
+        }
+    }
+
+    makeVec(res, 0);
+    computeResidual(res, a_sol);
+
+    Real norms[2];
+    dotProducts({&res, &rhs}, {&res, &rhs}, norms);
+    const Real resnorm0 = std::sqrt(norms[0]);
+    const Real rhsnorm0 = std::sqrt(norms[1]);
+
+    if (verbose >= 1)
+    {
+        amrex::Print() << "MLKrylov: Initial rhs               = " << rhsnorm0 << "\n"
+                       << "MLKrylov: Initial residual (resid0) = " << resnorm0 << "\n";
+    }
+
+    if (rhsnorm0 >= resnorm0) {
+        norm_name = "bnorm";
+        max_norm = rhsnorm0;
+    } else {
+        norm_name = "resid0";
+        max_norm = resnorm0;
+    }
+    res_target = std::max(a_tol_abs, std::max(a_tol_rel,1.e-16)*max_norm);
+
+    num_iters = 0;
+
+    Real resnorm;
+    if (resnorm0 <= res_target) {
+        resnorm = resnorm0;
+        if (verbose >= 1) {
+            amrex::Print() << "MLKrylov: No iterations needed\n";
+        }
+    } else {
+        if (solver_type == Type::FGMRES) {
+            resnorm = solve_fgmres(a_sol, resnorm0);
+        } else {
+            resnorm = solve_pcg(a_sol, resnorm0);
+        }
+
+        if (resnorm > res_target) {
+            if (verbose > 0) {
+                amrex::Print() << "MLKrylov: Failed to converge after " << num_iters << " iterations."
+                               << " resid, resid/" << norm_name << " = "
+                               << resnorm << ", " << resnorm/max_norm << "\n";
+            }
+            amrex::Abort("MLKrylov failed");
+        }
+
+        if (verbose >= 1) {
+            amrex::Print() << "MLKrylov: Final Iter. " << num_iters
+                           << " resid, resid/" << norm_name << " = "
+                           << resnorm << ", " << resnorm/max_norm << "\n";
+        }
+    }
+
+    // Make the solution under the fine levels consistent with them
+    for (int alev = namrlevs-1; alev > 0; --alev)
+    {
+#ifdef AMREX_USE_EB
+        amrex::EB_average_down(*a_sol[alev], *a_sol[alev-1], 0, ncomp, linop.AMRRefRatio(alev-1));
+#else
+        amrex::average_down(*a_sol[alev], *a_sol[alev-1], 0, ncomp, linop.AMRRefRatio(alev-1));
+#endif
+    }
+
+    if (verbose >= 1) {
+        Real solve_time = amrex::second() - solve_start_time;
+        ParallelReduce::Max<Real>(solve_time, 0, ParallelContext::CommunicatorSub());
+        amrex::Print() << "MLKrylov: Solve time = " << solve_time << "\n";
+    }
+
+    return resnorm;
+}
+
+// Flexible GMRES (Saad 1993) with restarts.  The new basis vector is
+// orthogonalized with two passes of classical Gram-Schmidt, so that each
+// pass is a single reduction.
+Real
+MLKrylov::solve_fgmres (const Vector<MultiFab*>& a_sol, Real resnorm0)
+{
+    BL_PROFILE("MLKrylov::fgmres");
+
+    const int m = restart_length;
+
+    Vector<MLVec> V(m+1);
+    Vector<MLVec> Z(m);
+    MLVec w;
+    makeVec(w, 0);
+
+    Vector<Real> H((m+1)*m);
+    auto Hij = [&H,m] (int i, int j) -> Real& { return H[i+j*(m+1)]; };
+    Vector<Real> cs(m), sn(m), s(m+1), y(m), h(m+1);
+
+    Real resnorm = resnorm0;
+
+    while (num_iters < max_iters && resnorm > res_target)
+    {
+        if (V[0].empty()) makeVec(V[0], 0);
+        for (int alev = 0; alev < namrlevs; ++alev) {
+            MultiFab::Copy(V[0][alev], res[alev], 0, 0, ncomp, 0);
+            V[0][alev].mult(1.0/resnorm, 0, ncomp);
+        }
+
+        std::fill(H.begin(), H.end(), 0.0);
+        std::fill(s.begin(), s.end(), 0.0);
+        s[0] = resnorm;
+
+        int k = 0;
+        while (k < m && num_iters < max_iters)
+        {
+            if (Z[k].empty()) makeVec(Z[k], 1);
+            applyPrecond(Z[k], V[k]);
+            applyHomogeneous(w, Z[k]);
+
+            Vector<MLVec const*> xs, ys;
+            for (int i = 0; i <= k; ++i) {
+                xs.push_back(&V[i]);
+                ys.push_back(&w);
+            }
+
+            dotProducts(xs, ys, h.data());
+            for (int i = 0; i <= k; ++i) {
+                Hij(i,k) = h[i];
+                saxpy(w, -h[i], V[i]);
+            }
+
+            // Second pass, together with the norm of w before it.  The
+            // correction is small, so |w|^2 - |h|^2 does not cancel.
+            xs.push_back(&w);
+            ys.push_back(&w);
+            dotProducts(xs, ys, h.data());
+            Real wnorm2 = h[k+1];
+            for (int i = 0; i <= k; ++i) {
+                Hij(i,k) += h[i];
+                saxpy(w, -h[i], V[i]);
+                wnorm2 -= h[i]*h[i];
+            }
+            const Real wnorm = (wnorm2 > 0.0) ? std::sqrt(wnorm2) : norm2(w);
+            Hij(k+1,k) = wnorm;
+
+            for (int i = 0; i < k; ++i) {
+                const Real t = cs[i]*Hij(i,k) + sn[i]*Hij(i+1,k);
+                Hij(i+1,k) = -sn[i]*Hij(i,k) + cs[i]*Hij(i+1,k);
+                Hij(i,k) = t;
+            }
+            const Real d = std::sqrt(Hij(k,k)*Hij(k,k) + wnorm*wnorm);
+            cs[k] = Hij(k,k) / d;
+            sn[k] = wnorm / d;
+            Hij(k,k) = d;
+            Hij(k+1,k) = 0.0;
+            s[k+1] = -sn[k]*s[k];
+            s[k]   =  cs[k]*s[k];
+
+            resnorm = std::abs(s[k+1]);
+            ++k;
+            ++num_iters;
+
+            if (verbose >= 2) {
+                amrex::Print() << "MLKrylov: Iteration " << std::setw(3) << num_iters << " resid/"
+                               << norm_name << " = " << resnorm/max_norm << "\n";
+            }
+
+            if (resnorm <= res_target || wnorm == 0.0) break;
+
+            if (k < m) {
+                if (V[k].empty()) makeVec(V[k], 0);
+                for (int alev = 0; alev < namrlevs; ++alev) {
+                    MultiFab::Copy(V[k][alev], w[alev], 0, 0, ncomp, 0);
+                    V[k][alev].mult(1.0/wnorm, 0, ncomp);
+                }
+            }
+        }
+
+        for (int i = k-1; i >= 0; --i) {
+            Real t = s[i];
+            for (int j = i+1; j < k; ++j) {
+                t -= Hij(i,j)*y[j];
+            }
+            y[i] = t / Hij(i,i);
+        }
+        for (int i = 0; i < k; ++i) {
+            saxpy(a_sol, y[i], Z[i]);
+        }
+
+        computeResidual(res, a_sol);
+        resnorm = norm2(res);
+    }
+
+    return resnorm;
+}
+
+// Flexible preconditioned CG (Notay 2000).  The new residual norm is
+// updated from products fused with (p,Ap), and the products that give beta
+// are fused with (r,r), so there are two reductions per iteration.  The
+// residual is recomputed once the updated norm has converged.
+Real
+MLKrylov::solve_pcg (const Vector<MultiFab*>& a_sol, Real resnorm0)
+{
+    BL_PROFILE("MLKrylov::pcg");
+
+    MLVec z, p, q;
+    makeVec(z, 1);
+    makeVec(p, 1);
+    makeVec(q, 0);
+
+    MLVec& r = res;
+
+    Real resnorm = resnorm0;
+    Real rr = resnorm*resnorm;
+    Real rz = 0.0;
+    bool restart = true;
+
+    while (num_iters < max_iters)
+    {
+        if (restart)
+        {
+            applyPrecond(z, r);
+            dotProducts({&r}, {&z}, &rz);
+            for (int alev = 0; alev < namrlevs; ++alev) {
+                MultiFab::Copy(p[alev], z[alev], 0, 0, ncomp, 0);
+            }
+            restart = false;
+        }
+
+        applyHomogeneous(q, p);
+
+        Real d[3];
+        dotProducts({&p, &r, &q}, {&q, &q, &q}, d);
+        if (d[0] <= 0.0) {
+            if (verbose >= 1) {
+                amrex::Print() << "MLKrylov: PCG breakdown, (p,Ap) = " << d[0] << "\n";
+            }
+            break;
+        }
+
+        const Real alpha = rz / d[0];
+        saxpy(a_sol, alpha, p);
+        saxpy(r, -alpha, q);
+        rr += alpha*(alpha*d[2] - 2.0*d[1]);
+        resnorm = std::sqrt(std::max(rr, 0.0));
+        ++num_iters;
+
+        if (verbose >= 2) {
+            amrex::Print() << "MLKrylov: Iteration " << std::setw(3) << num_iters << " resid/"
+                           << norm_name << " = " << resnorm/max_norm << "\n";
+        }
+
+        if (resnorm <= res_target)
+        {
+            computeResidual(r, a_sol);
+            resnorm = norm2(r);
+            rr = resnorm*resnorm;
+            if (resnorm <= res_target) break;
+            restart = true;
+            continue;
+        }
+
+        applyPrecond(z, r);
+
+        // (r,r) is refreshed here, so the update above never accumulates
+        // round-off over more than one iteration.
+        Real e[3];
+        dotProducts({&z, &z, &r}, {&r, &q, &r}, e);
+        const Real beta = -alpha*e[1] / rz;
+        rz = e[0];
+        rr = e[2];
+        for (int alev = 0; alev < namrlevs; ++alev) {
+            MultiFab::Xpay(p[alev], beta, z[alev], 0, 0, ncomp, 0);
+        }
+    }
+
+    return resnorm;
+}
+
+void
+MLKrylov::makeVec (MLVec& v, int ng) const
+{
+    v.resize(namrlevs);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        if (v[alev].empty()) {
+            v[alev].define(rhs[alev].boxArray(), rhs[alev].DistributionMap(), ncomp, ng,
+                           MFInfo(), *linop.Factory(alev));
+        }
+    }
+}
+
+void
+MLKrylov::computeResidual (MLVec& r, const Vector<MultiFab*>& a_sol)
+{
+    mlmg.apply(GetVecOfPtrs(r), a_sol);
+    for (int alev = 0; alev < namrlevs; ++alev) {
+        MultiFab::Xpay(r[alev], -1.0, rhs[alev], 0, 0, ncomp, 0);
+    }
+}
+
+void
+MLKrylov::applyHomogeneous (MLVec& y, MLVec& x)
+{
+    mlmg.apply(GetVecOfPtrs(y), GetVecOfPtrs(x));
+    for (int alev = 0; alev < namrlevs; ++alev) {
+        MultiFab::Subtract(y[alev], bcterm[alev], 0, 0, ncomp, 0);
+    }
+}
+
+void
+MLKrylov::applyPrecond (MLVec& z, const MLVec& r)
+{
+    BL_PROFILE("MLKrylov::precond");
+    makeVec(tmp, 1);
+    for (int alev = 0; alev < namrlevs; ++alev) {
+        MultiFab::LinComb(tmp[alev], 1.0, r[alev], 0, 1.0, bcterm[alev], 0, 0, ncomp, 0);
+        z[alev].setVal(0.0);
+    }
+    mlmg.precond(GetVecOfPtrs(z), GetVecOfConstPtrs(tmp), precond_iters);
+}
+
+void
+MLKrylov::dotProducts (const Vector<MLVec const*>& xs, const Vector<MLVec const*>& ys,
+                       Real* result) const
+{
+    BL_PROFILE("MLKrylov::dotProducts");
+
+    AMREX_ASSERT(xs.size() == ys.size());
+    const int n = xs.size();
+    for (int i = 0; i < n; ++i)
+    {
+        result[i] = 0.0;
+        for (int alev = 0; alev < namrlevs; ++alev)
+        {
+            const MultiFab& x = (*xs[i])[alev];
+            const MultiFab& y = (*ys[i])[alev];
+            const iMultiFab* mask = (alev < namrlevs-1) ? mlmg.fine_mask[alev].get() : nullptr;
+            const Real r = mask ? MultiFab::Dot(*mask, x, 0, y, 0, ncomp, 0, true)
+                                : MultiFab::Dot(x, 0, y, 0, ncomp, 0, true);
+            result[i] += volfrac[alev] * r;
+        }
+    }
+    ParallelAllReduce::Sum(result, n, ParallelContext::CommunicatorSub());
+}
+
+Real
+MLKrylov::norm2 (const MLVec& x) const
+{
+    Real r;
+    dotProducts({&x}, {&x}, &r);
+    return std::sqrt(r);
+}
+
+void
+MLKrylov::saxpy (MLVec& y, Real a, const MLVec& x)
+{
+    for (int alev = 0; alev < static_cast<int>(y.size()); ++alev) {
+        MultiFab::Saxpy(y[alev], a, x[alev], 0, 0, y[alev].nComp(), 0);
+    }
+}
+
+void
+MLKrylov::saxpy (const Vector<MultiFab*>& y, Real a, const MLVec& x)
+{
+    for (int alev = 0; alev < static_cast<int>(x.size()); ++alev) {
+        MultiFab::Saxpy(*y[alev], a, x[alev], 0, 0, x[alev].nComp(), 0);
+    }
+}
+
+}
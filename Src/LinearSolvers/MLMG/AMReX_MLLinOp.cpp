@@ -517,6 +517,180 @@ MLLinOp::setCoarseFineBC (const MultiFab* crse, int crse_ratio) noexcept
     m_coarse_data_crse_ratio = crse_ratio;
 }
 
+bool
+MLLinOp::hasSameGrids (const Vector<Geometry>& a_geom,
+                       const Vector<BoxArray>& a_grids,
+                       const Vector<DistributionMapping>& a_dmap) const noexcept
+{
+    if (static_cast<int>(a_geom.size()) != m_num_amr_levels ||
+        static_cast<int>(a_grids.size()) != m_num_amr_levels ||
+        static_cast<int>(a_dmap.size()) != m_num_amr_levels) {
+        return false;
+    }
+    for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
+    {
+        if (a_geom[amrlev].Domain() != m_geom[amrlev][0].Domain() ||
+            a_grids[amrlev] != m_grids[amrlev][0] ||
+            a_dmap[amrlev] != m_dmap[amrlev][0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MLLinOp::setSmoother (MLSmoother a_smoother, int chebyshev_degree) noexcept
+{
+    m_smoother = a_smoother;
+    m_cheby_degree = std::max(chebyshev_degree, 1);
+}
+
+void
+MLLinOp::prepareChebyshev ()
+{
+    m_cheby_lambda.clear();
+    if (!useChebyshev()) return;
+
+    BL_PROFILE("MLLinOp::prepareChebyshev()");
+
+    m_cheby_lambda.resize(m_num_amr_levels);
+    for (int alev = 0; alev < m_num_amr_levels; ++alev)
+    {
+        m_cheby_lambda[alev].resize(m_num_mg_levels[alev], 0.0);
+        for (int mlev = 0; mlev < m_num_mg_levels[alev]; ++mlev)
+        {
+            // The bottom level may live on fewer ranks.  Its estimate is
+            // done on the bottom communicator, as the bottom solve is, so
+            // that the other ranks do not fall behind in message tags.
+            const bool bottom = (alev == 0 && mlev == m_num_mg_levels[0]-1);
+            if (bottom) {
+                if (!isBottomActive()) continue;
+                ParallelContext::push(BottomCommunicator());
+            }
+            m_cheby_lambda[alev][mlev] = estimateMaxEigenvalue(alev, mlev);
+            if (bottom) {
+                ParallelContext::pop();
+            }
+            if (verbose >= 2) {
+                amrex::Print() << "MLLinOp: Chebyshev smoother at level " << alev << " " << mlev
+                               << ": max eigenvalue " << m_cheby_lambda[alev][mlev] << "\n";
+            }
+        }
+    }
+}
+
+Real
+MLLinOp::estimateMaxEigenvalue (int amrlev, int mglev) const
+{
+    BL_PROFILE("MLLinOp::estimateMaxEigenvalue()");
+
+    const int ncomp = getNComp();
+    const BoxArray& ba = amrex::convert(m_grids[amrlev][mglev], m_ixtype);
+    const DistributionMapping& dm = m_dmap[amrlev][mglev];
+    MultiFab x(ba, dm, ncomp, 1, MFInfo(), *m_factory[amrlev][mglev]);
+    MultiFab y(ba, dm, ncomp, 0, MFInfo(), *m_factory[amrlev][mglev]);
+
+    // Start from a reproducible pseudo-random vector so that the high
+    // frequency modes are present.
+    x.setVal(0.0);
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(x, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& xfab = x.array(mfi);
+        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            Real h = std::sin(12.9898*i + 78.233*j + 37.719*k + 4.1414*n) * 43758.5453;
+            xfab(i,j,k,n) = 2.0*(h - std::floor(h)) - 1.0;
+        });
+    }
+
+    const MPI_Comm comm = Communicator(amrlev, mglev);
+    auto norminf = [=] (const MultiFab& mf) -> Real {
+        Real r = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            r = std::max(r, mf.norm0(n, 0, true));
+        }
+        ParallelAllReduce::Max(r, comm);
+        return r;
+    };
+
+    const int niters = 10;
+    Real xnorm = norminf(x);
+    Real ynorm = 0.0;
+    for (int iter = 0; iter < niters; ++iter)
+    {
+        if (xnorm == 0.0) return 0.0;
+        x.mult(1.0/xnorm, 0, ncomp);
+        apply(amrlev, mglev, y, x, BCMode::Homogeneous, StateMode::Correction);
+        normalize(amrlev, mglev, y);
+        ynorm = norminf(y);
+        if (iter+1 < niters) {
+            MultiFab::Copy(x, y, 0, 0, ncomp, 0);
+            xnorm = ynorm;
+        }
+    }
+
+    // Some operators (e.g., MLPoisson) are negative definite and do not
+    // rescale in normalize, so the sign is taken from x.y.
+    Real xdoty = MultiFab::Dot(x, 0, y, 0, ncomp, 0, true);
+    ParallelAllReduce::Sum(xdoty, comm);
+    return (xdoty < 0.0) ? -ynorm : ynorm;
+}
+
+void
+MLLinOp::chebyshevSmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                          int degree) const
+{
+    BL_PROFILE("MLLinOp::chebyshevSmooth()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(amrlev < static_cast<int>(m_cheby_lambda.size()) &&
+                                     mglev < static_cast<int>(m_cheby_lambda[amrlev].size()),
+                                     "MLLinOp::chebyshevSmooth: no eigenvalue estimate, "
+                                     "setSmoother must be called before the first solve");
+
+    const Real lambda = m_cheby_lambda[amrlev][mglev];
+    if (lambda == 0.0 || degree <= 0) return;
+
+    // Damp the modes in [lo,hi].  The upper bound has a safety factor
+    // because the power iterations underestimate the eigenvalue.  For a
+    // negative lambda the interval is mirrored and the recurrence below
+    // is unchanged.
+    const Real hi = 1.1*lambda;
+    const Real lo = 0.1*lambda;
+    const Real theta = 0.5*(hi+lo);
+    const Real delta = 0.5*(hi-lo);
+    const Real sigma = theta/delta;
+    Real rho = 1.0/sigma;
+
+    const int ncomp = getNComp();
+    MultiFab r(sol.boxArray(), sol.DistributionMap(), ncomp, 0, MFInfo(), sol.Factory());
+    MultiFab d(sol.boxArray(), sol.DistributionMap(), ncomp, 0, MFInfo(), sol.Factory());
+
+    // r = D^{-1} (rhs - L(sol))
+    auto jacobiResidual = [&] () {
+        apply(amrlev, mglev, r, sol, BCMode::Homogeneous, StateMode::Correction);
+        MultiFab::Xpay(r, -1.0, rhs, 0, 0, ncomp, 0);
+        normalize(amrlev, mglev, r);
+    };
+
+    jacobiResidual();
+    MultiFab::Copy(d, r, 0, 0, ncomp, 0);
+    d.mult(1.0/theta, 0, ncomp);
+
+    for (int k = 0; k < degree; ++k)
+    {
+        MultiFab::Add(sol, d, 0, 0, ncomp, 0);
+        if (k+1 == degree) break;
+        jacobiResidual();
+        const Real rho_new = 1.0/(2.0*sigma - rho);
+        MultiFab::LinComb(d, rho_new*rho, d, 0, 2.0*rho_new/delta, r, 0, 0, ncomp, 0);
+        rho = rho_new;
+    }
+}
+
 MPI_Comm
 MLLinOp::makeSubCommunicator (const DistributionMapping& dm)
 {
@@ -1,5 +1,6 @@
 #include <AMReX_MLMG.H>
 #include <AMReX_MultiFabUtil.H>
+#include <AMReX_Reduce.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_BC_TYPES.H>
 #include <AMReX_MLMG_F.H>
@@ -59,15 +60,6 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         checkPoint(a_sol, a_rhs, a_tol_rel, a_tol_abs, checkpoint_file);
     }
 
-    if (bottom_solver == BottomSolver::Default) {
-        bottom_solver = linop.getDefaultBottomSolver();
-    }
-
-    if (bottom_solver == BottomSolver::hypre) {
-        int mo = linop.getMaxOrder();
-        linop.setMaxOrder(std::min(3,mo));  // maxorder = 4 not supported
-    }
-    
     bool is_nsolve = linop.m_parent;
 
     Real solve_start_time = amrex::second();
@@ -75,23 +67,40 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     Real composite_norminf;
 
     prepareForSolve(a_sol, a_rhs);
+    timer[setup_time] = amrex::second() - solve_start_time;
 
     computeMLResidual(finest_amr_lev);
 
     int ncomp = linop.getNComp();
 
-    bool local = true;
-    Real resnorm0 = MLResNormInf(finest_amr_lev, local); 
-    Real rhsnorm0 = MLRhsNormInf(local); 
-    if (!is_nsolve) {
-        ParallelAllReduce::Max<Real>({resnorm0, rhsnorm0}, ParallelContext::CommunicatorSub());
+    // Components that are independent problems are converged separately.
+    const bool comp_converge = (ncomp > 1 && linop.hasIndependentComponents() && !is_nsolve);
 
-        if (verbose >= 1)
-        {
-            amrex::Print() << "MLMG: Initial rhs               = " << rhsnorm0 << "\n"
-                           << "MLMG: Initial residual (resid0) = " << resnorm0 << "\n";
+    bool local = true;
+    Real resnorm0, rhsnorm0;
+    Vector<Real> resnorm0_comp, rhsnorm0_comp;
+    if (comp_converge) {
+        // Norms of all components in one reduction
+        Vector<Real> norms = MLResNormInfComp(finest_amr_lev, local);
+        Vector<Real> rhsnorms = MLRhsNormInfComp(local);
+        norms.insert(norms.end(), rhsnorms.begin(), rhsnorms.end());
+        ParallelAllReduce::Max(norms.data(), norms.size(), ParallelContext::CommunicatorSub());
+        resnorm0_comp.assign(norms.begin(), norms.begin()+ncomp);
+        rhsnorm0_comp.assign(norms.begin()+ncomp, norms.end());
+        resnorm0 = *std::max_element(resnorm0_comp.begin(), resnorm0_comp.end());
+        rhsnorm0 = *std::max_element(rhsnorm0_comp.begin(), rhsnorm0_comp.end());
+    } else {
+        resnorm0 = MLResNormInf(finest_amr_lev, local); 
+        rhsnorm0 = MLRhsNormInf(local); 
+        if (!is_nsolve) {
+            ParallelAllReduce::Max<Real>({resnorm0, rhsnorm0}, ParallelContext::CommunicatorSub());
         }
     }
+    if (!is_nsolve && verbose >= 1)
+    {
+        amrex::Print() << "MLMG: Initial rhs               = " << rhsnorm0 << "\n"
+                       << "MLMG: Initial residual (resid0) = " << resnorm0 << "\n";
+    }
 
     Real max_norm;
     std::string norm_name;
@@ -104,7 +113,33 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     }
     const Real res_target = std::max(a_tol_abs, std::max(a_tol_rel,1.e-16)*max_norm);
 
-    if (!is_nsolve && resnorm0 <= res_target) {
+    Vector<Real> res_target_comp;
+    if (comp_converge) {
+        res_target_comp.resize(ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            const Real comp_norm = (always_use_bnorm or rhsnorm0_comp[n] >= resnorm0_comp[n])
+                ? rhsnorm0_comp[n] : resnorm0_comp[n];
+            res_target_comp[n] = std::max(a_tol_abs, std::max(a_tol_rel,1.e-16)*comp_norm);
+        }
+        comp_final_norminf = resnorm0_comp;
+        comp_num_iters.assign(ncomp, 0);
+    } else {
+        comp_final_norminf.clear();
+        comp_num_iters.clear();
+    }
+
+    auto comps_converged = [&] (const Vector<Real>& norms) -> bool
+    {
+        for (int n = 0; n < ncomp; ++n) {
+            if (norms[n] > res_target_comp[n]) return false;
+        }
+        return true;
+    };
+
+    const bool initially_converged = comp_converge ? comps_converged(resnorm0_comp)
+                                                   : (resnorm0 <= res_target);
+
+    if (!is_nsolve && initially_converged) {
         composite_norminf = resnorm0;
         if (verbose >= 1) {
             amrex::Print() << "MLMG: No iterations needed\n";
@@ -125,37 +160,70 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
 
             if (is_nsolve) continue;
 
-            Real fine_norminf = ResNormInf(finest_amr_lev);
+            Real fine_norminf;
+            Vector<Real> fine_norminf_comp;
+            bool fine_converged;
+            if (comp_converge) {
+                fine_norminf_comp = ResNormInfComp(finest_amr_lev);
+                fine_norminf = *std::max_element(fine_norminf_comp.begin(), fine_norminf_comp.end());
+                fine_converged = comps_converged(fine_norminf_comp);
+                for (int n = 0; n < ncomp; ++n) {
+                    if (comp_num_iters[n] == 0 && fine_norminf_comp[n] <= res_target_comp[n]) {
+                        comp_num_iters[n] = iter+1;
+                    }
+                }
+            } else {
+                fine_norminf = ResNormInf(finest_amr_lev);
+                fine_converged = (fine_norminf <= res_target);
+            }
             composite_norminf = fine_norminf;
             if (verbose >= 2) {
                 amrex::Print() << "MLMG: Iteration " << std::setw(3) << iter+1 << " Fine resid/"
                                << norm_name << " = " << fine_norminf/max_norm << "\n";
             }
-            bool fine_converged = (fine_norminf <= res_target);
 
             if (namrlevs == 1 and fine_converged) {
                 converged = true;
             } else if (fine_converged) {
                 // finest level is converged, but we still need to test the coarse levels
                 computeMLResidual(finest_amr_lev-1);
-                Real crse_norminf = MLResNormInf(finest_amr_lev-1);
+                Real crse_norminf;
+                if (comp_converge) {
+                    Vector<Real> crse_norminf_comp = MLResNormInfComp(finest_amr_lev-1);
+                    crse_norminf = *std::max_element(crse_norminf_comp.begin(), crse_norminf_comp.end());
+                    converged = comps_converged(crse_norminf_comp);
+                    for (int n = 0; n < ncomp; ++n) {
+                        fine_norminf_comp[n] = std::max(fine_norminf_comp[n], crse_norminf_comp[n]);
+                    }
+                } else {
+                    crse_norminf = MLResNormInf(finest_amr_lev-1);
+                    converged = (crse_norminf <= res_target);
+                }
                 if (verbose >= 2) {
                     amrex::Print() << "MLMG: Iteration " << std::setw(3) << iter+1
                                    << " Crse resid/" << norm_name << " = "
                                    << crse_norminf/max_norm << "\n";
                 }
-                converged = (crse_norminf <= res_target);
                 composite_norminf = std::max(fine_norminf, crse_norminf);
             } else {
                 converged = false;
             }
 
+            if (comp_converge) {
+                comp_final_norminf = fine_norminf_comp;
+            }
+
             if (converged) {
                 if (verbose >= 1) {
                     amrex::Print() << "MLMG: Final Iter. " << iter+1
                                    << " resid, resid/" << norm_name << " = "
                                    << composite_norminf << ", "
                                    << composite_norminf/max_norm << "\n";
+                    for (int n = 0; n < static_cast<int>(comp_num_iters.size()); ++n) {
+                        amrex::Print() << "MLMG:   Component " << n << " converged at Iter. "
+                                       << comp_num_iters[n] << ", resid = "
+                                       << comp_final_norminf[n] << "\n";
+                    }
                 }
                 break;
             }
@@ -188,6 +256,7 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         if (ParallelContext::MyProcSub() == 0)
         {
             amrex::AllPrint() << "MLMG: Timers: Solve = " << timer[solve_time]
+                              << " Setup = " << timer[setup_time]
                               << " Iter = " << timer[iter_time]
                               << " Bottom = " << timer[bottom_time] << "\n";
         }
@@ -198,6 +267,36 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     return composite_norminf;
 }
 
+// Run a fixed number of cycles on a_sol without testing for convergence.
+// Starting from zero, the result depends linearly on a_rhs minus the
+// contribution of the inhomogeneous boundary conditions (see MLKrylov).
+void
+MLMG::precond (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs, int a_niters)
+{
+    BL_PROFILE("MLMG::precond()");
+
+    prepareForSolve(a_sol, a_rhs);
+
+    computeMLResidual(finest_amr_lev);
+
+    for (int iter = 0; iter < a_niters; ++iter)
+    {
+        if (iter > 0) computeResidual(finest_amr_lev);
+        oneIter(iter);
+    }
+
+    const int ncomp = linop.getNComp();
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        if (a_sol[alev] != sol[alev])
+        {
+            MultiFab::Copy(*a_sol[alev], *sol[alev], 0, 0, ncomp, 0);
+        }
+    }
+
+    ++solve_called;
+}
+
 // in  : Residual (res) on the finest AMR level
 // out : sol on all AMR levels
 void MLMG::oneIter (int iter)
@@ -387,6 +486,25 @@ std::string make_str (Ts... xs) {
     return oss.str();
 }
 
+// Copy the valid region of src into dst, converting between precisions.
+template <class DFAB, class SFAB>
+void convert_precision (FabArray<DFAB>& dst, FabArray<SFAB> const& src, int ncomp)
+{
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        auto const d = dst.array(mfi);
+        auto const s = src.array(mfi);
+        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            d(i,j,k,n) = s(i,j,k,n);
+        });
+    }
+}
+
 }
 
 // in   : Residual (res) 
@@ -396,6 +514,11 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
 {
     BL_PROFILE("MLMG::mgVcycle()");
 
+    if (use_mixed_precision) {
+        mgVcycleSP(amrlev, mglev_top);
+        return;
+    }
+
     const int mglev_bottom = linop.NMGLevels(amrlev) - 1;
 
     for (int mglev = mglev_top; mglev < mglev_bottom; ++mglev)
@@ -412,11 +535,8 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
 
         cor[amrlev][mglev]->setVal(0.0);
         bool skip_fillboundary = true;
-        for (int i = 0; i < nu1; ++i) {
-            linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
-                         skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothMulti(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
+                          nu1, skip_fillboundary);
 
         // rescor = res - L(cor)
         computeResOfCorrection(amrlev, mglev);
@@ -461,11 +581,8 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
         }
         cor[amrlev][mglev_bottom]->setVal(0.0);
         bool skip_fillboundary = true;
-        for (int i = 0; i < nu1; ++i) {
-            linop.smooth(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom], res[amrlev][mglev_bottom],
-                         skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothMulti(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom], res[amrlev][mglev_bottom],
+                          nu1, skip_fillboundary);
         if (verbose >= 4)
         {
 	    computeResOfCorrection(amrlev, mglev_bottom);
@@ -489,9 +606,7 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
             amrex::Print() << "AT LEVEL "  << amrlev << " " << mglev
                            << "   UP: Norm before smooth " << norm << "\n";
         }
-        for (int i = 0; i < nu2; ++i) {
-            linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev]);
-        }
+        linop.smoothMulti(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev], nu2);
 
 	if (cf_strategy == CFStrategy::ghostnodes) computeResOfCorrection(amrlev, mglev);
 
@@ -505,6 +620,67 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
     }
 }
 
+// Same as mgVcycle, but with the correction hierarchy in single precision.
+// in   : Residual (res)
+// out  : Correction (cor) from bottom to this function's local top
+void
+MLMG::mgVcycleSP (int amrlev, int mglev_top)
+{
+    BL_PROFILE("MLMG::mgVcycleSP()");
+
+    const int mglev_bottom = linop.NMGLevels(amrlev) - 1;
+    const int ncomp = linop.getNComp();
+
+    convert_precision(res_sp[amrlev][mglev_top], res[amrlev][mglev_top], ncomp);
+
+    for (int mglev = mglev_top; mglev < mglev_bottom; ++mglev)
+    {
+        cor_sp[amrlev][mglev].setVal(0.0);
+        bool skip_fillboundary = true;
+        for (int i = 0; i < nu1; ++i) {
+            linop.smoothSP(amrlev, mglev, cor_sp[amrlev][mglev], res_sp[amrlev][mglev],
+                           skip_fillboundary);
+            skip_fillboundary = false;
+        }
+
+        // rescor = res - L(cor)
+        linop.correctionResidualSP(amrlev, mglev, rescor_sp[amrlev][mglev],
+                                   cor_sp[amrlev][mglev], res_sp[amrlev][mglev]);
+
+        // res_crse = R(rescor_fine)
+        linop.restrictionSP(amrlev, mglev+1, res_sp[amrlev][mglev+1], rescor_sp[amrlev][mglev]);
+    }
+
+    if (amrlev == 0)
+    {
+        // The bottom solve is done in full precision.
+        convert_precision(res[amrlev][mglev_bottom], res_sp[amrlev][mglev_bottom], ncomp);
+        bottomSolve();
+        convert_precision(cor_sp[amrlev][mglev_bottom], *cor[amrlev][mglev_bottom], ncomp);
+    }
+    else
+    {
+        cor_sp[amrlev][mglev_bottom].setVal(0.0);
+        bool skip_fillboundary = true;
+        for (int i = 0; i < nu1; ++i) {
+            linop.smoothSP(amrlev, mglev_bottom, cor_sp[amrlev][mglev_bottom],
+                           res_sp[amrlev][mglev_bottom], skip_fillboundary);
+            skip_fillboundary = false;
+        }
+    }
+
+    for (int mglev = mglev_bottom-1; mglev >= mglev_top; --mglev)
+    {
+        // cor_fine += I(cor_crse)
+        addInterpCorrectionSP(amrlev, mglev);
+        for (int i = 0; i < nu2; ++i) {
+            linop.smoothSP(amrlev, mglev, cor_sp[amrlev][mglev], res_sp[amrlev][mglev]);
+        }
+    }
+
+    convert_precision(*cor[amrlev][mglev_top], cor_sp[amrlev][mglev_top], ncomp);
+}
+
 // FMG cycle on the coarsest AMR level.
 // in:  Residual on the top MG level (i.e., 0)
 // out: Correction (cor) on all MG levels
@@ -854,6 +1030,37 @@ MLMG::addInterpCorrection (int alev, int mglev)
     linop.interpolation(alev, mglev, fine_cor, *cmf);
 }
 
+void
+MLMG::addInterpCorrectionSP (int alev, int mglev)
+{
+    BL_PROFILE("MLMG::addInterpCorrectionSP()");
+
+    const int ncomp = linop.getNComp();
+
+    const MLLinOp::SPMultiFab& crse_cor = cor_sp[alev][mglev+1];
+    MLLinOp::SPMultiFab&       fine_cor = cor_sp[alev][mglev  ];
+
+    const int refratio = 2;
+    MLLinOp::SPMultiFab cfine;
+    const MLLinOp::SPMultiFab* cmf;
+
+    if (amrex::isMFIterSafe(crse_cor, fine_cor))
+    {
+        cmf = &crse_cor;
+    }
+    else
+    {
+        BoxArray cba = fine_cor.boxArray();
+        cba.coarsen(refratio);
+        const int ng = 0;
+        cfine.define(cba, fine_cor.DistributionMap(), ncomp, ng);
+        cfine.ParallelCopy(crse_cor);
+        cmf = &cfine;
+    }
+
+    linop.interpolationSP(alev, mglev, fine_cor, *cmf);
+}
+
 // Compute rescor = res - L(cor)
 // in   : res
 // inout: cor (out due to FillBoundary in linop.correctionResidual)
@@ -923,10 +1130,7 @@ MLMG::actualBottomSolve ()
     {
 
         bool skip_fillboundary = true;
-        for (int i = 0; i < nuf; ++i) {
-            linop.smooth(amrlev, mglev, x, b, skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothMulti(amrlev, mglev, x, b, nuf, skip_fillboundary);
     }
     else
     {
@@ -942,7 +1146,21 @@ MLMG::actualBottomSolve ()
             makeSolvable(amrlev,mglev,*bottom_b);
         }
 
-        if (bottom_solver == BottomSolver::hypre)
+        if (bottom_solver == BottomSolver::direct && bottomSolveWithDirect(x, *bottom_b) != 0)
+        {
+            // The bottom problem is too big for the direct solver or the
+            // factorization hit a zero pivot.  Switch permanently.
+            bottom_solver = BottomSolver::bicgstab;
+            if (verbose > 1) {
+                amrex::Print() << "MLMG: Direct bottom solver failed, switching to bicgstab.\n";
+            }
+        }
+
+        if (bottom_solver == BottomSolver::direct)
+        {
+            // Done in bottomSolveWithDirect
+        }
+        else if (bottom_solver == BottomSolver::hypre)
         {
             bottomSolveWithHypre(x, *bottom_b);
         }
@@ -956,6 +1174,10 @@ MLMG::actualBottomSolve ()
             if (bottom_solver == BottomSolver::cg ||
                 bottom_solver == BottomSolver::cgbicg) {
                 cg_type = MLCGSolver::Type::CG;
+            } else if (bottom_solver == BottomSolver::pipecg) {
+                cg_type = MLCGSolver::Type::PipeCG;
+            } else if (bottom_solver == BottomSolver::pipebicgstab) {
+                cg_type = MLCGSolver::Type::PipeBiCGStab;
             } else {
                 cg_type = MLCGSolver::Type::BiCGStab;
             }
@@ -983,9 +1205,7 @@ MLMG::actualBottomSolve ()
                 }
             }
             const int n = (ret==0) ? nub : nuf;
-            for (int i = 0; i < n; ++i) {
-                linop.smooth(amrlev, mglev, x, b);
-            }
+            linop.smoothMulti(amrlev, mglev, x, b, n);
         }
     }
 
@@ -1030,16 +1250,25 @@ MLMG::ResNormInf (int alev, bool local)
         }
     }
 #endif
-    for (int n = 0; n < ncomp; n++)
-    {
-	Real newnorm = 0.0;
-	if (fine_mask[alev]) {
-            newnorm = pmf->norm0(*fine_mask[alev],n,0,true);
-	} else {
-            newnorm = pmf->norm0(n,0,true);
-	}
-        norm = std::max(norm, newnorm);
+    // All components in one sweep
+    ReduceOps<ReduceOpMax> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    if (fine_mask[alev]) {
+        reduce_op.eval(*pmf, *fine_mask[alev], IntVect(0), reduce_data,
+        [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& fab, IArrayBox const& mskfab)
+            -> ReduceTuple
+        {
+            return ReduceTuple(fab.norminfmask(bx, mskfab, 0, ncomp));
+        });
+    } else {
+        reduce_op.eval(*pmf, IntVect(0), reduce_data,
+        [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& fab) -> ReduceTuple
+        {
+            return ReduceTuple(fab.norm(bx, 0, 0, ncomp));
+        });
     }
+    norm = std::max(norm, amrex::get<0>(reduce_data.value()));
     if (!local) ParallelAllReduce::Max(norm, ParallelContext::CommunicatorSub());
     return norm;
 }
@@ -1064,7 +1293,9 @@ MLMG::MLRhsNormInf (bool local)
 {
     BL_PROFILE("MLMG::MLRhsNormInf()");
     const int ncomp = linop.getNComp();
-    Real r = 0.0;
+    ReduceOps<ReduceOpMax> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
     for (int alev = 0; alev <= finest_amr_lev; ++alev)
     {
         MultiFab* pmf = &(rhs[alev]);
@@ -1079,16 +1310,104 @@ MLMG::MLRhsNormInf (bool local)
             }
         }
 #endif
-        for (int n=0; n<ncomp; ++n)
-        {
+        if (alev < finest_amr_lev) {
+            reduce_op.eval(*pmf, *fine_mask[alev], IntVect(0), reduce_data,
+            [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& fab, IArrayBox const& mskfab)
+                -> ReduceTuple
+            {
+                return ReduceTuple(fab.norminfmask(bx, mskfab, 0, ncomp));
+            });
+        } else {
+            reduce_op.eval(*pmf, IntVect(0), reduce_data,
+            [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& fab) -> ReduceTuple
+            {
+                return ReduceTuple(fab.norm(bx, 0, 0, ncomp));
+            });
+        }
+    }
+    Real r = std::max(Real(0.0), amrex::get<0>(reduce_data.value()));
+    if (!local) ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
+    return r;
+}
+
+// Per-component versions of ResNormInf, MLResNormInf and MLRhsNormInf.
+// Each returns the norms of all components, reduced together.
+Vector<Real>
+MLMG::ResNormInfComp (int alev, bool local)
+{
+    BL_PROFILE("MLMG::ResNormInfComp()");
+    const int ncomp = linop.getNComp();
+    const int mglev = 0;
+    Vector<Real> norm(ncomp, 0.0);
+    MultiFab* pmf = &(res[alev][mglev]);
+#ifdef AMREX_USE_EB
+    if (linop.isCellCentered() && scratch[alev]) {
+        pmf = scratch[alev].get();
+        MultiFab::Copy(*pmf, res[alev][mglev], 0, 0, ncomp, 0);
+        auto factory = dynamic_cast<EBFArrayBoxFactory const*>(linop.Factory(alev));
+        const MultiFab& vfrac = factory->getVolFrac();
+        for (int n=0; n < ncomp; ++n) {
+            MultiFab::Multiply(*pmf, vfrac, 0, n, 1, 0);
+        }
+    }
+#endif
+    for (int n = 0; n < ncomp; ++n) {
+        if (fine_mask[alev]) {
+            norm[n] = pmf->norm0(*fine_mask[alev], n, 0, true);
+        } else {
+            norm[n] = pmf->norm0(n, 0, true);
+        }
+    }
+    if (!local) ParallelAllReduce::Max(norm.data(), ncomp, ParallelContext::CommunicatorSub());
+    return norm;
+}
+
+Vector<Real>
+MLMG::MLResNormInfComp (int alevmax, bool local)
+{
+    BL_PROFILE("MLMG::MLResNormInfComp()");
+    const int ncomp = linop.getNComp();
+    Vector<Real> r(ncomp, 0.0);
+    for (int alev = 0; alev <= alevmax; ++alev)
+    {
+        const Vector<Real> rlev = ResNormInfComp(alev,true);
+        for (int n = 0; n < ncomp; ++n) {
+            r[n] = std::max(r[n], rlev[n]);
+        }
+    }
+    if (!local) ParallelAllReduce::Max(r.data(), ncomp, ParallelContext::CommunicatorSub());
+    return r;
+}
+
+Vector<Real>
+MLMG::MLRhsNormInfComp (bool local)
+{
+    BL_PROFILE("MLMG::MLRhsNormInfComp()");
+    const int ncomp = linop.getNComp();
+    Vector<Real> r(ncomp, 0.0);
+    for (int alev = 0; alev <= finest_amr_lev; ++alev)
+    {
+        MultiFab* pmf = &(rhs[alev]);
+#ifdef AMREX_USE_EB
+        if (linop.isCellCentered() && scratch[alev]) {
+            pmf = scratch[alev].get();
+            MultiFab::Copy(*pmf, rhs[alev], 0, 0, ncomp, 0);
+            auto factory = dynamic_cast<EBFArrayBoxFactory const*>(linop.Factory(alev));
+            const MultiFab& vfrac = factory->getVolFrac();
+            for (int n=0; n < ncomp; ++n) {
+                MultiFab::Multiply(*pmf, vfrac, 0, n, 1, 0);
+            }
+        }
+#endif
+        for (int n = 0; n < ncomp; ++n) {
             if (alev < finest_amr_lev) {
-                r = std::max(r, pmf->norm0(*fine_mask[alev],n,0,true));
+                r[n] = std::max(r[n], pmf->norm0(*fine_mask[alev], n, 0, true));
             } else {
-                r = std::max(r, pmf->norm0(n,0,true));
+                r[n] = std::max(r[n], pmf->norm0(n, 0, true));
             }
         }
     }
-    if (!local) ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
+    if (!local) ParallelAllReduce::Max(r.data(), ncomp, ParallelContext::CommunicatorSub());
     return r;
 }
 
@@ -1105,10 +1424,11 @@ MLMG::buildFineMask ()
     const auto& amrrr = linop.AMRRefRatio();
     for (int alev = 0; alev < finest_amr_lev; ++alev)
     {
-        fine_mask[alev].reset(new iMultiFab(rhs[alev].boxArray(), rhs[alev].DistributionMap(), 1, 0));
+        const BoxArray& ba = amrex::convert(linop.m_grids[alev][0], linop.m_ixtype);
+        fine_mask[alev].reset(new iMultiFab(ba, linop.m_dmap[alev][0], 1, 0));
         fine_mask[alev]->setVal(1);
 
-        BoxArray baf = rhs[alev+1].boxArray();
+        BoxArray baf = amrex::convert(linop.m_grids[alev+1][0], linop.m_ixtype);
         baf.coarsen(amrrr[alev]);
 
 #ifdef _OPENMP
@@ -1148,23 +1468,21 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
     int nghost = 0;
     if (cf_strategy == CFStrategy::ghostnodes) nghost = linop.getNGrow();
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
+    if (bottom_solver == BottomSolver::Default) {
+        bottom_solver = linop.getDefaultBottomSolver();
     }
 
-#ifdef AMREX_USE_HYPRE
-    hypre_solver.reset();
-    hypre_bndry.reset();
-    hypre_node_solver.reset();
-#endif
+    if (bottom_solver == BottomSolver::hypre || bottom_solver == BottomSolver::direct) {
+        int mo = linop.getMaxOrder();
+        linop.setMaxOrder(std::min(3,mo));  // maxorder = 4 not supported
+    }
 
-#ifdef AMREX_USE_PETSC
-    petsc_solver.reset(); 
-    petsc_bndry.reset(); 
-#endif
+    const bool linop_changed = prepareLinOp();
+
+    if (verbose >= 2 && solve_called) {
+        amrex::Print() << "MLMG: " << (linop_changed ? "updating" : "reusing")
+                       << " the operator setup\n";
+    }
 
     sol.resize(namrlevs);
     sol_raii.resize(namrlevs);
@@ -1286,6 +1604,34 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
         cor_hold[alev][0]->setVal(0.0);
     }
 
+    use_mixed_precision = do_mixed_precision && linop.supportsMixedPrecision();
+    if (do_mixed_precision && !use_mixed_precision && verbose >= 1) {
+        amrex::Print() << "MLMG: mixed precision is not supported by " << linop.name()
+                       << ", using full precision\n";
+    }
+    if (use_mixed_precision && res_sp.empty())
+    {
+        res_sp.resize(namrlevs);
+        cor_sp.resize(namrlevs);
+        rescor_sp.resize(namrlevs);
+        for (int alev = 0; alev <= finest_amr_lev; ++alev)
+        {
+            const int nmglevs = linop.NMGLevels(alev);
+            res_sp[alev].resize(nmglevs);
+            cor_sp[alev].resize(nmglevs);
+            rescor_sp[alev].resize(nmglevs);
+            for (int mglev = 0; mglev < nmglevs; ++mglev)
+            {
+                const BoxArray& ba = res[alev][mglev].boxArray();
+                const DistributionMapping& dm = res[alev][mglev].DistributionMap();
+                res_sp[alev][mglev].define(ba, dm, ncomp, 0);
+                cor_sp[alev][mglev].define(ba, dm, ncomp, 1);
+                rescor_sp[alev][mglev].define(ba, dm, ncomp, 0);
+                cor_sp[alev][mglev].setVal(0.0);
+            }
+        }
+    }
+
     buildFineMask();
 
     if (!solve_called)
@@ -1325,6 +1671,35 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
     }
 }
 
+bool
+MLMG::prepareLinOp ()
+{
+    if (!linop_prepared) {
+        linop.prepareForSolve();
+        linop_prepared = true;
+    } else if (linop.needsUpdate()) {
+        linop.update();
+    } else {
+        return false;
+    }
+
+    linop.prepareChebyshev();
+
+    // The bottom solvers built from the operator are kept until it changes.
+    direct_solver.reset();
+#ifdef AMREX_USE_HYPRE
+    hypre_solver.reset();
+    hypre_bndry.reset();
+    hypre_node_solver.reset();
+#endif
+#ifdef AMREX_USE_PETSC
+    petsc_solver.reset();
+    petsc_bndry.reset();
+#endif
+
+    return true;
+}
+
 void
 MLMG::prepareForNSolve ()
 {
@@ -1465,12 +1840,7 @@ MLMG::compResidual (const Vector<MultiFab*>& a_res, const Vector<MultiFab*>& a_s
         }
     }
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
     
     const auto& amrrr = linop.AMRRefRatio();
 
@@ -1545,12 +1915,7 @@ MLMG::apply (const Vector<MultiFab*>& out, const Vector<MultiFab*>& a_in)
         rh[alev].setVal(0.0);
     }
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
 
     const auto& amrrr = linop.AMRRefRatio();
 
@@ -1828,6 +2193,23 @@ MLMG::bottomSolveWithHypre (MultiFab& x, const MultiFab& b)
 #endif
 }
 
+int
+MLMG::bottomSolveWithDirect (MultiFab& x, const MultiFab& b)
+{
+    if (direct_solver == nullptr)
+    {
+        direct_solver.reset(new MLDirectSolver(linop));
+        direct_solver->setVerbose(bottom_verbose);
+        if (!direct_solver->setup(x)) {
+            direct_solver.reset();
+            return 1;
+        }
+    }
+
+    direct_solver->solve(x, b);
+    return 0;
+}
+
 void
 MLMG::bottomSolveWithPETSc (MultiFab& x, const MultiFab& b)
 {
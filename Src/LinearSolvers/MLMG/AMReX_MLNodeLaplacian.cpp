@@ -3,6 +3,7 @@
 #include <AMReX_MLMG.H>
 #include <AMReX_MLNodeLaplacian.H>
 #include <AMReX_MLNodeLap_F.H>
+#include <AMReX_MLNodeLap_K.H>
 #include <AMReX_MultiFabUtil.H>
 
 #ifdef AMREX_USE_EB
@@ -116,6 +117,7 @@ void
 MLNodeLaplacian::setSigma (int amrlev, const MultiFab& a_sigma)
 {
     MultiFab::Copy(*m_sigma[amrlev][0][0], a_sigma, 0, 0, 1, 0);
+    m_needs_update = true;
 }
 
 void
@@ -1296,17 +1298,35 @@ MLNodeLaplacian::prepareForSolve ()
 
     buildMasks();
 
+#ifdef AMREX_USE_EB
+    buildIntegral();
+#endif
+
+    updateCoeffs();
+}
+
+void
+MLNodeLaplacian::update ()
+{
+    BL_PROFILE("MLNodeLaplacian::update()");
+
+    if (MLNodeLinOp::needsUpdate()) MLNodeLinOp::update();
+
+    updateCoeffs();
+}
+
+void
+MLNodeLaplacian::updateCoeffs ()
+{
     averageDownCoeffs();
 
 #if (AMREX_SPACEDIM == 2)
     amrex_mlndlap_set_rz(&m_is_rz);
 #endif
 
-#ifdef AMREX_USE_EB
-    buildIntegral();
-#endif
-
     buildStencil();
+
+    m_needs_update = false;
 }
 
 void
@@ -1337,10 +1357,8 @@ MLNodeLaplacian::restriction (int amrlev, int cmglev, MultiFab& crse, MultiFab&
         const Box& bx = mfi.tilebox();
         if (m_coarsening_strategy == CoarseningStrategy::Sigma)
         {
-            amrex_mlndlap_restriction(BL_TO_FORTRAN_BOX(bx),
-                                      BL_TO_FORTRAN_ANYD((*pcrse)[mfi]),
-                                      BL_TO_FORTRAN_ANYD(fine[mfi]),
-                                      BL_TO_FORTRAN_ANYD(dmsk[mfi]));
+            mlndlap_restriction(bx, pcrse->array(mfi), fine.array(mfi),
+                                dmsk.array(mfi));
         }
         else
         {
@@ -1376,8 +1394,6 @@ MLNodeLaplacian::interpolation (int amrlev, int fmglev, MultiFab& fine, const Mu
         cmf = &cfine;
     }
 
-    const Box& nd_domain = amrex::surroundingNodes(m_geom[amrlev][fmglev].Domain());
-
     const iMultiFab& dmsk = *m_dirichlet_mask[amrlev][fmglev];
 
 #ifdef _OPENMP
@@ -1402,29 +1418,16 @@ MLNodeLaplacian::interpolation (int amrlev, int fmglev, MultiFab& fine, const Mu
             }
             else if (m_use_harmonic_average && fmglev > 0)
             {
-                AMREX_D_TERM(const FArrayBox& sxfab = (*sigma[0])[mfi];,
-                             const FArrayBox& syfab = (*sigma[1])[mfi];,
-                             const FArrayBox& szfab = (*sigma[2])[mfi];);
-                amrex_mlndlap_interpolation_ha(BL_TO_FORTRAN_BOX(cbx),
-                                               BL_TO_FORTRAN_ANYD(tmpfab),
-                                               BL_TO_FORTRAN_ANYD((*cmf)[mfi]),
-                                               AMREX_D_DECL(BL_TO_FORTRAN_ANYD(sxfab),
-                                                            BL_TO_FORTRAN_ANYD(syfab),
-                                                            BL_TO_FORTRAN_ANYD(szfab)),
-                                               BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                               BL_TO_FORTRAN_BOX(nd_domain),
-                                               m_lobc[0].data(), m_hibc[0].data());
+                mlndlap_interpolation_ha(cbx, tmpfab.array(), cmf->array(mfi),
+                                         AMREX_D_DECL(sigma[0]->array(mfi),
+                                                      sigma[1]->array(mfi),
+                                                      sigma[2]->array(mfi)),
+                                         dmsk.array(mfi));
             }
             else
             {
-                const FArrayBox& sfab = (*sigma[0])[mfi];
-                amrex_mlndlap_interpolation_aa(BL_TO_FORTRAN_BOX(cbx),
-                                               BL_TO_FORTRAN_ANYD(tmpfab),
-                                               BL_TO_FORTRAN_ANYD((*cmf)[mfi]),
-                                               BL_TO_FORTRAN_ANYD(sfab),
-                                               BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                               BL_TO_FORTRAN_BOX(nd_domain),
-                                               m_lobc[0].data(), m_hibc[0].data());
+                mlndlap_interpolation_aa(cbx, tmpfab.array(), cmf->array(mfi),
+                                         sigma[0]->array(mfi), dmsk.array(mfi));
             }
             fine[mfi].plus(tmpfab,fbx,fbx,0,0,1);
         }
@@ -1482,10 +1485,8 @@ MLNodeLaplacian::restrictInteriorNodes (int camrlev, MultiFab& crhs, MultiFab& a
     {
         const Box& bx = mfi.tilebox();
         if (m_coarsening_strategy == CoarseningStrategy::Sigma) {
-            amrex_mlndlap_restriction(BL_TO_FORTRAN_BOX(bx),
-                                      BL_TO_FORTRAN_ANYD(cfine[mfi]),
-                                      BL_TO_FORTRAN_ANYD((*frhs)[mfi]),
-                                      BL_TO_FORTRAN_ANYD(fdmsk[mfi]));
+            mlndlap_restriction(bx, cfine.array(mfi), frhs->array(mfi),
+                                fdmsk.array(mfi));
         } else {
             amrex_mlndlap_restriction_rap(BL_TO_FORTRAN_BOX(bx),
                                           BL_TO_FORTRAN_ANYD(cfine[mfi]),
@@ -1561,9 +1562,8 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
 
     const auto& sigma = m_sigma[amrlev][mglev];
     const auto& stencil = m_stencil[amrlev][mglev];
-    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    const auto dxinvarr = m_geom[amrlev][mglev].InvCellSizeArray();
 
-    const Box& domain_box = amrex::surroundingNodes(m_geom[amrlev][mglev].Domain());
     const iMultiFab& dmsk = *m_dirichlet_mask[amrlev][mglev];
 
 #ifdef _OPENMP
@@ -1585,31 +1585,24 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
         }
         else if (m_use_harmonic_average && mglev > 0)
         {
-            AMREX_D_TERM(const FArrayBox& sxfab = (*sigma[0])[mfi];,
-                         const FArrayBox& syfab = (*sigma[1])[mfi];,
-                         const FArrayBox& szfab = (*sigma[2])[mfi];);
-
-            amrex_mlndlap_adotx_ha(BL_TO_FORTRAN_BOX(bx),
-                                   BL_TO_FORTRAN_ANYD(yfab),
-                                   BL_TO_FORTRAN_ANYD(xfab),
-                                   AMREX_D_DECL(BL_TO_FORTRAN_ANYD(sxfab),
-                                                BL_TO_FORTRAN_ANYD(syfab),
-                                                BL_TO_FORTRAN_ANYD(szfab)),
-                                   BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                   dxinv, BL_TO_FORTRAN_BOX(domain_box),
-                                   m_lobc[0].data(), m_hibc[0].data());
+            mlndlap_adotx_ha(bx, yfab.array(), xfab.array(),
+                             AMREX_D_DECL(sigma[0]->array(mfi),
+                                          sigma[1]->array(mfi),
+                                          sigma[2]->array(mfi)),
+                             dmsk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                             , m_is_rz
+#endif
+                             );
         }
         else
         {
-            const FArrayBox& sfab = (*sigma[0])[mfi];
-
-            amrex_mlndlap_adotx_aa(BL_TO_FORTRAN_BOX(bx),
-                                   BL_TO_FORTRAN_ANYD(yfab),
-                                   BL_TO_FORTRAN_ANYD(xfab),
-                                   BL_TO_FORTRAN_ANYD(sfab),
-                                   BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                   dxinv, BL_TO_FORTRAN_BOX(domain_box),
-                                   m_lobc[0].data(), m_hibc[0].data());
+            mlndlap_adotx_aa(bx, yfab.array(), xfab.array(), sigma[0]->array(mfi),
+                             dmsk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                             , m_is_rz
+#endif
+                             );
         }
     }
 }
@@ -1626,9 +1619,7 @@ MLNodeLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
     {
         const auto& sigma = m_sigma[amrlev][mglev];
         const auto& stencil = m_stencil[amrlev][mglev];
-        const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
-
-        const Box& domain_box = amrex::surroundingNodes(m_geom[amrlev][mglev].Domain());
+        const auto dxinvarr = m_geom[amrlev][mglev].InvCellSizeArray();
 
         if (m_coarsening_strategy == CoarseningStrategy::RAP)
         {
@@ -1653,19 +1644,15 @@ MLNodeLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
             for (MFIter mfi(sol); mfi.isValid(); ++mfi)
             {
                 const Box& bx = mfi.validbox();
-                AMREX_D_TERM(const FArrayBox& sxfab = (*sigma[0])[mfi];,
-                             const FArrayBox& syfab = (*sigma[1])[mfi];,
-                             const FArrayBox& szfab = (*sigma[2])[mfi];);
-
-                amrex_mlndlap_gauss_seidel_ha(BL_TO_FORTRAN_BOX(bx),
-                                              BL_TO_FORTRAN_ANYD(sol[mfi]),
-                                              BL_TO_FORTRAN_ANYD(rhs[mfi]),
-                                              AMREX_D_DECL(BL_TO_FORTRAN_ANYD(sxfab),
-                                                           BL_TO_FORTRAN_ANYD(syfab),
-                                                           BL_TO_FORTRAN_ANYD(szfab)),
-                                              BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                              dxinv, BL_TO_FORTRAN_BOX(domain_box),
-                                              m_lobc[0].data(), m_hibc[0].data());
+                mlndlap_gauss_seidel_ha(bx, sol.array(mfi), rhs.array(mfi),
+                                        AMREX_D_DECL(sigma[0]->array(mfi),
+                                                     sigma[1]->array(mfi),
+                                                     sigma[2]->array(mfi)),
+                                        dmsk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                                        , m_is_rz
+#endif
+                                        );
             }
         }
         else
@@ -1676,15 +1663,12 @@ MLNodeLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
             for (MFIter mfi(sol); mfi.isValid(); ++mfi)
             {
                 const Box& bx = mfi.validbox();
-                const FArrayBox& sfab = (*sigma[0])[mfi];
-
-                amrex_mlndlap_gauss_seidel_aa(BL_TO_FORTRAN_BOX(bx),
-                                              BL_TO_FORTRAN_ANYD(sol[mfi]),
-                                              BL_TO_FORTRAN_ANYD(rhs[mfi]),
-                                              BL_TO_FORTRAN_ANYD(sfab),
-                                              BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                              dxinv, BL_TO_FORTRAN_BOX(domain_box),
-                                              m_lobc[0].data(), m_hibc[0].data());
+                mlndlap_gauss_seidel_aa(bx, sol.array(mfi), rhs.array(mfi),
+                                        sigma[0]->array(mfi), dmsk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                                        , m_is_rz
+#endif
+                                        );
             }
         }
 
@@ -1697,9 +1681,7 @@ MLNodeLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
 
         const auto& sigma = m_sigma[amrlev][mglev];
         const auto& stencil = m_stencil[amrlev][mglev];
-        const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
-
-        const Box& domain_box = amrex::surroundingNodes(m_geom[amrlev][mglev].Domain());
+        const auto dxinvarr = m_geom[amrlev][mglev].InvCellSizeArray();
 
         if (m_coarsening_strategy == CoarseningStrategy::RAP)
         {
@@ -1725,20 +1707,11 @@ MLNodeLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
             for (MFIter mfi(sol,true); mfi.isValid(); ++mfi)
             {
                 const Box& bx = mfi.tilebox();
-                AMREX_D_TERM(const FArrayBox& sxfab = (*sigma[0])[mfi];,
-                             const FArrayBox& syfab = (*sigma[1])[mfi];,
-                             const FArrayBox& szfab = (*sigma[2])[mfi];);
-
-                amrex_mlndlap_jacobi_ha(BL_TO_FORTRAN_BOX(bx),
-                                        BL_TO_FORTRAN_ANYD(sol[mfi]),
-                                        BL_TO_FORTRAN_ANYD(Ax[mfi]),
-                                        BL_TO_FORTRAN_ANYD(rhs[mfi]),
-                                        AMREX_D_DECL(BL_TO_FORTRAN_ANYD(sxfab),
-                                                     BL_TO_FORTRAN_ANYD(syfab),
-                                                     BL_TO_FORTRAN_ANYD(szfab)),
-                                        BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                        dxinv, BL_TO_FORTRAN_BOX(domain_box),
-                                        m_lobc[0].data(), m_hibc[0].data());
+                mlndlap_jacobi_ha(bx, sol.array(mfi), Ax.array(mfi), rhs.array(mfi),
+                                  AMREX_D_DECL(sigma[0]->array(mfi),
+                                               sigma[1]->array(mfi),
+                                               sigma[2]->array(mfi)),
+                                  dmsk.array(mfi), dxinvarr);
             }
         }
         else
@@ -1749,16 +1722,8 @@ MLNodeLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
             for (MFIter mfi(sol,true); mfi.isValid(); ++mfi)
             {
                 const Box& bx = mfi.tilebox();
-                const FArrayBox& sfab = (*sigma[0])[mfi];
-
-                amrex_mlndlap_jacobi_aa(BL_TO_FORTRAN_BOX(bx),
-                                        BL_TO_FORTRAN_ANYD(sol[mfi]),
-                                        BL_TO_FORTRAN_ANYD(Ax[mfi]),
-                                        BL_TO_FORTRAN_ANYD(rhs[mfi]),
-                                        BL_TO_FORTRAN_ANYD(sfab),
-                                        BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                        dxinv, BL_TO_FORTRAN_BOX(domain_box),
-                                        m_lobc[0].data(), m_hibc[0].data());
+                mlndlap_jacobi_aa(bx, sol.array(mfi), Ax.array(mfi), rhs.array(mfi),
+                                  sigma[0]->array(mfi), dmsk.array(mfi), dxinvarr);
             }
         }
     }
@@ -1772,7 +1737,7 @@ MLNodeLaplacian::normalize (int amrlev, int mglev, MultiFab& mf) const
 
     const auto& sigma = m_sigma[amrlev][mglev];
     const auto& stencil = m_stencil[amrlev][mglev];
-    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    const auto dxinvarr = m_geom[amrlev][mglev].InvCellSizeArray();
     const iMultiFab& dmsk = *m_dirichlet_mask[amrlev][mglev];
     const Real s0_norm0 = m_s0_norm0[amrlev][mglev];
 
@@ -1793,27 +1758,16 @@ MLNodeLaplacian::normalize (int amrlev, int mglev, MultiFab& mf) const
         }
         else if (m_use_harmonic_average && mglev > 0)
         {
-            AMREX_D_TERM(const FArrayBox& sxfab = (*sigma[0])[mfi];,
-                         const FArrayBox& syfab = (*sigma[1])[mfi];,
-                         const FArrayBox& szfab = (*sigma[2])[mfi];);
-
-            amrex_mlndlap_normalize_ha(BL_TO_FORTRAN_BOX(bx),
-                                       BL_TO_FORTRAN_ANYD(fab),
-                                       AMREX_D_DECL(BL_TO_FORTRAN_ANYD(sxfab),
-                                                    BL_TO_FORTRAN_ANYD(syfab),
-                                                    BL_TO_FORTRAN_ANYD(szfab)),
-                                       BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                       dxinv);
+            mlndlap_normalize_ha(bx, fab.array(),
+                                 AMREX_D_DECL(sigma[0]->array(mfi),
+                                              sigma[1]->array(mfi),
+                                              sigma[2]->array(mfi)),
+                                 dmsk.array(mfi), dxinvarr);
         }
         else
         {
-            const FArrayBox& sfab = (*sigma[0])[mfi];
-
-            amrex_mlndlap_normalize_aa(BL_TO_FORTRAN_BOX(bx),
-                                       BL_TO_FORTRAN_ANYD(fab),
-                                       BL_TO_FORTRAN_ANYD(sfab),
-                                       BL_TO_FORTRAN_ANYD(dmsk[mfi]),
-                                       dxinv);
+            mlndlap_normalize_aa(bx, fab.array(), sigma[0]->array(mfi),
+                                 dmsk.array(mfi), dxinvarr);
         }
     }
 }
@@ -2141,10 +2095,8 @@ MLNodeLaplacian::reflux (int crse_amrlev,
     {
         const Box& bx = mfi.tilebox();
         if (m_coarsening_strategy == CoarseningStrategy::Sigma) {
-            amrex_mlndlap_restriction(BL_TO_FORTRAN_BOX(bx),
-                                      BL_TO_FORTRAN_ANYD(fine_res_for_coarse[mfi]),
-                                      BL_TO_FORTRAN_ANYD(fine_res[mfi]),
-                                      BL_TO_FORTRAN_ANYD(fdmsk[mfi]));
+            mlndlap_restriction(bx, fine_res_for_coarse.array(mfi), fine_res.array(mfi),
+                                fdmsk.array(mfi));
         } else {
             amrex_mlndlap_restriction_rap(BL_TO_FORTRAN_BOX(bx),
                                           BL_TO_FORTRAN_ANYD(fine_res_for_coarse[mfi]),
@@ -116,6 +116,10 @@ void
 MLNodeLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
                      bool skip_fillboundary) const
 {
+    if (useChebyshev()) {
+        chebyshevSmooth(amrlev, mglev, sol, rhs, m_cheby_degree);
+        return;
+    }
     if (!skip_fillboundary) {
         applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution);
     }
@@ -51,11 +51,10 @@ MLPoisson::prepareForSolve ()
     }
 }
 
+template <class MF>
 void
-MLPoisson::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& in) const
+MLPoisson::FapplyT (int amrlev, int mglev, MF& out, const MF& in) const
 {
-    BL_PROFILE("MLPoisson::Fapply()");
-
     const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
 
     AMREX_D_TERM(const Real dhx = dxinv[0]*dxinv[0];,
@@ -147,11 +146,10 @@ MLPoisson::normalize (int amrlev, int mglev, MultiFab& mf) const
 #endif
 }
 
+template <class MF>
 void
-MLPoisson::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, int redblack) const
+MLPoisson::FsmoothT (int amrlev, int mglev, MF& sol, const MF& rhs, int redblack) const
 {
-    BL_PROFILE("MLPoisson::Fsmooth()");
-
     const auto& undrrelxr = m_undrrelxr[amrlev][mglev];
     const auto& maskvals  = m_maskvals [amrlev][mglev];
 
@@ -286,6 +284,34 @@ MLPoisson::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, i
     }
 }
 
+void
+MLPoisson::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& in) const
+{
+    BL_PROFILE("MLPoisson::Fapply()");
+    FapplyT(amrlev, mglev, out, in);
+}
+
+void
+MLPoisson::FapplySP (int amrlev, int mglev, SPMultiFab& out, const SPMultiFab& in) const
+{
+    BL_PROFILE("MLPoisson::FapplySP()");
+    FapplyT(amrlev, mglev, out, in);
+}
+
+void
+MLPoisson::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, int redblack) const
+{
+    BL_PROFILE("MLPoisson::Fsmooth()");
+    FsmoothT(amrlev, mglev, sol, rhs, redblack);
+}
+
+void
+MLPoisson::FsmoothSP (int amrlev, int mglev, SPMultiFab& sol, const SPMultiFab& rhs, int redblack) const
+{
+    BL_PROFILE("MLPoisson::FsmoothSP()");
+    FsmoothT(amrlev, mglev, sol, rhs, redblack);
+}
+
 void
 MLPoisson::FFlux (int amrlev, const MFIter& mfi,
                   const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
@@ -3,6 +3,8 @@
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_BLProfiler.H>
 
+#include <algorithm>
+
 namespace amrex {
 
 #ifdef BL_USE_MPI    
@@ -24,13 +26,38 @@ namespace amrex {
     long doHandShake(const std::map<int, Vector<char> >& not_ours,
                      Vector<long>& Snds, Vector<long>& Rcvs)
     {
-        long NumSnds = CountSnds(not_ours, Snds);
+        for (const auto& kv : not_ours)
+        {
+            Snds[kv.first] = kv.second.size();
+        }
+
+        return doHandShake(Snds, Rcvs);
+    }
+
+    long doHandShake(const Vector<long>& Snds, Vector<long>& Rcvs)
+    {
+        if (UseSparseHandShake()) {
+            return doHandShakeSparse(Snds, Rcvs);
+        } else {
+            return doHandShakeDense(Snds, Rcvs);
+        }
+    }
+
+    long doHandShakeDense(const Vector<long>& Snds, Vector<long>& Rcvs)
+    {
+        long NumSnds = 0;
+        for (const auto n : Snds) {
+            NumSnds += n;
+        }
+
+        ParallelDescriptor::ReduceLongMax(NumSnds);
+
         if (NumSnds == 0) return NumSnds;
 
         BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(long),
                         ParallelDescriptor::MyProc(), BLProfiler::BeforeCall());
         
-        BL_MPI_REQUIRE( MPI_Alltoall(Snds.dataPtr(),
+        BL_MPI_REQUIRE( MPI_Alltoall(const_cast<long*>(Snds.dataPtr()),
                                      1,
                                      ParallelDescriptor::Mpi_typemap<long>::type(),
                                      Rcvs.dataPtr(),
@@ -46,6 +73,82 @@ namespace amrex {
         return NumSnds;
     }
 
+    long doHandShakeSparse(const Vector<long>& Snds, Vector<long>& Rcvs)
+    {
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+        BL_PROFILE("doHandShakeSparse()");
+
+        const int NProcs = ParallelDescriptor::NProcs();
+        const int SeqNum = ParallelDescriptor::SeqNum();
+        MPI_Comm comm = ParallelDescriptor::Communicator();
+        const MPI_Datatype mpi_long = ParallelDescriptor::Mpi_typemap<long>::type();
+
+        std::fill(Rcvs.begin(), Rcvs.end(), 0L);
+
+        // Synchronous sends: completion means the receiver has matched them.
+        long NumSnds = 0;
+        Vector<MPI_Request> sreqs;
+        for (int i = 0; i < NProcs; ++i) {
+            if (Snds[i] > 0) {
+                NumSnds += Snds[i];
+                MPI_Request req;
+                BL_MPI_REQUIRE( MPI_Issend(const_cast<long*>(&Snds[i]), 1, mpi_long,
+                                           i, SeqNum, comm, &req) );
+                sreqs.push_back(req);
+            }
+        }
+
+        long NumRcvs = 0;
+        MPI_Request barrier = MPI_REQUEST_NULL;
+        bool barrier_active = false;
+        while (true)
+        {
+            int flag = 0;
+            MPI_Status status;
+            BL_MPI_REQUIRE( MPI_Iprobe(MPI_ANY_SOURCE, SeqNum, comm, &flag, &status) );
+            if (flag)
+            {
+                const int Who = status.MPI_SOURCE;
+                long Cnt = 0;
+                BL_MPI_REQUIRE( MPI_Recv(&Cnt, 1, mpi_long, Who, SeqNum, comm, MPI_STATUS_IGNORE) );
+                Rcvs[Who] = Cnt;
+                NumRcvs += Cnt;
+            }
+
+            if (barrier_active)
+            {
+                int done = 0;
+                BL_MPI_REQUIRE( MPI_Test(&barrier, &done, MPI_STATUS_IGNORE) );
+                if (done) break;
+            }
+            else
+            {
+                int sent = 0;
+                BL_MPI_REQUIRE( MPI_Testall(sreqs.size(), sreqs.dataPtr(), &sent,
+                                            MPI_STATUSES_IGNORE) );
+                if (sent)
+                {
+                    BL_MPI_REQUIRE( MPI_Ibarrier(comm, &barrier) );
+                    barrier_active = true;
+                }
+            }
+        }
+
+        BL_ASSERT(Rcvs[ParallelDescriptor::MyProc()] == 0);
+
+        return NumSnds + NumRcvs;
+#else
+        return doHandShakeDense(Snds, Rcvs);
+#endif
+    }
+
+    bool use_sparse_handshake = true;
+
+    bool UseSparseHandShake ()
+    {
+        return use_sparse_handshake;
+    }
+
     long doHandShakeLocal(const std::map<int, Vector<char> >& not_ours,
                           const Vector<int>& neighbor_procs, Vector<long>& Snds, Vector<long>& Rcvs)
     {
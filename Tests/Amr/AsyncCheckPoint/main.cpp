@@ -0,0 +1,240 @@
+//
+// Asynchronous checkpoint test.  A single-level AmrLevel is advanced, and
+// two asynchronous checkpoints are written, each overlapped with further
+// steps that change the state.  The second checkPoint completes the first,
+// and waitForAsyncCheckPoint completes the second.  The run is then
+// restarted from each checkpoint, and the restarted state, time and step
+// must equal the ones saved when the checkpoint was written.
+//
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PROB_AMR_F.H>
+#ifdef AMREX_USE_EB
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_AllRegular.H>
+#endif
+
+#include <cmath>
+
+using namespace amrex;
+
+extern "C"
+void amrex_probinit (const int*, const int*, const int*, const amrex_real*, const amrex_real*)
+{}
+
+namespace
+{
+    const Real fixed_dt = 0.01;
+
+    void nullfill (Box const&, FArrayBox&, const int, const int, Geometry const&,
+                   const Real, const Vector<BCRec>&, const int, const int)
+    {}
+}
+
+class TestLevel
+    : public AmrLevel
+{
+public:
+
+    TestLevel () = default;
+    TestLevel (Amr& papa, int lev, const Geometry& level_geom, const BoxArray& bl,
+               const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, bl, dm, time) {}
+
+    static void variableSetUp ()
+    {
+        desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                               0, 1, &cell_cons_interp);
+        int bc[AMREX_SPACEDIM];
+        for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+            bc[i] = BCType::int_dir;
+        }
+        desc_lst.setComponent(0, 0, "phi", BCRec(bc, bc), StateDescriptor::BndryFunc(nullfill));
+    }
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int, int, Vector<int>& n_cycle, const Vector<IntVect>&,
+                                   Vector<Real>& dt_level, Real) override
+    {
+        n_cycle[0] = 1;
+        dt_level[0] = fixed_dt;
+    }
+
+    virtual void computeNewDt (int, int, Vector<int>& n_cycle, const Vector<IntVect>&,
+                               Vector<Real>& dt_min, Vector<Real>& dt_level, Real, int) override
+    {
+        n_cycle[0] = 1;
+        dt_min[0] = dt_level[0] = fixed_dt;
+    }
+
+    virtual Real advance (Real time, Real dt, int, int) override
+    {
+        state[0].allocOldData();
+        state[0].swapTimeLevels(dt);
+        const MultiFab& S_old = get_old_data(0);
+        MultiFab& S_new = get_new_data(0);
+        const auto dx = geom.CellSizeArray();
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            for (BoxIterator bi(bx); bi.ok(); ++bi)
+            {
+                const IntVect& iv = bi();
+                const Real x = (iv[0]+0.5)*dx[0];
+                S_new[mfi](iv) = S_old[mfi](iv) + dt*std::cos(x + time + iv[1]*dx[1]);
+            }
+        }
+        return dt;
+    }
+
+    virtual void initData () override
+    {
+        MultiFab& S_new = get_new_data(0);
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            for (BoxIterator bi(bx); bi.ok(); ++bi)
+            {
+                const IntVect& iv = bi();
+                S_new[mfi](iv) = std::sin(0.1*iv[0]) + 0.01*iv[AMREX_SPACEDIM-1];
+            }
+        }
+    }
+
+    virtual void post_timestep (int) override {}
+    virtual void post_regrid (int, int, int) override {}
+    virtual void post_init (Real) override {}
+    virtual void init (AmrLevel&) override { amrex::Abort("TestLevel: no regridding"); }
+    virtual void init () override { amrex::Abort("TestLevel: no regridding"); }
+    virtual void errorEst (TagBoxArray&, int, int, Real, int, int) override {}
+};
+
+class TestLevelBld
+    : public LevelBld
+{
+    virtual void variableSetUp () override { TestLevel::variableSetUp(); }
+    virtual void variableCleanUp () override { TestLevel::variableCleanUp(); }
+    virtual AmrLevel* operator() () override { return new TestLevel; }
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new TestLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+TestLevelBld test_bld;
+
+LevelBld*
+getLevelBld ()
+{
+    return &test_bld;
+}
+
+namespace
+{
+    struct Snapshot
+    {
+        std::string chkfile;
+        int step;
+        Real time;
+        std::unique_ptr<MultiFab> phi;
+    };
+
+    Snapshot takeSnapshot (Amr& amr)
+    {
+        const MultiFab& phi = amr.getLevel(0).get_new_data(0);
+        Snapshot s;
+        s.step = amr.levelSteps(0);
+        s.time = amr.cumTime();
+        s.phi.reset(new MultiFab(phi.boxArray(), phi.DistributionMap(), 1, 0));
+        MultiFab::Copy(*s.phi, phi, 0, 0, 1, 0);
+        return s;
+    }
+
+    void initAmr (Amr& amr)
+    {
+#ifdef AMREX_USE_EB
+        const int lev = amr.maxLevel();
+        EB2::Build(EB2::makeShop(EB2::AllRegularIF()), amr.Geom(lev), lev, lev);
+#endif
+        amr.init(0.0, 1.e30);
+    }
+
+    void advance (Amr& amr, int nsteps)
+    {
+        for (int i = 0; i < nsteps; ++i) {
+            amr.coarseTimeStep(1.e30);
+        }
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int nsteps = 3;
+        std::string check_file = "chk";
+        {
+            ParmParse pp;
+            pp.query("nsteps", nsteps);
+            ParmParse ppa("amr");
+            ppa.query("check_file", check_file);
+        }
+
+        Vector<Snapshot> snapshots;
+        {
+            Amr amr;
+            initAmr(amr);
+
+            for (int ichk = 0; ichk < 2; ++ichk)
+            {
+                advance(amr, nsteps);
+                amr.checkPoint();
+                if (!amr.asyncCheckPointPending()) {
+                    amrex::Abort("AsyncCheckPoint: checkPoint did not leave an asynchronous write");
+                }
+                snapshots.push_back(takeSnapshot(amr));
+                snapshots.back().chkfile = amrex::Concatenate(check_file, amr.levelSteps(0), 5);
+                // ---- change the state while the checkpoint is written
+                advance(amr, nsteps);
+            }
+
+            amr.waitForAsyncCheckPoint();
+            if (amr.asyncCheckPointPending()) {
+                amrex::Abort("AsyncCheckPoint: the checkpoint is still pending after the fence");
+            }
+        }
+
+        for (const auto& s : snapshots)
+        {
+            ParmParse ppa("amr");
+            ppa.add("restart", s.chkfile);
+
+            Amr amr;
+            initAmr(amr);
+
+            MultiFab diff(s.phi->boxArray(), s.phi->DistributionMap(), 1, 0);
+            MultiFab::Copy(diff, amr.getLevel(0).get_new_data(0), 0, 0, 1, 0);
+            MultiFab::Subtract(diff, *s.phi, 0, 0, 1, 0);
+            const Real err = diff.norm0(0);
+
+            amrex::Print() << "AsyncCheckPoint: restart from " << s.chkfile
+                           << ": step " << amr.levelSteps(0) << " (" << s.step << "), time "
+                           << amr.cumTime() << " (" << s.time << "), max difference "
+                           << err << "\n";
+
+            if (amr.levelSteps(0) != s.step || amr.cumTime() != s.time || err != 0.0) {
+                amrex::Abort("AsyncCheckPoint: the restarted state differs from the checkpointed one");
+            }
+        }
+
+        amrex::Print() << "AsyncCheckPoint passed\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,112 @@
+//
+// Round-trip test for compressed VisMF output.  A smooth field with some
+// noise, a constant component and a few special values is written
+// losslessly and with an absolute error bound, read back and compared.
+//
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <AMReX_VisMF.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+namespace
+{
+    bool sameBits (Real a, Real b)
+    {
+        return std::memcmp(&a, &b, sizeof(Real)) == 0;
+    }
+}
+
+int
+main (int argc, char** argv)
+{
+    amrex::Initialize(argc, argv);
+
+    const int ncomp = 3;
+    const Real tol = 1.e-6;
+
+    Box domain(IntVect(D_DECL(0,0,0)), IntVect(D_DECL(63,63,63)));
+    BoxArray ba(domain);
+    ba.maxSize(32);
+    DistributionMapping dm(ba);
+
+    MultiFab mf(ba, dm, ncomp, 0);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        const Box& bx = mfi.validbox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            Real x = 0.1*iv[0], y = 0.05*iv[1];
+            fab(iv,0) = std::sin(x)*std::cos(y) + 1.e-3*amrex::Random();
+            fab(iv,1) = 42.0;
+            fab(iv,2) = std::exp(-x*y);
+        }
+        // ---- special values must survive both modes exactly
+        const IntVect& lo = bx.smallEnd();
+        fab(lo,0) = std::numeric_limits<Real>::quiet_NaN();
+        fab(lo,2) = std::numeric_limits<Real>::infinity();
+    }
+
+    VisMF::Compression lossless;
+    lossless.codec = VisMF::Compression::Lossless;
+
+    VisMF::Compression lossy;
+    lossy.codec = VisMF::Compression::Lossy;
+    lossy.abs_tol.resize(1, tol);
+
+    VisMF::Write(mf, "tVisMFCompress_lossless", VisMF::NFiles, false, lossless);
+    VisMF::Write(mf, "tVisMFCompress_lossy", VisMF::NFiles, false, lossy);
+
+    MultiFab a, b;
+    VisMF::Read(a, "tVisMFCompress_lossless");
+    VisMF::Read(b, "tVisMFCompress_lossy");
+
+    long nbitdiff = 0;
+    Real maxerr = 0.0;
+    long nspecial = 0;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const FArrayBox& orig = mf[mfi];
+        const Box& bx = mfi.validbox();
+        for (int n = 0; n < ncomp; ++n)
+        {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                const Real v = orig(iv,n);
+                if (!sameBits(v, a[mfi](iv,n))) ++nbitdiff;
+                if (std::isfinite(v)) {
+                    maxerr = std::max(maxerr, std::abs(v - b[mfi](iv,n)));
+                } else if (!sameBits(v, b[mfi](iv,n))) {
+                    ++nspecial;
+                }
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(nbitdiff);
+    ParallelDescriptor::ReduceLongSum(nspecial);
+    ParallelDescriptor::ReduceRealMax(maxerr);
+
+    amrex::Print() << "lossless: " << nbitdiff << " values differ\n"
+                   << "lossy:    max error " << maxerr << " (tolerance " << tol << "), "
+                   << nspecial << " special values differ\n";
+
+    if (nbitdiff != 0) {
+        amrex::Abort("tVisMFCompress: lossless round trip is not bitwise exact");
+    }
+    if (maxerr > tol || nspecial != 0) {
+        amrex::Abort("tVisMFCompress: lossy round trip exceeds the error bound");
+    }
+
+    amrex::Print() << "tVisMFCompress passed\n";
+
+    amrex::Finalize();
+}
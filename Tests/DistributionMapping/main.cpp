@@ -0,0 +1,134 @@
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        Vector<int> n_cell(AMREX_SPACEDIM, 128);
+        int max_grid_size = 32;
+        int nghost = 1;
+        Real graph_imbalance = 0.1;
+        {
+            ParmParse pp;
+            pp.queryarr("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nghost", nghost);
+            ParmParse ppdm("DistributionMapping");
+            ppdm.query("graph_imbalance", graph_imbalance);
+        }
+
+        Box domain(IntVect(0), IntVect(AMREX_D_DECL(n_cell[0]-1,n_cell[1]-1,n_cell[2]-1)));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+
+        // Make the boxes in the middle of the domain twice as expensive.
+        std::vector<long> wgts(ba.size());
+        for (int i = 0; i < ba.size(); ++i) {
+            wgts[i] = ba[i].numPts();
+            if (ba[i].smallEnd(0) >= n_cell[0]/4 && ba[i].bigEnd(0) < 3*n_cell[0]/4) {
+                wgts[i] *= 2;
+            }
+        }
+
+        const int nprocs = ParallelDescriptor::NProcs();
+        const IntVect ng(nghost);
+
+        DistributionMapping dm_sfc, dm_hilbert, dm_graph, dm_topo, dm_curve;
+        dm_sfc.SFCProcessorMap(ba, wgts, nprocs);
+        dm_hilbert.HilbertProcessorMap(ba, wgts, nprocs);
+        dm_graph.GraphProcessorMap(ba, wgts, nprocs, ng);
+        dm_topo.TopologyProcessorMap(ba, wgts, nprocs, ng);
+        // Without sorting by work, rank p gets the p-th piece of the curve, so
+        // neighboring pieces stay on the same node.  This is the off node
+        // baseline for TOPOLOGY, which starts from the same pieces.
+        dm_curve.HilbertProcessorMap(ba, wgts, nprocs, false);
+
+        auto m_sfc     = DistributionMapping::computeCommMetric(ba, dm_sfc, ng, wgts);
+        auto m_hilbert = DistributionMapping::computeCommMetric(ba, dm_hilbert, ng, wgts);
+        auto m_graph   = DistributionMapping::computeCommMetric(ba, dm_graph, ng, wgts);
+        auto m_topo    = DistributionMapping::computeCommMetric(ba, dm_topo, ng, wgts);
+        auto m_curve   = DistributionMapping::computeCommMetric(ba, dm_curve, ng, wgts);
+
+        amrex::Print() << "# of boxes: " << ba.size() << ", # of ranks: " << nprocs << "\n"
+                       << "SFC     edge cut: " << m_sfc.edge_cut << " of " << m_sfc.total_edge
+                       << ", imbalance: " << m_sfc.imbalance << "\n"
+                       << "HILBERT edge cut: " << m_hilbert.edge_cut << " of " << m_hilbert.total_edge
+                       << ", imbalance: " << m_hilbert.imbalance << "\n"
+                       << "GRAPH   edge cut: " << m_graph.edge_cut << " of " << m_graph.total_edge
+                       << ", imbalance: " << m_graph.imbalance << "\n"
+                       << "off node edge cut: SFC " << m_sfc.offnode_cut
+                       << ", HILBERT " << m_hilbert.offnode_cut
+                       << ", HILBERT unsorted " << m_curve.offnode_cut
+                       << ", GRAPH " << m_graph.offnode_cut
+                       << ", TOPOLOGY " << m_topo.offnode_cut << "\n";
+
+        if (m_graph.edge_cut > m_hilbert.edge_cut) {
+            amrex::Abort("GRAPH edge cut is larger than that of HILBERT");
+        }
+        if (m_graph.imbalance > std::max(m_hilbert.imbalance, 1.0+graph_imbalance) + 1.e-12) {
+            amrex::Abort("GRAPH imbalance exceeds the tolerance");
+        }
+        if (m_topo.offnode_cut > m_curve.offnode_cut) {
+            amrex::Abort("TOPOLOGY off node edge cut is larger than that of unsorted HILBERT");
+        }
+
+        // The metric from the FillBoundary metadata must agree without periodicity.
+        MultiFab mf(ba, dm_graph, 1, nghost);
+        auto m_fb = DistributionMapping::computeCommMetric(mf, ng, Periodicity::NonPeriodic());
+        if (m_fb.edge_cut != m_graph.edge_cut || m_fb.total_edge != m_graph.total_edge ||
+            m_fb.offnode_cut != m_graph.offnode_cut) {
+            amrex::Abort("FillBoundary edge cut does not match");
+        }
+
+        // With periodicity, the graph has the edges through the periodic
+        // images, and its metric must agree with the FillBoundary metadata.
+        {
+            Periodicity period(domain.length());
+            DistributionMapping dm_pgraph;
+            dm_pgraph.GraphProcessorMap(ba, wgts, nprocs, ng, period);
+            auto m_pgraph   = DistributionMapping::computeCommMetric(ba, dm_pgraph, ng, wgts, period);
+            auto m_philbert = DistributionMapping::computeCommMetric(ba, dm_hilbert, ng, wgts, period);
+            amrex::Print() << "periodic HILBERT edge cut: " << m_philbert.edge_cut
+                           << ", GRAPH edge cut: " << m_pgraph.edge_cut
+                           << " of " << m_pgraph.total_edge << "\n";
+            if (m_pgraph.edge_cut > m_philbert.edge_cut) {
+                amrex::Abort("periodic GRAPH edge cut is larger than that of HILBERT");
+            }
+            MultiFab pmf(ba, dm_pgraph, 1, nghost);
+            auto m_pfb = DistributionMapping::computeCommMetric(pmf, ng, period);
+            if (m_pfb.edge_cut != m_pgraph.edge_cut || m_pfb.total_edge != m_pgraph.total_edge) {
+                amrex::Abort("periodic FillBoundary edge cut does not match");
+            }
+        }
+
+        // Make some boxes on rank 0 more expensive and rebalance incrementally.
+        Vector<Real> rcost(ba.size());
+        for (int i = 0; i < ba.size(); ++i) {
+            rcost[i] = wgts[i];
+            if (dm_graph[i] == 0) rcost[i] *= 3;
+        }
+        DistributionMapping::RebalanceInfo info;
+        DistributionMapping dm_inc = DistributionMapping::makeIncremental(ba, dm_graph, rcost,
+                                                                          graph_imbalance,
+                                                                          sizeof(Real), &info);
+        int nchanged = 0;
+        for (int i = 0; i < ba.size(); ++i) {
+            if (dm_inc[i] != dm_graph[i]) ++nchanged;
+        }
+        amrex::Print() << "Incremental rebalance moved " << info.nmoved << " boxes, "
+                       << info.bytes_moved << " bytes, imbalance: " << info.imbalance_before
+                       << " -> " << info.imbalance_after << "\n";
+        if (nchanged != info.nmoved || info.imbalance_after > info.imbalance_before) {
+            amrex::Abort("Incremental rebalance failed");
+        }
+
+        amrex::Print() << "DistributionMapping test passed\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,223 @@
+//
+// The EB data read from the cache in eb2.cache_dir must be identical to
+// the data built from the implicit function.  First a sphere with an
+// explicit geom_key is built without the cache, built again with the
+// cache (a miss, which writes it) and a third time (a hit, which reads
+// it), and the cell flags, volume fractions, centroids, area fractions,
+// face centroids and boundary data of every level are compared.  Then the
+// eb2.geom_type driven Build is run with the cache for the sphere of the
+// inputs and again with a different eb2.sphere_radius, which must miss the
+// cache and agree with the build without it.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_Sphere.H>
+#include <AMReX_EBFabFactory.H>
+
+#include <memory>
+
+using namespace amrex;
+
+namespace
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int max_coarsening_level = 3;
+
+    // The grids of every level.  Each is distributed once, so that the
+    // factories of different builds can be compared.
+    Vector<Geometry> lgeom;
+    Vector<BoxArray> lgrids;
+    Vector<DistributionMapping> ldmap;
+
+    // the factories of every level of the IndexSpace on top of the stack
+    Vector<std::unique_ptr<EBFArrayBoxFactory> > makeFactories (const Geometry& geom)
+    {
+        const EB2::IndexSpace* ebis = &EB2::IndexSpace::top();
+        const int nlevels = EB2::maxCoarseningLevel(ebis, geom) + 1;
+        Vector<std::unique_ptr<EBFArrayBoxFactory> > factories;
+        for (int ilev = 0; ilev < nlevels; ++ilev)
+        {
+            if (ilev == lgeom.size()) {
+                lgeom.push_back(ilev == 0 ? geom : amrex::coarsen(lgeom[ilev-1], 2));
+                lgrids.emplace_back(lgeom[ilev].Domain());
+                lgrids[ilev].maxSize(max_grid_size);
+                ldmap.emplace_back(lgrids[ilev]);
+            }
+            factories.push_back(makeEBFabFactory(ebis, lgeom[ilev], lgrids[ilev], ldmap[ilev],
+                                                 {2,2,2}, EBSupport::full));
+        }
+        return factories;
+    }
+
+    Real diffNorm (const MultiFab& a, const MultiFab& b)
+    {
+        MultiFab diff(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrow());
+        MultiFab::Copy(diff, a, 0, 0, a.nComp(), a.nGrow());
+        MultiFab::Subtract(diff, b, 0, 0, a.nComp(), a.nGrow());
+        Real r = 0.0;
+        for (int n = 0; n < a.nComp(); ++n) {
+            r = std::max(r, diff.norm0(n, a.nGrow()));
+        }
+        return r;
+    }
+
+    Real diffNorm (const MultiCutFab& a, const MultiCutFab& b)
+    {
+        return diffNorm(a.ToMultiFab(1.0, 0.0), b.ToMultiFab(1.0, 0.0));
+    }
+
+    long numFlagDiffs (const FabArray<EBCellFlagFab>& a, const FabArray<EBCellFlagFab>& b)
+    {
+        long ndiffs = 0;
+        for (MFIter mfi(a); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.fabbox();
+            auto const& fa = a[mfi].array();
+            auto const& fb = b[mfi].array();
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        if (fa(i,j,k).getValue() != fb(i,j,k).getValue()) ++ndiffs;
+                    }
+                }
+            }
+        }
+        ParallelDescriptor::ReduceLongSum(ndiffs);
+        return ndiffs;
+    }
+
+    // The largest difference of the EB data of all levels.  The flags count
+    // as 1 if any differs.
+    Real compare (const Vector<std::unique_ptr<EBFArrayBoxFactory> >& a,
+                  const Vector<std::unique_ptr<EBFArrayBoxFactory> >& b,
+                  const std::string& what)
+    {
+        if (a.size() != b.size()) {
+            amrex::Abort(what + ": the number of levels differs");
+        }
+        Real r = 0.0;
+        for (int ilev = 0; ilev < a.size(); ++ilev)
+        {
+            const EBFArrayBoxFactory& fa = *a[ilev];
+            const EBFArrayBoxFactory& fb = *b[ilev];
+            Real d = 0.0;
+            if (numFlagDiffs(fa.getMultiEBCellFlagFab(), fb.getMultiEBCellFlagFab()) > 0) {
+                d = 1.0;
+            }
+            d = std::max(d, diffNorm(fa.getVolFrac(), fb.getVolFrac()));
+            d = std::max(d, diffNorm(fa.getCentroid(), fb.getCentroid()));
+            d = std::max(d, diffNorm(fa.getBndryArea(), fb.getBndryArea()));
+            d = std::max(d, diffNorm(fa.getBndryCent(), fb.getBndryCent()));
+            d = std::max(d, diffNorm(fa.getBndryNormal(), fb.getBndryNormal()));
+            const auto areafrac_a = fa.getAreaFrac();
+            const auto areafrac_b = fb.getAreaFrac();
+            const auto facecent_a = fa.getFaceCent();
+            const auto facecent_b = fb.getFaceCent();
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                d = std::max(d, diffNorm(*areafrac_a[idim], *areafrac_b[idim]));
+                d = std::max(d, diffNorm(*facecent_a[idim], *facecent_b[idim]));
+            }
+            amrex::Print() << what << ", level " << ilev << ": max difference " << d << "\n";
+            r = std::max(r, d);
+        }
+        return r;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+        }
+
+        if (EB2::cache_dir.empty()) {
+            amrex::Abort("EB Cache test: eb2.cache_dir must be set");
+        }
+        const std::string cache_dir = EB2::cache_dir;
+        amrex::UtilCreateDirectoryDestructive(cache_dir, true);
+
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+        Box domain(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        Geometry geom(domain, rb, CoordSys::cartesian, is_periodic);
+
+        // Build with an explicit geom_key: without the cache, then a miss
+        // and a hit.
+        {
+            EB2::SphereIF sphere(0.25, {AMREX_D_DECL(0.45,0.5,0.55)}, false);
+            auto gshop = EB2::makeShop(sphere);
+            const std::string geom_key = "EB Cache test sphere";
+            const std::string key = EB2::cacheKey(geom_key, geom, 0, max_coarsening_level, 4);
+            const std::string dir = EB2::cacheDirectory(key);
+
+            EB2::cache_dir.clear();
+            EB2::Build(gshop, geom, 0, max_coarsening_level, 4, geom_key);
+            auto ref = makeFactories(geom);
+            EB2::cache_dir = cache_dir;
+
+            if (EB2::readCacheHeader(dir, key) != 0) {
+                amrex::Abort("EB Cache test: the cache was written without eb2.cache_dir");
+            }
+            EB2::Build(gshop, geom, 0, max_coarsening_level, 4, geom_key);
+            auto built = makeFactories(geom);
+
+            if (EB2::readCacheHeader(dir, key) != static_cast<int>(built.size())) {
+                amrex::Abort("EB Cache test: the cache was not written");
+            }
+            EB2::Build(gshop, geom, 0, max_coarsening_level, 4, geom_key);
+            auto cached = makeFactories(geom);
+
+            if (compare(ref, built, "built with the cache") != 0.0 ||
+                compare(ref, cached, "read from the cache") != 0.0) {
+                amrex::Abort("EB Cache test: the cached EB data differ");
+            }
+        }
+
+        // The eb2.geom_type driven Build must miss the cache when a shape
+        // parameter changes.
+        {
+            EB2::Build(geom, 0, max_coarsening_level);
+            auto sphere1 = makeFactories(geom);
+            EB2::Build(geom, 0, max_coarsening_level);
+            auto sphere1_cached = makeFactories(geom);
+            if (compare(sphere1, sphere1_cached, "eb2.geom_type, read from the cache") != 0.0) {
+                amrex::Abort("EB Cache test: the cached EB data differ");
+            }
+
+            ParmParse pp("eb2");
+            Real radius;
+            pp.get("sphere_radius", radius);
+            pp.add("sphere_radius", 1.1*radius);
+
+            EB2::Build(geom, 0, max_coarsening_level);
+            auto sphere2 = makeFactories(geom);
+
+            EB2::cache_dir.clear();
+            EB2::Build(geom, 0, max_coarsening_level);
+            auto sphere2_ref = makeFactories(geom);
+            EB2::cache_dir = cache_dir;
+
+            if (compare(sphere1, sphere2_ref, "eb2.geom_type, old and new radius") == 0.0) {
+                amrex::Abort("EB Cache test: changing the radius does not change the EB");
+            }
+            if (compare(sphere2_ref, sphere2, "eb2.geom_type, new radius") != 0.0) {
+                amrex::Abort("EB Cache test: a changed radius hit the cache of the old one");
+            }
+        }
+
+        amrex::Print() << "EB Cache test passed\n";
+    }
+    amrex::Finalize();
+}
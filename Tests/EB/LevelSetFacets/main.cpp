@@ -0,0 +1,152 @@
+//
+// amrex_eb_fill_levelset finds the nearest EB facet of every node with a
+// bounding volume hierarchy.  This compares it with a brute force search.
+// For each node, the facet whose centre is nearest is found with a linear
+// scan of the list (the first one wins a tie), and amrex_eb_fill_levelset
+// is called for that node with a list holding only that facet.  The level
+// set and the validity flag of every node must be the same as those from
+// the whole list.  Two lists are used: the facets of a sphere, and those
+// of a plane, whose nodes have many facets at exactly the same distance.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Box.H>
+#include <AMReX_Vector.H>
+#include <AMReX_EB_F.H>
+
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+namespace
+{
+    // Facet centre and normal of every cut cell of the grid of n cells on
+    // the unit cube, for a surface given by the nearest point on it.
+    template <typename F>
+    Vector<Real> makeFacets (int n, F&& nearest)
+    {
+        const Real dx = 1.0/n;
+        Vector<Real> facets;
+        for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const Real c[3] = {(i+0.5)*dx, (j+0.5)*dx, (k+0.5)*dx};
+            Real p[3], normal[3];
+            nearest(c, p, normal);
+            if (std::floor(p[0]/dx) == i && std::floor(p[1]/dx) == j && std::floor(p[2]/dx) == k) {
+                facets.insert(facets.end(), p, p+3);
+                facets.insert(facets.end(), normal, normal+3);
+            }
+        }}}
+        return facets;
+    }
+
+    long compare (const Vector<Real>& facets, int n_cell, const std::string& what)
+    {
+        const int nfacets = facets.size()/6;
+        const Real dx_eb[3] = {2.0/n_cell, 2.0/n_cell, 2.0/n_cell};
+        const Real dx[3] = {1.0/n_cell, 1.0/n_cell, 1.0/n_cell};
+
+        const Box bx(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(n_cell,n_cell,n_cell)),
+                     IndexType::TheNodeType());
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        const int blo[3] = {lo.x, lo.y, lo.z};
+        const int bhi[3] = {hi.x, hi.y, hi.z};
+
+        Vector<Real> phi(bx.numPts());
+        Vector<int> valid(bx.numPts());
+        const int l_eb = facets.size();
+        amrex_eb_fill_levelset(blo, bhi, facets.data(), &l_eb,
+                               valid.data(), blo, bhi,
+                               phi.data(), blo, bhi, dx, dx_eb);
+
+        long ndiffs = 0;
+        long nties = 0;
+        long idx = 0;
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i, ++idx) {
+                    const Real pos[3] = {i*dx[0], j*dx[1], k*dx[2]};
+                    int nearest = 0;
+                    int ntied = 0;
+                    Real min_dist2 = std::numeric_limits<Real>::max();
+                    for (int f = 0; f < nfacets; ++f) {
+                        const Real* c = &facets[6*f];
+                        const Real dist2 = (pos[0]-c[0])*(pos[0]-c[0])
+                            +              (pos[1]-c[1])*(pos[1]-c[1])
+                            +              (pos[2]-c[2])*(pos[2]-c[2]);
+                        if (dist2 < min_dist2) {
+                            min_dist2 = dist2;
+                            nearest = f;
+                            ntied = 0;
+                        } else if (dist2 == min_dist2) {
+                            ++ntied;
+                        }
+                    }
+                    if (ntied > 0) ++nties;
+
+                    const int node[3] = {i, j, k};
+                    const int l_one = 6;
+                    Real phi_one;
+                    int valid_one;
+                    amrex_eb_fill_levelset(node, node, &facets[6*nearest], &l_one,
+                                           &valid_one, node, node,
+                                           &phi_one, node, node, dx, dx_eb);
+                    if (phi_one != phi[idx] || valid_one != valid[idx]) ++ndiffs;
+                }
+            }
+        }
+
+        amrex::Print() << what << ": " << nfacets << " facets, " << bx.numPts() << " nodes, "
+                       << nties << " with tied facets, " << ndiffs << " nodes differ from the brute force search\n";
+        return ndiffs;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+        }
+        AMREX_ALWAYS_ASSERT(n_cell % 2 == 0);
+
+        const Real radius = 0.3;
+        auto sphere = [=] (const Real* c, Real* p, Real* normal)
+        {
+            Real d[3] = {c[0]-0.5, c[1]-0.5, c[2]-0.5};
+            const Real r = std::sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+            for (int m = 0; m < 3; ++m) {
+                normal[m] = d[m]/r;
+                p[m] = 0.5 + radius*normal[m];
+            }
+        };
+
+        const Real height = 0.43;
+        auto plane = [=] (const Real* c, Real* p, Real* normal)
+        {
+            p[0] = c[0];
+            p[1] = c[1];
+            p[2] = height;
+            normal[0] = 0.0;
+            normal[1] = 0.0;
+            normal[2] = 1.0;
+        };
+
+        long ndiffs = compare(makeFacets(n_cell/2, sphere), n_cell, "sphere")
+            +         compare(makeFacets(n_cell/2, plane), n_cell, "plane");
+        if (ndiffs > 0) {
+            amrex::Abort("LevelSetFacets: the nearest facet differs from the brute force search");
+        }
+
+        amrex::Print() << "LevelSetFacets test passed\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,168 @@
+//
+// EB2::STLIF on the watertight cube of cube.stl, scaled and moved so that
+// its faces cut the cells, with the fluid outside.  Run it on one and on
+// several processes.
+//
+// The bounding box and the number of triangles must be those of the cube.
+// After prepare(), every process holds at most all the triangles and
+// together they hold at least all of them.  At the nodes of the local
+// boxes, the sign of the function must be that of the exact signed
+// distance to the cube, and within band the value must be the exact
+// distance.  Finally the fluid volume of the EB built from the STL file
+// must be that of the EB built from the same cube as an EB2::BoxIF, and
+// close to the volume of the domain minus that of the cube.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_STL.H>
+#include <AMReX_EB2_IF_Box.H>
+#include <AMReX_EBFabFactory.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace
+{
+    // signed distance to the cube, negative inside
+    Real cubeDistance (const RealArray& p, const RealArray& center, Real half)
+    {
+        Real outside = 0.0;
+        Real inside = std::numeric_limits<Real>::lowest();
+        for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+            const Real q = std::abs(p[m]-center[m]) - half;
+            outside += std::max(q,0.0)*std::max(q,0.0);
+            inside = std::max(inside, q);
+        }
+#if (AMREX_SPACEDIM == 2)
+        // the function is evaluated at z = 0, the middle of the cube
+        inside = std::max(inside, -half);
+#endif
+        return std::sqrt(outside) + std::min(inside, 0.0);
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        int max_coarsening_level = 3;
+        std::string stl_file = "cube.stl";
+        Real scale = 0.4;
+        RealArray center{AMREX_D_DECL(0.47,0.51,0.53)};
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+            pp.query("stl_file", stl_file);
+            pp.query("stl_scale", scale);
+            pp.query("stl_center", center);
+        }
+        const Real half = 0.5*scale;
+
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+        Box domain(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        Geometry geom(domain, rb, CoordSys::cartesian, is_periodic);
+        const auto dx = geom.CellSizeArray();
+        const auto problo = geom.ProbLoArray();
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::STLIF stl(stl_file, scale, center, false, 4.0*dx[0]);
+        const Real band = stl.band();
+
+        const RealArray lo = stl.lowerBound();
+        const RealArray hi = stl.upperBound();
+        for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+            if (std::abs(lo[m]-(center[m]-half)) > 1.e-12 ||
+                std::abs(hi[m]-(center[m]+half)) > 1.e-12) {
+                amrex::Abort("STL test: wrong bounding box");
+            }
+        }
+        if (stl.numTriangles() != 12) {
+            amrex::Abort("STL test: the cube must have 12 triangles");
+        }
+
+        stl.prepare(ba, dm, geom, 1);
+        long nlocal = stl.numLocalTriangles();
+        if (nlocal > stl.numTriangles()) {
+            amrex::Abort("STL test: a process holds more than all the triangles");
+        }
+        ParallelDescriptor::ReduceLongSum(nlocal);
+        amrex::Print() << "Triangles: " << stl.numTriangles() << ", held by all processes: "
+                       << nlocal << "\n";
+        if (nlocal < stl.numTriangles()) {
+            amrex::Abort("STL test: some triangles are held by no process");
+        }
+
+        // The body is inside, so the function is minus the signed distance.
+        Real max_err = 0.0;
+        long nwrong_sign = 0;
+        for (MFIter mfi(ba, dm); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = amrex::surroundingNodes(amrex::grow(mfi.validbox(),1));
+            for (BoxIterator bi(bx); bi.ok(); ++bi)
+            {
+                RealArray p;
+                for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+                    p[m] = problo[m] + bi()[m]*dx[m];
+                }
+                const Real exact = -cubeDistance(p, center, half);
+                const Real f = stl(p);
+                if ((exact > 1.e-12 && f <= 0.0) || (exact < -1.e-12 && f >= 0.0)) {
+                    ++nwrong_sign;
+                }
+                if (std::abs(exact) < band) {
+                    max_err = std::max(max_err, std::abs(f-exact));
+                }
+            }
+        }
+        ParallelDescriptor::ReduceLongSum(nwrong_sign);
+        ParallelDescriptor::ReduceRealMax(max_err);
+        amrex::Print() << "Nodes with the wrong sign: " << nwrong_sign
+                       << ", max error within band: " << max_err << "\n";
+        if (nwrong_sign > 0 || max_err > 1.e-12) {
+            amrex::Abort("STL test: the function is not the signed distance to the cube");
+        }
+
+        auto gshop = EB2::makeShop(stl);
+        EB2::Build(gshop, geom, 0, max_coarsening_level);
+        auto factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::full);
+
+        const Real dv = AMREX_D_TERM(dx[0],*dx[1],*dx[2]);
+        const Real volume = factory->getVolFrac().sum() * dv;
+
+        // The same cube as an EB2::BoxIF.  The cells cut by the edges of the
+        // cube cannot be represented exactly, so the volumes are compared
+        // with each other closely and with the exact one loosely.
+        RealArray boxlo, boxhi;
+        for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+            boxlo[m] = center[m] - half;
+            boxhi[m] = center[m] + half;
+        }
+        EB2::BoxIF box(boxlo, boxhi, false);
+        EB2::Build(EB2::makeShop(box), geom, 0, max_coarsening_level);
+        auto box_factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::full);
+        const Real box_volume = box_factory->getVolFrac().sum() * dv;
+
+        const Real exact_volume = 1.0 - AMREX_D_TERM(scale,*scale,*scale);
+        amrex::Print() << "Fluid volume: " << volume << ", with EB2::BoxIF: " << box_volume
+                       << ", exact: " << exact_volume << "\n";
+        if (std::abs(volume-box_volume) > 1.e-10*exact_volume ||
+            std::abs(volume-exact_volume) > 1.e-3*exact_volume) {
+            amrex::Abort("STL test: wrong fluid volume");
+        }
+
+        amrex::Print() << "STL test passed\n";
+    }
+    amrex::Finalize();
+}
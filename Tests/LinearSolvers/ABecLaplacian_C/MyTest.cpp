@@ -0,0 +1,323 @@
+#include "MyTest.H"
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFabUtil.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+MyTest::MyTest ()
+{
+    readParameters();
+    initData();
+}
+
+void
+MyTest::run ()
+{
+    if (test_multi_comp) testMultiComp();
+    if (test_deep_halo) testDeepHalo();
+    if (test_chebyshev) testChebyshev();
+    if (test_direct) testDirect();
+}
+
+void
+MyTest::readParameters ()
+{
+    ParmParse pp;
+    pp.query("n_cell", n_cell);
+    pp.query("max_grid_size", max_grid_size);
+    pp.query("ncomp", ncomp);
+    pp.query("is_periodic", is_periodic);
+
+    pp.query("verbose", verbose);
+    pp.query("bottom_verbose", bottom_verbose);
+    pp.query("max_iter", max_iter);
+    pp.query("reltol", reltol);
+    pp.query("check_tol", check_tol);
+    pp.query("agglomeration", agglomeration);
+    pp.query("consolidation", consolidation);
+
+    pp.query("test_multi_comp", test_multi_comp);
+    pp.query("test_deep_halo", test_deep_halo);
+    pp.query("deep_halo_sweeps", deep_halo_sweeps);
+    pp.query("test_chebyshev", test_chebyshev);
+    pp.query("chebyshev_degree", chebyshev_degree);
+    pp.query("test_direct", test_direct);
+}
+
+void
+MyTest::initData ()
+{
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    std::array<int,AMREX_SPACEDIM> isperiodic{AMREX_D_DECL(is_periodic,is_periodic,is_periodic)};
+    Box domain(IntVect{AMREX_D_DECL(0,0,0)}, IntVect{AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)});
+    geom.define(domain, &rb, 0, isperiodic.data());
+
+    grids.define(domain);
+    grids.maxSize(max_grid_size);
+    dmap.define(grids);
+
+    rhs.define(grids, dmap, ncomp, 0);
+    acoef.define(grids, dmap, 1, 0);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        bcoef[idim].define(amrex::convert(grids,IntVect::TheDimensionVector(idim)), dmap, 1, 0);
+    }
+
+    const Real pi = 3.141592653589793238462643383279502884197;
+    const auto dx = geom.CellSizeArray();
+
+    for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        FArrayBox& rhsfab = rhs[mfi];
+        FArrayBox& afab = acoef[mfi];
+        for (BoxIterator bi(bx); bi.ok(); ++bi)
+        {
+            const IntVect& iv = bi();
+            const Real x = (iv[0]+0.5)*dx[0];
+            const Real y = (iv[1]+0.5)*dx[1];
+            afab(iv) = 1.0 + 0.5*std::sin(2.*pi*y);
+            // each component is scaled differently, so that a tolerance
+            // relative to the norm of all of them would not do
+            for (int n = 0; n < ncomp; ++n) {
+                rhsfab(iv,n) = std::pow(10.,-3*n) * std::sin((n+1)*pi*x) * std::cos(pi*y+n);
+            }
+        }
+
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            FArrayBox& bfab = bcoef[idim][mfi];
+            for (BoxIterator bi(bfab.box()); bi.ok(); ++bi)
+            {
+                const IntVect& iv = bi();
+                const int jdim = (idim+1) % AMREX_SPACEDIM;
+                bfab(iv) = 1.0 + 0.3*std::cos(2.*pi*(iv[jdim]+0.5)*dx[jdim]);
+            }
+        }
+    }
+}
+
+void
+MyTest::setupLinOp (MLABecLaplacian& mlabec)
+{
+    std::array<LinOpBCType,AMREX_SPACEDIM> mlmg_lobc;
+    std::array<LinOpBCType,AMREX_SPACEDIM> mlmg_hibc;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (geom.isPeriodic(idim)) {
+            mlmg_lobc[idim] = LinOpBCType::Periodic;
+            mlmg_hibc[idim] = LinOpBCType::Periodic;
+        } else {
+            mlmg_lobc[idim] = LinOpBCType::Dirichlet;
+            mlmg_hibc[idim] = LinOpBCType::Dirichlet;
+        }
+    }
+    mlabec.setDomainBC(mlmg_lobc, mlmg_hibc);
+    mlabec.setLevelBC(0, nullptr);
+    mlabec.setScalars(1.0, 1.0);
+    mlabec.setACoeffs(0, acoef);
+    mlabec.setBCoeffs(0, amrex::GetArrOfConstPtrs(bcoef));
+}
+
+void
+MyTest::setupMLMG (MLMG& mlmg)
+{
+    mlmg.setMaxIter(max_iter);
+    mlmg.setMaxFmgIter(0);
+    mlmg.setVerbose(verbose);
+    mlmg.setBottomVerbose(bottom_verbose);
+}
+
+void
+MyTest::testMultiComp ()
+{
+    BL_PROFILE("testMultiComp");
+
+    LPInfo info;
+    info.setAgglomeration(agglomeration);
+    info.setConsolidation(consolidation);
+
+    MultiFab phi(grids, dmap, ncomp, 1);
+    phi.setVal(0.0);
+
+    Vector<Real> final_resid;
+    {
+        MLABecLaplacian mlabec({geom}, {grids}, {dmap}, info, {}, ncomp);
+        setupLinOp(mlabec);
+        MLMG mlmg(mlabec);
+        setupMLMG(mlmg);
+        mlmg.solve({&phi}, {&rhs}, reltol, 0.0);
+        final_resid = mlmg.getFinalResidualPerComp();
+    }
+
+    if (static_cast<int>(final_resid.size()) != ncomp) {
+        amrex::Abort("testMultiComp: getFinalResidualPerComp has the wrong size");
+    }
+
+    for (int n = 0; n < ncomp; ++n)
+    {
+        // the initial guess is zero, so the initial residual is the rhs
+        const Real rhsnorm = rhs.norm0(n);
+        if (final_resid[n] > reltol*rhsnorm) {
+            amrex::Abort("testMultiComp: component " + std::to_string(n)
+                         + " did not meet its tolerance");
+        }
+
+        MultiFab phi1(grids, dmap, 1, 1);
+        MultiFab rhs1(grids, dmap, 1, 0);
+        phi1.setVal(0.0);
+        MultiFab::Copy(rhs1, rhs, n, 0, 1, 0);
+        {
+            MLABecLaplacian mlabec({geom}, {grids}, {dmap}, info);
+            setupLinOp(mlabec);
+            MLMG mlmg(mlabec);
+            setupMLMG(mlmg);
+            mlmg.setVerbose(0);
+            mlmg.solve({&phi1}, {&rhs1}, reltol, 0.0);
+        }
+
+        MultiFab::Subtract(phi1, phi, n, 0, 1, 0);
+        const Real diff = phi1.norm0(0) / phi.norm0(n);
+        amrex::Print() << "testMultiComp: component " << n << ", final residual "
+                       << final_resid[n] << " (rhs " << rhsnorm
+                       << "), relative difference from the single-component solve "
+                       << diff << "\n";
+        if (diff > check_tol) {
+            amrex::Abort("testMultiComp: component " + std::to_string(n)
+                         + " differs from the single-component solve");
+        }
+    }
+}
+
+void
+MyTest::testDeepHalo ()
+{
+    BL_PROFILE("testDeepHalo");
+
+    if (!geom.isAllPeriodic()) {
+        amrex::Abort("testDeepHalo: the deep halo smoother needs is_periodic = 1");
+    }
+
+    LPInfo info;
+    info.setAgglomeration(agglomeration);
+    info.setConsolidation(consolidation);
+
+    Vector<MultiFab> phi(2);
+    for (int deep = 0; deep < 2; ++deep)
+    {
+        phi[deep].define(grids, dmap, ncomp, 1);
+        phi[deep].setVal(0.0);
+
+        MLABecLaplacian mlabec({geom}, {grids}, {dmap}, info, {}, ncomp);
+        setupLinOp(mlabec);
+        if (deep) mlabec.setDeepHaloSmooth(deep_halo_sweeps);
+        MLMG mlmg(mlabec);
+        setupMLMG(mlmg);
+        mlmg.solve({&phi[deep]}, {&rhs}, reltol, 0.0);
+    }
+
+    for (int n = 0; n < ncomp; ++n)
+    {
+        const Real phinorm = phi[0].norm0(n);
+        MultiFab::Subtract(phi[1], phi[0], n, n, 1, 0);
+        const Real diff = phi[1].norm0(n) / phinorm;
+        amrex::Print() << "testDeepHalo: component " << n
+                       << ", relative difference from the standard smoother " << diff << "\n";
+        if (diff > check_tol) {
+            amrex::Abort("testDeepHalo: component " + std::to_string(n)
+                         + " differs from the solve with the standard smoother");
+        }
+    }
+}
+
+void
+MyTest::testChebyshev ()
+{
+    BL_PROFILE("testChebyshev");
+
+    LPInfo info;
+    info.setAgglomeration(agglomeration);
+    info.setConsolidation(consolidation);
+
+    Vector<MultiFab> phi(2);
+    Vector<Vector<Real> > final_resid(2);
+    for (int cheby = 0; cheby < 2; ++cheby)
+    {
+        phi[cheby].define(grids, dmap, ncomp, 1);
+        phi[cheby].setVal(0.0);
+
+        MLABecLaplacian mlabec({geom}, {grids}, {dmap}, info, {}, ncomp);
+        setupLinOp(mlabec);
+        if (cheby) mlabec.setSmoother(MLSmoother::chebyshev, chebyshev_degree);
+        MLMG mlmg(mlabec);
+        setupMLMG(mlmg);
+        mlmg.solve({&phi[cheby]}, {&rhs}, reltol, 0.0);
+        final_resid[cheby] = mlmg.getFinalResidualPerComp();
+    }
+
+    for (int n = 0; n < ncomp; ++n)
+    {
+        if (final_resid[1][n] > reltol*rhs.norm0(n)) {
+            amrex::Abort("testChebyshev: component " + std::to_string(n)
+                         + " did not converge with the Chebyshev smoother");
+        }
+        const Real phinorm = phi[0].norm0(n);
+        MultiFab::Subtract(phi[1], phi[0], n, n, 1, 0);
+        const Real diff = phi[1].norm0(n) / phinorm;
+        amrex::Print() << "testChebyshev: component " << n
+                       << ", relative difference from the standard smoother " << diff << "\n";
+        if (diff > check_tol) {
+            amrex::Abort("testChebyshev: component " + std::to_string(n)
+                         + " differs from the solve with the standard smoother");
+        }
+    }
+}
+
+void
+MyTest::testDirect ()
+{
+    BL_PROFILE("testDirect");
+
+    LPInfo info;
+    info.setAgglomeration(agglomeration);
+    info.setConsolidation(consolidation);
+
+    Vector<MultiFab> phi(2);
+    Vector<Vector<Real> > final_resid(2);
+    for (int direct = 0; direct < 2; ++direct)
+    {
+        phi[direct].define(grids, dmap, ncomp, 1);
+        phi[direct].setVal(0.0);
+
+        MLABecLaplacian mlabec({geom}, {grids}, {dmap}, info, {}, ncomp);
+        setupLinOp(mlabec);
+        MLMG mlmg(mlabec);
+        setupMLMG(mlmg);
+        if (direct) mlmg.setBottomSolver(MLMG::BottomSolver::direct);
+        mlmg.solve({&phi[direct]}, {&rhs}, reltol, 0.0);
+        final_resid[direct] = mlmg.getFinalResidualPerComp();
+
+        if (direct && mlmg.getBottomSolver() != MLMG::BottomSolver::direct) {
+            amrex::Abort("testDirect: the direct bottom solver failed and MLMG fell back");
+        }
+    }
+
+    for (int n = 0; n < ncomp; ++n)
+    {
+        if (final_resid[1][n] > reltol*rhs.norm0(n)) {
+            amrex::Abort("testDirect: component " + std::to_string(n)
+                         + " did not converge with the direct bottom solver");
+        }
+        const Real phinorm = phi[0].norm0(n);
+        MultiFab::Subtract(phi[1], phi[0], n, n, 1, 0);
+        const Real diff = phi[1].norm0(n) / phinorm;
+        amrex::Print() << "testDirect: component " << n << ", final residual "
+                       << final_resid[1][n]
+                       << ", relative difference from the default bottom solver " << diff << "\n";
+        if (diff > check_tol) {
+            amrex::Abort("testDirect: component " + std::to_string(n)
+                         + " differs from the solve with the default bottom solver");
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#include <AMReX.H>
+#include "MyTest.H"
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    {
+        BL_PROFILE("main");
+        MyTest mytest;
+        mytest.run();
+    }
+
+    amrex::Finalize();
+}
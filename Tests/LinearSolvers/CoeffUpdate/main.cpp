@@ -0,0 +1,219 @@
+//
+// An MLMG object is reused after the coefficients of its operator change.
+// MLNodeLaplacian (with both coarsening strategies) and MLALaplacian are
+// solved once, given new coefficients with setSigma or setACoeffs, and
+// solved again with the same MLMG.  The second solution must have a small
+// residual with an operator built from scratch with the new coefficients,
+// and agree with the solution of a new solver.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Print.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLNodeLaplacian.H>
+#include <AMReX_MLALaplacian.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+Real reltol = 1.e-10;
+Real check_tol = 1.e-8;
+int verbose = 0;
+
+// mf = c0 + c1*sin(2 pi (x + 2y + 3z)) at the cell centers or nodes of mf
+void fillFunc (MultiFab& mf, const Geometry& geom, Real c0, Real c1)
+{
+    const Real pi = 4.0*std::atan(1.0);
+    const auto dx = geom.CellSizeArray();
+    const IntVect nodal = mf.ixType().ixType();
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        const auto& a = mf.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    Real s = 0.0;
+                    AMREX_D_TERM(s +=     (i + 0.5*(1-nodal[0]))*dx[0];,
+                                 s += 2.0*(j + 0.5*(1-nodal[1]))*dx[1];,
+                                 s += 3.0*(k + 0.5*(1-nodal[2]))*dx[2];);
+                    a(i,j,k) = c0 + c1*std::sin(2.0*pi*s);
+                }
+            }
+        }
+    }
+}
+
+void checkSolution (const std::string& what, MLLinOp& linop_new, MultiFab& phi,
+                    const MultiFab& rhs, const MultiFab& phi_old)
+{
+    const Real rhsnorm = rhs.norm0();
+
+    // residual of the reused solve with the operator built from scratch
+    MultiFab res(rhs.boxArray(), rhs.DistributionMap(), 1, 0);
+    {
+        MLMG mlmg(linop_new);
+        mlmg.compResidual({&res}, {&phi}, {&rhs});
+    }
+    const Real resnorm = res.norm0();
+
+    // solve from scratch
+    MultiFab phi_new(phi.boxArray(), phi.DistributionMap(), 1, phi.nGrow());
+    phi_new.setVal(0.0);
+    {
+        MLMG mlmg(linop_new);
+        mlmg.setVerbose(verbose);
+        mlmg.solve({&phi_new}, {&rhs}, reltol, 0.0);
+    }
+
+    const Real phinorm = phi_new.norm0();
+    MultiFab diff(phi.boxArray(), phi.DistributionMap(), 1, 0);
+    MultiFab::Copy(diff, phi, 0, 0, 1, 0);
+    MultiFab::Subtract(diff, phi_new, 0, 0, 1, 0);
+    const Real err = diff.norm0() / phinorm;
+    MultiFab::Copy(diff, phi_old, 0, 0, 1, 0);
+    MultiFab::Subtract(diff, phi_new, 0, 0, 1, 0);
+    const Real change = diff.norm0() / phinorm;
+
+    amrex::Print() << what << ": residual " << resnorm << " (rhs " << rhsnorm
+                   << "), relative difference from a new solver " << err
+                   << ", relative change from the old coefficients " << change << "\n";
+
+    if (change <= check_tol) {
+        amrex::Abort(what + ": the new coefficients do not change the solution");
+    }
+    if (resnorm > 10.*reltol*rhsnorm) {
+        amrex::Abort(what + ": the residual with the new coefficients is too big");
+    }
+    if (err > check_tol) {
+        amrex::Abort(what + ": the solution differs from that of a new solver");
+    }
+}
+
+void testNodeLaplacian (const Geometry& geom, const BoxArray& grids, const DistributionMapping& dmap,
+                        MLNodeLaplacian::CoarseningStrategy strategy, const std::string& what)
+{
+    const BoxArray& nba = amrex::convert(grids, IntVect::TheNodeVector());
+
+    MultiFab sigma1(grids, dmap, 1, 1);
+    MultiFab sigma2(grids, dmap, 1, 1);
+    fillFunc(sigma1, geom, 1.0, 0.5);
+    fillFunc(sigma2, geom, 3.0, -2.0);
+
+    MultiFab rhs(nba, dmap, 1, 0);
+    fillFunc(rhs, geom, 0.0, 1.0);
+
+    const std::array<LinOpBCType,AMREX_SPACEDIM> bc {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                                                  LinOpBCType::Dirichlet,
+                                                                  LinOpBCType::Dirichlet)};
+
+    MultiFab phi_old(nba, dmap, 1, 1);
+    MultiFab phi(nba, dmap, 1, 1);
+    phi_old.setVal(0.0);
+    phi.setVal(0.0);
+
+    MLNodeLaplacian linop({geom}, {grids}, {dmap});
+    linop.setCoarseningStrategy(strategy);
+    linop.setDomainBC(bc, bc);
+    linop.setSigma(0, sigma1);
+
+    MLMG mlmg(linop);
+    mlmg.setVerbose(verbose);
+    mlmg.solve({&phi_old}, {&rhs}, reltol, 0.0);
+
+    linop.setSigma(0, sigma2);
+    mlmg.solve({&phi}, {&rhs}, reltol, 0.0);
+
+    MLNodeLaplacian linop_new({geom}, {grids}, {dmap});
+    linop_new.setCoarseningStrategy(strategy);
+    linop_new.setDomainBC(bc, bc);
+    linop_new.setSigma(0, sigma2);
+
+    checkSolution(what, linop_new, phi, rhs, phi_old);
+}
+
+void testALaplacian (const Geometry& geom, const BoxArray& grids, const DistributionMapping& dmap)
+{
+    MultiFab alpha1(grids, dmap, 1, 0);
+    MultiFab alpha2(grids, dmap, 1, 0);
+    fillFunc(alpha1, geom, 1.0, 0.5);
+    fillFunc(alpha2, geom, 50.0, 40.0);
+
+    MultiFab rhs(grids, dmap, 1, 0);
+    fillFunc(rhs, geom, 0.0, 1.0);
+
+    const std::array<LinOpBCType,AMREX_SPACEDIM> bc {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                                                  LinOpBCType::Dirichlet,
+                                                                  LinOpBCType::Dirichlet)};
+
+    MultiFab phi_old(grids, dmap, 1, 1);
+    MultiFab phi(grids, dmap, 1, 1);
+    phi_old.setVal(0.0);
+    phi.setVal(0.0);
+
+    MLALaplacian linop({geom}, {grids}, {dmap});
+    linop.setDomainBC(bc, bc);
+    linop.setLevelBC(0, nullptr);
+    linop.setScalars(1.0, 1.0);
+    linop.setACoeffs(0, alpha1);
+
+    MLMG mlmg(linop);
+    mlmg.setVerbose(verbose);
+    mlmg.solve({&phi_old}, {&rhs}, reltol, 0.0);
+
+    linop.setACoeffs(0, alpha2);
+    mlmg.solve({&phi}, {&rhs}, reltol, 0.0);
+
+    MLALaplacian linop_new({geom}, {grids}, {dmap});
+    linop_new.setDomainBC(bc, bc);
+    linop_new.setLevelBC(0, nullptr);
+    linop_new.setScalars(1.0, 1.0);
+    linop_new.setACoeffs(0, alpha2);
+
+    checkSolution("MLALaplacian", linop_new, phi, rhs, phi_old);
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("verbose", verbose);
+            pp.query("reltol", reltol);
+            pp.query("check_tol", check_tol);
+        }
+
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+        Box domain(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        Geometry geom(domain, rb, CoordSys::cartesian, is_periodic);
+
+        BoxArray grids(domain);
+        grids.maxSize(max_grid_size);
+        DistributionMapping dmap(grids);
+
+        testNodeLaplacian(geom, grids, dmap, MLNodeLaplacian::CoarseningStrategy::RAP,
+                          "MLNodeLaplacian (RAP)");
+        testNodeLaplacian(geom, grids, dmap, MLNodeLaplacian::CoarseningStrategy::Sigma,
+                          "MLNodeLaplacian (Sigma)");
+        testALaplacian(geom, grids, dmap);
+
+        amrex::Print() << "CoeffUpdate test passed\n";
+    }
+    amrex::Finalize();
+}
@@ -1,5 +1,6 @@
 #include <AMReX_MultiFab.H>
 #include <AMReX_MLMG.H>
+#include <AMReX_MLKrylov.H>
 #include <AMReX_MLABecLaplacian.H>
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParmParse.H>
@@ -20,6 +21,25 @@ static int linop_maxorder = 2;
 static bool agglomeration = false;
 static bool consolidation = false;
 static int  use_hypre = 0;
+static std::string bottom_solver = "default";
+static std::string krylov = "none";
+
+MLMG::BottomSolver bottomSolverType ()
+{
+    if (bottom_solver == "bicgstab") {
+        return MLMG::BottomSolver::bicgstab;
+    } else if (bottom_solver == "cg") {
+        return MLMG::BottomSolver::cg;
+    } else if (bottom_solver == "pipebicgstab") {
+        return MLMG::BottomSolver::pipebicgstab;
+    } else if (bottom_solver == "pipecg") {
+        return MLMG::BottomSolver::pipecg;
+    } else if (bottom_solver == "direct") {
+        return MLMG::BottomSolver::direct;
+    } else {
+        return MLMG::BottomSolver::Default;
+    }
+}
 }
 
 void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
@@ -44,6 +64,8 @@ void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
     pp.query("agglomeration", agglomeration);
     pp.query("consolidation", consolidation);
     pp.query("use_hypre", use_hypre);
+    pp.query("bottom_solver", bottom_solver);
+    pp.query("krylov", krylov);
     pp.query("tol_rel", tol_rel);
     pp.query("tol_abs", tol_abs);
   }
@@ -92,11 +114,20 @@ void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
     MLMG mlmg(mlabec);
     mlmg.setMaxIter(max_iter);
     mlmg.setMaxFmgIter(max_fmg_iter);
+    mlmg.setBottomSolver(bottomSolverType());
     if (use_hypre) mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
     mlmg.setVerbose(verbose);
     mlmg.setBottomVerbose(cg_verbose);
 
-    mlmg.solve(psoln, prhs, tol_rel, tol_abs);
+    if (krylov == "fgmres" || krylov == "pcg") {
+      mlmg.setVerbose(0);
+      MLKrylov solver(mlmg, (krylov == "pcg") ? MLKrylov::Type::PCG : MLKrylov::Type::FGMRES);
+      solver.setMaxIter(max_iter);
+      solver.setVerbose(verbose);
+      solver.solve(psoln, prhs, tol_rel, tol_abs);
+    } else {
+      mlmg.solve(psoln, prhs, tol_rel, tol_abs);
+    }
   } else {
     const int levbegin = (fine_leve_solve_only) ? nlevels-1 : 0;
     for (int ilev = 0; ilev < levbegin; ++ilev) {
@@ -135,6 +166,7 @@ void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
       MLMG mlmg(mlabec);
       mlmg.setMaxIter(max_iter);
       mlmg.setMaxFmgIter(max_fmg_iter);
+      mlmg.setBottomSolver(bottomSolverType());
       mlmg.setVerbose(verbose);
       mlmg.setBottomVerbose(cg_verbose);
 
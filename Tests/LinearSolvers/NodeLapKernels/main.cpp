@@ -0,0 +1,302 @@
+// Compare the C++ kernels in AMReX_MLNodeLap_K.H with the Fortran routines
+// in AMReX_MLNodeLap_?d.F90.  Both versions of each kernel are run ntimes
+// on the same random data; the wall time of each and the max difference of
+// their results are printed.
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_iMultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Print.H>
+#include <AMReX_LO_BCTYPES.H>
+#include <AMReX_MLNodeLap_F.H>
+#include <AMReX_MLNodeLap_K.H>
+
+using namespace amrex;
+
+namespace {
+
+void fill_random (MultiFab& mf, Real lo, Real hi)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        const auto& a = mf.array(mfi);
+        const auto blo = amrex::lbound(bx);
+        const auto bhi = amrex::ubound(bx);
+        for         (int k = blo.z; k <= bhi.z; ++k) {
+            for     (int j = blo.y; j <= bhi.y; ++j) {
+                for (int i = blo.x; i <= bhi.x; ++i) {
+                    a(i,j,k) = lo + (hi-lo)*amrex::Random();
+                }
+            }
+        }
+    }
+}
+
+// Nodes on or outside the domain boundary are marked Dirichlet.
+void fill_dirichlet_mask (iMultiFab& msk, const Box& nddom)
+{
+    const Box& interior = amrex::grow(nddom,-1);
+    for (MFIter mfi(msk); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        const auto& m = msk.array(mfi);
+        const auto blo = amrex::lbound(bx);
+        const auto bhi = amrex::ubound(bx);
+        for         (int k = blo.z; k <= bhi.z; ++k) {
+            for     (int j = blo.y; j <= bhi.y; ++j) {
+                for (int i = blo.x; i <= bhi.x; ++i) {
+                    m(i,j,k) = interior.contains(IntVect(AMREX_D_DECL(i,j,k))) ? 0 : 1;
+                }
+            }
+        }
+    }
+}
+
+Real max_diff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), 1, 0);
+    MultiFab::Copy(d, a, 0, 0, 1, 0);
+    MultiFab::Subtract(d, b, 0, 0, 1, 0);
+    return d.norm0();
+}
+
+template <class F>
+Real time_it (int ntimes, F&& f)
+{
+    ParallelDescriptor::Barrier();
+    Real t0 = amrex::second();
+    for (int n = 0; n < ntimes; ++n) {
+        f();
+    }
+    Real t = amrex::second() - t0;
+    ParallelDescriptor::ReduceRealMax(t);
+    return t;
+}
+
+void report (const std::string& name, Real tf, Real tc, Real diff)
+{
+    amrex::Print() << std::left << std::setw(22) << name
+                   << "  Fortran = " << std::setw(12) << tf
+                   << "  C++ = " << std::setw(12) << tc
+                   << "  speedup = " << std::setw(8) << tf/tc
+                   << "  max diff = " << diff << "\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 64;
+        int ntimes = 10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ntimes", ntimes);
+        }
+
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+        Box domain(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        Geometry geom(domain, rb, 0, is_periodic);
+        Geometry cgeom(amrex::coarsen(domain,2), rb, 0, is_periodic);
+
+        BoxArray cc_ba(domain);
+        cc_ba.maxSize(max_grid_size);
+        DistributionMapping dm(cc_ba);
+        const BoxArray& nd_ba = amrex::convert(cc_ba, IntVect::TheNodeVector());
+        const BoxArray& cnd_ba = amrex::coarsen(nd_ba, 2);
+
+        const Box& nddom = amrex::surroundingNodes(domain);
+        const auto dxinvarr = geom.InvCellSizeArray();
+        const Real* dxinv = geom.InvCellSize();
+        Vector<int> bc(AMREX_SPACEDIM, AMREX_LO_DIRICHLET);
+
+        MultiFab x(nd_ba, dm, 1, 1), rhs(nd_ba, dm, 1, 1);
+        MultiFab yf(nd_ba, dm, 1, 1), yc(nd_ba, dm, 1, 1);
+        Array<MultiFab,AMREX_SPACEDIM> sig;
+        for (auto& s : sig) {
+            s.define(cc_ba, dm, 1, 1);
+            fill_random(s, 0.5, 2.0);
+        }
+        iMultiFab msk(nd_ba, dm, 1, 1);
+        fill_random(x, -1.0, 1.0);
+        fill_random(rhs, -1.0, 1.0);
+        fill_dirichlet_mask(msk, nddom);
+
+        amrex::Print() << "NodeLapKernels: " << n_cell << "^" << AMREX_SPACEDIM
+                       << " cells, max_grid_size = " << max_grid_size
+                       << ", ntimes = " << ntimes << "\n";
+
+        // adotx, arithmetic average
+        Real tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(yf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                amrex_mlndlap_adotx_aa(BL_TO_FORTRAN_BOX(bx), BL_TO_FORTRAN_ANYD(yf[mfi]),
+                                       BL_TO_FORTRAN_ANYD(x[mfi]), BL_TO_FORTRAN_ANYD(sig[0][mfi]),
+                                       BL_TO_FORTRAN_ANYD(msk[mfi]), dxinv,
+                                       BL_TO_FORTRAN_BOX(nddom), bc.data(), bc.data());
+            }
+        });
+        Real tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(yc); mfi.isValid(); ++mfi) {
+                mlndlap_adotx_aa(mfi.validbox(), yc.array(mfi), x.array(mfi), sig[0].array(mfi),
+                                 msk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                                 , false
+#endif
+                                 );
+            }
+        });
+        report("adotx_aa", tf, tc, max_diff(yf,yc));
+
+        // adotx, harmonic average
+        tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(yf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                amrex_mlndlap_adotx_ha(BL_TO_FORTRAN_BOX(bx), BL_TO_FORTRAN_ANYD(yf[mfi]),
+                                       BL_TO_FORTRAN_ANYD(x[mfi]),
+                                       AMREX_D_DECL(BL_TO_FORTRAN_ANYD(sig[0][mfi]),
+                                                    BL_TO_FORTRAN_ANYD(sig[1][mfi]),
+                                                    BL_TO_FORTRAN_ANYD(sig[2][mfi])),
+                                       BL_TO_FORTRAN_ANYD(msk[mfi]), dxinv,
+                                       BL_TO_FORTRAN_BOX(nddom), bc.data(), bc.data());
+            }
+        });
+        tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(yc); mfi.isValid(); ++mfi) {
+                mlndlap_adotx_ha(mfi.validbox(), yc.array(mfi), x.array(mfi),
+                                 AMREX_D_DECL(sig[0].array(mfi), sig[1].array(mfi), sig[2].array(mfi)),
+                                 msk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                                 , false
+#endif
+                                 );
+            }
+        });
+        report("adotx_ha", tf, tc, max_diff(yf,yc));
+
+        // normalize
+        MultiFab::Copy(yf, x, 0, 0, 1, 0);
+        MultiFab::Copy(yc, x, 0, 0, 1, 0);
+        tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(yf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                amrex_mlndlap_normalize_aa(BL_TO_FORTRAN_BOX(bx), BL_TO_FORTRAN_ANYD(yf[mfi]),
+                                           BL_TO_FORTRAN_ANYD(sig[0][mfi]),
+                                           BL_TO_FORTRAN_ANYD(msk[mfi]), dxinv);
+            }
+        });
+        tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(yc); mfi.isValid(); ++mfi) {
+                mlndlap_normalize_aa(mfi.validbox(), yc.array(mfi), sig[0].array(mfi),
+                                     msk.array(mfi), dxinvarr);
+            }
+        });
+        report("normalize_aa", tf, tc, max_diff(yf,yc)/std::max(yf.norm0(),1.e-300));
+
+        // Jacobi, with A x taken from the adotx above
+        MultiFab Ax(nd_ba, dm, 1, 0);
+        for (MFIter mfi(Ax); mfi.isValid(); ++mfi) {
+            mlndlap_adotx_aa(mfi.validbox(), Ax.array(mfi), x.array(mfi), sig[0].array(mfi),
+                             msk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                             , false
+#endif
+                             );
+        }
+        MultiFab::Copy(yf, x, 0, 0, 1, 1);
+        MultiFab::Copy(yc, x, 0, 0, 1, 1);
+        tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(yf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                amrex_mlndlap_jacobi_aa(BL_TO_FORTRAN_BOX(bx), BL_TO_FORTRAN_ANYD(yf[mfi]),
+                                        BL_TO_FORTRAN_ANYD(Ax[mfi]), BL_TO_FORTRAN_ANYD(rhs[mfi]),
+                                        BL_TO_FORTRAN_ANYD(sig[0][mfi]),
+                                        BL_TO_FORTRAN_ANYD(msk[mfi]), dxinv,
+                                        BL_TO_FORTRAN_BOX(nddom), bc.data(), bc.data());
+            }
+        });
+        tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(yc); mfi.isValid(); ++mfi) {
+                mlndlap_jacobi_aa(mfi.validbox(), yc.array(mfi), Ax.array(mfi), rhs.array(mfi),
+                                  sig[0].array(mfi), msk.array(mfi), dxinvarr);
+            }
+        });
+        report("jacobi_aa", tf, tc, max_diff(yf,yc)/std::max(yf.norm0(),1.e-300));
+
+        // Gauss-Seidel
+        MultiFab::Copy(yf, x, 0, 0, 1, 1);
+        MultiFab::Copy(yc, x, 0, 0, 1, 1);
+        tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(yf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                amrex_mlndlap_gauss_seidel_aa(BL_TO_FORTRAN_BOX(bx), BL_TO_FORTRAN_ANYD(yf[mfi]),
+                                              BL_TO_FORTRAN_ANYD(rhs[mfi]),
+                                              BL_TO_FORTRAN_ANYD(sig[0][mfi]),
+                                              BL_TO_FORTRAN_ANYD(msk[mfi]), dxinv,
+                                              BL_TO_FORTRAN_BOX(nddom), bc.data(), bc.data());
+            }
+        });
+        tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(yc); mfi.isValid(); ++mfi) {
+                mlndlap_gauss_seidel_aa(mfi.validbox(), yc.array(mfi), rhs.array(mfi),
+                                        sig[0].array(mfi), msk.array(mfi), dxinvarr
+#if (AMREX_SPACEDIM == 2)
+                                        , false
+#endif
+                                        );
+            }
+        });
+        report("gauss_seidel_aa", tf, tc, max_diff(yf,yc)/std::max(yf.norm0(),1.e-300));
+
+        // restriction
+        MultiFab cf(cnd_ba, dm, 1, 0), cc(cnd_ba, dm, 1, 0);
+        tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(cf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                amrex_mlndlap_restriction(BL_TO_FORTRAN_BOX(bx), BL_TO_FORTRAN_ANYD(cf[mfi]),
+                                          BL_TO_FORTRAN_ANYD(x[mfi]), BL_TO_FORTRAN_ANYD(msk[mfi])
+#if (AMREX_SPACEDIM == 1)
+                                          , BL_TO_FORTRAN_BOX(nddom), bc.data(), bc.data()
+#endif
+                                          );
+            }
+        });
+        tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(cc); mfi.isValid(); ++mfi) {
+                mlndlap_restriction(mfi.validbox(), cc.array(mfi), x.array(mfi), msk.array(mfi));
+            }
+        });
+        report("restriction", tf, tc, max_diff(cf,cc));
+
+        // interpolation
+        fill_random(cc, -1.0, 1.0);
+        tf = time_it(ntimes, [&] () {
+            for (MFIter mfi(yf); mfi.isValid(); ++mfi) {
+                const Box& cbx = amrex::coarsen(mfi.validbox(), 2);
+                amrex_mlndlap_interpolation_aa(BL_TO_FORTRAN_BOX(cbx), BL_TO_FORTRAN_ANYD(yf[mfi]),
+                                               BL_TO_FORTRAN_ANYD(cc[mfi]),
+                                               BL_TO_FORTRAN_ANYD(sig[0][mfi]),
+                                               BL_TO_FORTRAN_ANYD(msk[mfi]),
+                                               BL_TO_FORTRAN_BOX(nddom), bc.data(), bc.data());
+            }
+        });
+        tc = time_it(ntimes, [&] () {
+            for (MFIter mfi(yc); mfi.isValid(); ++mfi) {
+                const Box& cbx = amrex::coarsen(mfi.validbox(), 2);
+                mlndlap_interpolation_aa(cbx, yc.array(mfi), cc.array(mfi), sig[0].array(mfi),
+                                         msk.array(mfi));
+            }
+        });
+        report("interpolation_aa", tf, tc, max_diff(yf,yc));
+    }
+    amrex::Finalize();
+}
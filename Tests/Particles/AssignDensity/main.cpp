@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cmath>
 
 #include <AMReX.H>
 #include <AMReX_MultiFab.H>
@@ -53,7 +54,8 @@ void test_assign_density(TestParams& parms)
   MultiFab density(ba, dmap, 1, 0);
   density.setVal(0.0);
 
-  MultiFab partMF(ba, dmap, 1 + BL_SPACEDIM, 1);
+  // PCS (particles.shape_order = 3) reaches two cells beyond the particle's cell
+  MultiFab partMF(ba, dmap, 1 + BL_SPACEDIM, 2);
   partMF.setVal(0.0);
 
   typedef ParticleContainer<1 + BL_SPACEDIM> MyParticleContainer;
@@ -70,15 +72,39 @@ void test_assign_density(TestParams& parms)
 
   MyParticleContainer::ParticleInitData pdata = {mass, AMREX_D_DECL(1.0, 2.0, 3.0)};
   myPC.InitRandom(num_particles, iseed, pdata, serialize);
-  myPC.AssignCellDensitySingleLevel(0, partMF, 0, 4, 0);
+
+  // Every shape must deposit the total particle mass.  The plotfile is
+  // written with the shape selected in the inputs.
+  const int plot_shape_order = MyParticleContainer::shape_order;
+  const Real total_mass = mass * num_particles;
+  const Real vol = AMREX_D_TERM(geom.CellSize(0), *geom.CellSize(1), *geom.CellSize(2));
+  MultiFab plotMF(ba, dmap, 1 + BL_SPACEDIM, 0);
+
+  for (int order = 1; order <= 3; ++order) {
+    MyParticleContainer::shape_order = order;
+    partMF.setVal(0.0);
+    myPC.AssignCellDensitySingleLevel(0, partMF, 0, 4, 0);
+
+    const Real deposited = partMF.sum(0) * vol;
+    const Real err = std::abs(deposited - total_mass) / total_mass;
+    if (ParallelDescriptor::IOProcessor())
+      std::cout << "Shape order " << order << ": deposited mass " << deposited
+                << ", particle mass " << total_mass << ", relative error " << err << '\n';
+    if (err > 1.e-10)
+      amrex::Abort("AssignDensity: deposited mass does not match the particle mass");
+
+    if (order == plot_shape_order)
+      MultiFab::Copy(plotMF, partMF, 0, 0, 1 + BL_SPACEDIM, 0);
+  }
+  MyParticleContainer::shape_order = plot_shape_order;
   
   //  myPC.AssignDensitySingleLevel(0, partMF, 0, 4, 0);
 
   //  myPC.InterpolateSingleLevel(acceleration, 0);
 
-  MultiFab::Copy(density, partMF, 0, 0, 1, 0);
+  MultiFab::Copy(density, plotMF, 0, 0, 1, 0);
 
-  WriteSingleLevelPlotfile("plt00000", partMF, 
+  WriteSingleLevelPlotfile("plt00000", plotMF, 
                            {"density", "vx", "vy", "vz"},
                            geom, 0.0, 0);
 
@@ -0,0 +1,166 @@
+//
+// The sparse (NBX) and dense (MPI_Alltoall) exchanges of the particle send
+// counts must give the same result.  First the two handshakes are called
+// directly with a sparse pattern of counts, and the received counts are
+// checked against the counts the other processes sent.  Then two identical
+// particle containers are moved the same way and redistributed, one with
+// each handshake, and the number and the positions of the particles in
+// every grid must agree.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+typedef ParticleContainer<1> MyParticleContainer;
+
+namespace
+{
+    // what process p sends to process q
+    long sendCount (int p, int q)
+    {
+        if (p == q || (3*p + q) % 4 != 0) return 0;
+        return 100*p + q + 1;
+    }
+
+    void testHandShake ()
+    {
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int myproc = ParallelDescriptor::MyProc();
+
+        Vector<long> Snds(nprocs);
+        for (int q = 0; q < nprocs; ++q) {
+            Snds[q] = sendCount(myproc, q);
+        }
+
+        Vector<long> Rcvs_sparse(nprocs, -1), Rcvs_dense(nprocs, -1);
+        doHandShakeSparse(Snds, Rcvs_sparse);
+        long NumSnds = doHandShakeDense(Snds, Rcvs_dense);
+
+        for (int p = 0; p < nprocs; ++p)
+        {
+            // the dense handshake leaves Rcvs alone if nobody sends anything
+            const long expected = sendCount(p, myproc);
+            if (Rcvs_sparse[p] != expected || (NumSnds > 0 && Rcvs_dense[p] != expected)) {
+                amrex::AllPrint() << "Process " << myproc << " received " << Rcvs_sparse[p]
+                                  << " (sparse) and " << Rcvs_dense[p] << " (dense) from "
+                                  << p << ", expected " << expected << "\n";
+                amrex::Abort("SparseHandShake: the received counts are wrong");
+            }
+        }
+        amrex::Print() << "Handshake counts: OK\n";
+    }
+
+    void move (MyParticleContainer& pc, Real dist)
+    {
+        for (ParIter<1> pti(pc, 0); pti.isValid(); ++pti)
+        {
+            for (auto& p : pti.GetArrayOfStructs())
+            {
+                const Real a = 13.*p.pos(0) + AMREX_D_TERM(0., + 7.*p.pos(1), + 3.*p.pos(2));
+                AMREX_D_TERM(p.pos(0) += dist*std::sin(a);,
+                             p.pos(1) += dist*std::cos(a);,
+                             p.pos(2) += dist*std::sin(2.*a););
+            }
+        }
+    }
+
+    // number of particles and sum of their positions in every grid
+    void gridSums (const MyParticleContainer& pc, Vector<Real>& sums)
+    {
+        const BoxArray& ba = pc.ParticleBoxArray(0);
+        sums.assign(2*ba.size(), 0.0);
+        for (ParConstIter<1> pti(pc, 0); pti.isValid(); ++pti)
+        {
+            const int i = pti.index();
+            for (const auto& p : pti.GetArrayOfStructs())
+            {
+                sums[2*i] += 1.0;
+                sums[2*i+1] += AMREX_D_TERM(p.pos(0), + p.pos(1), + p.pos(2));
+            }
+        }
+        ParallelDescriptor::ReduceRealSum(sums.dataPtr(), sums.size());
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        int nsteps = 3;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        testHandShake();
+
+        RealBox real_box;
+        for (int n = 0; n < AMREX_SPACEDIM; n++) {
+            real_box.setLo(n, 0.0);
+            real_box.setHi(n, 1.0);
+        }
+        const Box domain(IntVect(AMREX_D_DECL(0,0,0)),
+                         IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        int is_per[AMREX_SPACEDIM];
+        for (int i = 0; i < AMREX_SPACEDIM; i++) is_per[i] = 1;
+        Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dmap(ba);
+
+        MyParticleContainer pc_sparse(geom, dmap, ba);
+        MyParticleContainer pc_dense(geom, dmap, ba);
+        MyParticleContainer::ParticleInitData pdata = {1.0};
+        pc_sparse.InitOnePerCell(0.5, 0.5, 0.5, pdata);
+        pc_dense.InitOnePerCell(0.5, 0.5, 0.5, pdata);
+
+        // particles go a few grids away, so that every process has
+        // several partners
+        const Real dist = 1.5 * max_grid_size * geom.CellSize(0);
+
+        for (int step = 0; step < nsteps; ++step)
+        {
+            move(pc_sparse, dist);
+            move(pc_dense, dist);
+
+            use_sparse_handshake = true;
+            pc_sparse.Redistribute();
+            use_sparse_handshake = false;
+            pc_dense.Redistribute();
+
+            Vector<Real> sums_sparse, sums_dense;
+            gridSums(pc_sparse, sums_sparse);
+            gridSums(pc_dense, sums_dense);
+            for (int i = 0; i < ba.size(); ++i)
+            {
+                if (sums_sparse[2*i] != sums_dense[2*i] ||
+                    std::abs(sums_sparse[2*i+1]-sums_dense[2*i+1])
+                    > 1.e-12*std::abs(sums_dense[2*i+1]))
+                {
+                    amrex::Print() << "Step " << step << ", grid " << i << ": "
+                                   << sums_sparse[2*i] << " particles (sparse), "
+                                   << sums_dense[2*i] << " particles (dense)\n";
+                    amrex::Abort("SparseHandShake: Redistribute results differ");
+                }
+            }
+            if (pc_sparse.TotalNumberOfParticles() != domain.numPts()) {
+                amrex::Abort("SparseHandShake: particles were lost");
+            }
+            amrex::Print() << "Redistribute step " << step << ": OK\n";
+        }
+
+        amrex::Print() << "SparseHandShake test passed\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,154 @@
+//
+// FillBoundary with persistent communication (fabarray.use_persistent_fb = 1)
+// must fill the same ghost cells as the default path.  The reference is
+// computed with the default path.  The persistent path is then run
+// repeatedly, for a subset of the components (which rebuilds the plan),
+// with FillBoundary_nowait/FillBoundary_finish, and with two MultiFabs on
+// the same BoxArray in flight at once (the second falls back to the default
+// path because the plan is in use).
+//
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+namespace
+{
+    void fillValid (MultiFab& mf, Real offset)
+    {
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            auto const& a = mf.array(mfi);
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for (int n = 0; n < mf.nComp(); ++n) {
+            for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+            for (int i = lo.x; i <= hi.x; ++i) {
+                a(i,j,k,n) = offset + n + 1.e-2*i + 1.e-4*j + 1.e-6*k;
+            }}}}
+        }
+    }
+
+    void check (const MultiFab& mf, const MultiFab& ref, const std::string& what)
+    {
+        MultiFab diff(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrow());
+        MultiFab::Copy(diff, mf, 0, 0, mf.nComp(), mf.nGrow());
+        MultiFab::Subtract(diff, ref, 0, 0, mf.nComp(), mf.nGrow());
+        for (int n = 0; n < mf.nComp(); ++n) {
+            const Real err = diff.norm0(n, mf.nGrow());
+            if (err != 0.0) {
+                amrex::Print() << what << ": component " << n << " differs by " << err << "\n";
+                amrex::Abort("PersistentFillBoundary test failed");
+            }
+        }
+        amrex::Print() << what << ": OK\n";
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int ncomp = 3;
+        int nghost = 2;
+        int nrepeat = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ncomp", ncomp);
+            pp.query("nghost", nghost);
+            pp.query("nrepeat", nrepeat);
+        }
+        AMREX_ALWAYS_ASSERT(ncomp >= 2);
+
+        if (!FabArrayBase::use_persistent_fb) {
+            amrex::Abort("PersistentFillBoundary: run with fabarray.use_persistent_fb = 1");
+        }
+
+        Box domain(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+        Geometry geom(domain, rb, CoordSys::cartesian, is_periodic);
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab ref(ba, dm, ncomp, nghost);
+        ref.setVal(-1.0);
+        fillValid(ref, 0.0);
+        FabArrayBase::use_persistent_fb = false;
+        ref.FillBoundary(geom.periodicity());
+        FabArrayBase::use_persistent_fb = true;
+
+        MultiFab mf(ba, dm, ncomp, nghost);
+
+        for (int i = 0; i < nrepeat; ++i)
+        {
+            mf.setVal(-1.0);
+            fillValid(mf, 0.0);
+            mf.FillBoundary(geom.periodicity());
+            check(mf, ref, "FillBoundary " + std::to_string(i));
+        }
+
+        // a different number of components needs a new plan, and so does
+        // going back to all of them
+        {
+            MultiFab ref1(ba, dm, ncomp, nghost);
+            MultiFab::Copy(ref1, ref, 0, 0, ncomp, nghost);
+            ref1.setBndry(-1.0, 1, 1);
+            mf.setBndry(-1.0, 1, 1);
+            mf.FillBoundary(1, 1, geom.periodicity());
+            ref1.FillBoundary(1, 1, geom.periodicity());
+            check(mf, ref1, "FillBoundary of component 1");
+
+            mf.setBndry(-1.0);
+            mf.FillBoundary(geom.periodicity());
+            check(mf, ref, "FillBoundary after the component change");
+        }
+
+        for (int i = 0; i < nrepeat; ++i)
+        {
+            mf.setBndry(-1.0);
+            mf.FillBoundary_nowait(geom.periodicity());
+            mf.FillBoundary_finish();
+            check(mf, ref, "FillBoundary_nowait " + std::to_string(i));
+        }
+
+        {
+            MultiFab mf2(ba, dm, ncomp, nghost);
+            mf2.setVal(-1.0);
+            fillValid(mf2, 10.0);
+            MultiFab ref2(ba, dm, ncomp, nghost);
+            ref2.setVal(-1.0);
+            fillValid(ref2, 10.0);
+            FabArrayBase::use_persistent_fb = false;
+            ref2.FillBoundary(geom.periodicity());
+            FabArrayBase::use_persistent_fb = true;
+
+            for (int i = 0; i < nrepeat; ++i)
+            {
+                mf.setBndry(-1.0);
+                mf2.setBndry(-1.0);
+                mf.FillBoundary_nowait(geom.periodicity());
+                mf2.FillBoundary_nowait(geom.periodicity());
+                mf2.FillBoundary_finish();
+                mf.FillBoundary_finish();
+                check(mf, ref, "two in flight, first " + std::to_string(i));
+                check(mf2, ref2, "two in flight, second " + std::to_string(i));
+            }
+        }
+
+        amrex::Print() << "PersistentFillBoundary test passed\n";
+    }
+    amrex::Finalize();
+}
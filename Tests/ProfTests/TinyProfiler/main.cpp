@@ -0,0 +1,79 @@
+//
+// Cost of an empty tiny profiler scope.  Each repetition times ntimers
+// BL_PROFILE scopes and an empty loop of the same length, and the minimum
+// difference over the repetitions is reported per scope.  Timers are also
+// started inside an OpenMP parallel region, so that the flat tables at the
+// end show the trees of the worker threads merged with that of the master.
+//
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <limits>
+
+using namespace amrex;
+
+namespace
+{
+    volatile int sink = 0;
+
+    void emptyLoop (long n)
+    {
+        for (long i = 0; i < n; ++i) {
+            sink = sink + 1;
+        }
+    }
+
+    void timerLoop (long n)
+    {
+        for (long i = 0; i < n; ++i) {
+            BL_PROFILE("tTinyProfiler::scope");
+            sink = sink + 1;
+        }
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        BL_PROFILE("main");
+
+        long ntimers = 1000000;
+        int nreps = 5;
+        Real target_ns = 50.0;
+        {
+            ParmParse pp;
+            pp.query("ntimers", ntimers);
+            pp.query("nreps", nreps);
+            pp.query("target_ns", target_ns);
+        }
+
+        Real best_ns = std::numeric_limits<Real>::max();
+        for (int irep = 0; irep < nreps; ++irep)
+        {
+            Real t0 = amrex::second();
+            emptyLoop(ntimers);
+            Real t1 = amrex::second();
+            timerLoop(ntimers);
+            Real t2 = amrex::second();
+            best_ns = std::min(best_ns, ((t2-t1)-(t1-t0))*1.e9/ntimers);
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            BL_PROFILE("tTinyProfiler::parallel");
+            timerLoop(ntimers/10);
+        }
+
+        amrex::Print() << "tTinyProfiler: " << best_ns << " ns per timer (target "
+                       << target_ns << " ns): "
+                       << (best_ns < target_ns ? "met" : "NOT met") << "\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,91 @@
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Utility.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 32;
+        int nmf = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nmf", nmf);
+        }
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        Vector<MultiFab> mfs(nmf);
+        for (int i = 0; i < nmf; ++i) {
+            mfs[i].define(ba, dm, 1, 0);
+            for (MFIter mfi(mfs[i]); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                FArrayBox& fab = mfs[i][mfi];
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                    fab(iv) = std::sin(0.01*(i+1)*(iv[0]+2*iv[1]+3*iv[2])) - 0.1*i;
+                }
+            }
+        }
+
+        // Separate reductions: one sweep and one collective per quantity
+        Vector<Real> sep_sum(nmf), sep_min(nmf), sep_max(nmf);
+        Real t0 = amrex::second();
+        for (int i = 0; i < nmf; ++i) {
+            sep_sum[i] = mfs[i].sum(0);
+            sep_min[i] = mfs[i].min(0);
+            sep_max[i] = mfs[i].max(0);
+        }
+        Real t_sep = amrex::second() - t0;
+
+        // Fused: one sweep per MultiFab and one collective in total
+        t0 = amrex::second();
+        ReduceOps<ReduceOpSum, ReduceOpMin, ReduceOpMax, ReduceOpLogicalOr> reduce_op;
+        ReduceData<Real, Real, Real, int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        for (int i = 0; i < nmf; ++i) {
+            reduce_op.eval(mfs[i], IntVect(0), reduce_data,
+            [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& fab) -> ReduceTuple
+            {
+                Real mn = fab.min(bx,0);
+                return ReduceTuple(fab.sum(bx,0,1), mn, fab.max(bx,0), int(mn < -0.5));
+            });
+        }
+        ReduceTuple r = reduce_data.globalValue();
+        Real t_fused = amrex::second() - t0;
+
+        Real sm = 0.0, mn = std::numeric_limits<Real>::max(), mx = std::numeric_limits<Real>::lowest();
+        for (int i = 0; i < nmf; ++i) {
+            sm += sep_sum[i];
+            mn = std::min(mn, sep_min[i]);
+            mx = std::max(mx, sep_max[i]);
+        }
+
+        bool ok = std::abs(sm - amrex::get<0>(r)) <= 1.e-10*std::abs(sm)
+            && mn == amrex::get<1>(r) && mx == amrex::get<2>(r)
+            && amrex::get<3>(r) == int(mn < -0.5);
+
+        amrex::Print() << "sum: " << sm << " " << amrex::get<0>(r) << "\n"
+                       << "min: " << mn << " " << amrex::get<1>(r) << "\n"
+                       << "max: " << mx << " " << amrex::get<2>(r) << "\n"
+                       << "separate reductions: " << t_sep << " seconds\n"
+                       << "fused reductions:    " << t_fused << " seconds\n";
+
+        if (!ok) {
+            amrex::Abort("Fused reduction does not match separate reductions");
+        }
+        amrex::Print() << "Reduce test passed\n";
+    }
+    amrex::Finalize();
+}
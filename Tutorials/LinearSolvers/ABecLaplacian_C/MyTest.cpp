@@ -59,6 +59,7 @@ MyTest::solvePoisson ()
         MLMG mlmg(mlpoisson);
         mlmg.setMaxIter(max_iter);
         mlmg.setMaxFmgIter(max_fmg_iter);
+        mlmg.setMixedPrecision(mixed_precision);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
 #ifdef AMREX_USE_HYPRE
@@ -100,6 +101,7 @@ MyTest::solvePoisson ()
             MLMG mlmg(mlpoisson);
             mlmg.setMaxIter(max_iter);
             mlmg.setMaxFmgIter(max_fmg_iter);
+            mlmg.setMixedPrecision(mixed_precision);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
 #ifdef AMREX_USE_HYPRE
@@ -278,6 +280,7 @@ MyTest::readParameters ()
     pp.query("bottom_verbose", bottom_verbose);
     pp.query("max_iter", max_iter);
     pp.query("max_fmg_iter", max_fmg_iter);
+    pp.query("mixed_precision", mixed_precision);
     pp.query("linop_maxorder", linop_maxorder);
     pp.query("agglomeration", agglomeration);
     pp.query("consolidation", consolidation);